@@ -0,0 +1,177 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains benchmarks for assigning points to Qserv
+///        chunks and sub-chunks.
+
+#include <string>
+#include <vector>
+
+#include "lsst/sphgeom/Box.h"
+#include "lsst/sphgeom/ChunkPartitioner.h"
+#include "lsst/sphgeom/Chunker.h"
+#include "lsst/sphgeom/Circle.h"
+#include "lsst/sphgeom/LonLat.h"
+
+#include "benchmark.h"
+#include "workloads.h"
+
+using namespace lsst::sphgeom;
+
+namespace {
+
+size_t const NUM_POINTS = 4096;
+
+} // unnamed namespace
+
+BENCHMARK(ChunkerLocate) {
+    Chunker const chunker(85, 12);
+    std::vector<UnitVector3d> points = randomPoints(NUM_POINTS);
+    std::vector<LonLat> lonLats;
+    for (UnitVector3d const & v: points) {
+        lonLats.push_back(LonLat(v));
+    }
+    std::vector<ChunkLocation> locations(points.size());
+    b.measure("chunker/locate/lonlat", lonLats.size(), [&]() {
+        for (LonLat const & p: lonLats) {
+            doNotOptimize(chunker.locate(p).subChunkId);
+        }
+    });
+    b.measure("chunker/locate/lonlat_batch", lonLats.size(), [&]() {
+        chunker.locate(lonLats.data(), locations.data(), lonLats.size());
+        doNotOptimize(locations[0].subChunkId);
+    });
+    b.measure("chunker/locate/unit_vector_batch", points.size(), [&]() {
+        chunker.locate(points.data(), locations.data(), points.size());
+        doNotOptimize(locations[0].subChunkId);
+    });
+    // The alternative to locate: a sub-chunk search with a tiny circle.
+    b.measure("chunker/locate/tiny_circle", points.size(), [&]() {
+        for (UnitVector3d const & v: points) {
+            doNotOptimize(
+                chunker.getSubChunksIntersecting(Circle(v, Angle(1.0e-9))));
+        }
+    });
+}
+
+BENCHMARK(ChunkerIntersecting) {
+    Chunker const chunker(85, 12);
+    for (char const * radius: {"0.01", "0.1", "1", "10"}) {
+        std::vector<Circle> circles = randomCircles(
+            64, Angle::fromDegrees(std::atof(radius)));
+        std::string suffix = std::string("/radius=") + radius + "deg";
+        b.measure("chunker/chunks_intersecting" + suffix, circles.size(),
+                  [&]() {
+            for (Circle const & c: circles) {
+                doNotOptimize(chunker.getChunksIntersecting(c));
+            }
+        });
+        b.measure("chunker/sub_chunks_intersecting" + suffix, circles.size(),
+                  [&]() {
+            for (Circle const & c: circles) {
+                doNotOptimize(chunker.getSubChunksIntersecting(c));
+            }
+        });
+        b.measure("chunker/sub_chunk_ranges_intersecting" + suffix,
+                  circles.size(), [&]() {
+            for (Circle const & c: circles) {
+                doNotOptimize(chunker.getSubChunkRangesIntersecting(c));
+            }
+        });
+    }
+    Box const sky = Box::full();
+    b.measure("chunker/sub_chunks_intersecting/full_sky", 1, [&]() {
+        doNotOptimize(chunker.getSubChunksIntersecting(sky));
+    });
+    b.measure("chunker/sub_chunk_ranges_intersecting/full_sky", 1, [&]() {
+        doNotOptimize(chunker.getSubChunkRangesIntersecting(sky));
+    });
+    b.measure("chunker/sub_chunk_set_intersecting/full_sky", 1, [&]() {
+        doNotOptimize(chunker.getSubChunkSetIntersecting(sky));
+    });
+    b.measure("chunker/chunks_intersecting/full_sky", 1, [&]() {
+        doNotOptimize(chunker.getChunksIntersecting(sky));
+    });
+    b.measure("chunker/chunk_set_intersecting/full_sky", 1, [&]() {
+        doNotOptimize(chunker.getChunkSetIntersecting(sky));
+    });
+}
+
+BENCHMARK(ChunkerOverlap) {
+    Angle const overlap = Angle::fromDegrees(0.01667);
+    Chunker const chunker(85, 12, overlap);
+    std::vector<UnitVector3d> points = randomPoints(NUM_POINTS);
+    std::vector<ChunkLocation> locations;
+    std::vector<size_t> offsets;
+    b.measure("chunker/overlap/chunks", points.size(), [&]() {
+        for (UnitVector3d const & v: points) {
+            doNotOptimize(chunker.getOverlapChunks(v));
+        }
+    });
+    b.measure("chunker/overlap/sub_chunks", points.size(), [&]() {
+        for (UnitVector3d const & v: points) {
+            doNotOptimize(chunker.getOverlapSubChunks(v));
+        }
+    });
+    b.measure("chunker/overlap/sub_chunks_batch", points.size(), [&]() {
+        chunker.getOverlapSubChunks(points.data(), points.size(),
+                                    locations, offsets);
+        doNotOptimize(locations.size());
+    });
+    // The alternative: a sub-chunk search with a circle of the overlap
+    // radius.
+    b.measure("chunker/overlap/circle", points.size(), [&]() {
+        for (UnitVector3d const & v: points) {
+            doNotOptimize(
+                chunker.getSubChunksIntersecting(Circle(v, overlap)));
+        }
+    });
+}
+
+BENCHMARK(ChunkPartitionerAdd) {
+    std::vector<UnitVector3d> points = randomPoints(NUM_POINTS);
+    std::vector<LonLat> lonLats;
+    std::vector<std::string> payloads;
+    for (UnitVector3d const & v: points) {
+        lonLats.push_back(LonLat(v));
+        payloads.push_back(std::string(100, 'x'));
+    }
+    size_t numRows = 0;
+    ChunkPartitioner::Sink sink = [&numRows](ChunkBuffer const & buffer) {
+        numRows += buffer.rows.size();
+    };
+    for (unsigned int numThreads: {1u, 2u, 4u}) {
+        for (double overlap: {0.0, 0.01667}) {
+            Chunker const chunker(85, 12, Angle::fromDegrees(overlap));
+            ChunkPartitioner p(chunker, sink, 1024 * 1024, numThreads);
+            std::string name = "chunk_partitioner/add/" +
+                               std::string(overlap > 0.0 ? "overlap" : "home") +
+                               "/threads=" + std::to_string(numThreads);
+            b.measure(name, lonLats.size(), [&]() {
+                p.add(lonLats.data(), payloads.data(), lonLats.size());
+            });
+            p.flush();
+            doNotOptimize(numRows);
+        }
+    }
+}
@@ -0,0 +1,119 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains benchmarks for pixelization envelope and
+///        interior computation.
+
+#include <string>
+#include <vector>
+
+#include "lsst/sphgeom/HtmPixelization.h"
+#include "lsst/sphgeom/Mq3cPixelization.h"
+#include "lsst/sphgeom/Q3cPixelization.h"
+
+#include "benchmark.h"
+#include "workloads.h"
+
+using namespace lsst::sphgeom;
+
+namespace {
+
+size_t const NUM_REGIONS = 64;
+
+// The ratio of region size to pixel size beyond which a measurement is
+// skipped, since its output would be enormous.
+double const MAX_SIZE_RATIO = 512.0;
+
+struct Radius {
+    char const * name;
+    Angle angle;
+};
+
+Radius const RADII[] = {
+    {"1arcsec", Angle::fromDegrees(1.0 / 3600.0)},
+    {"1arcmin", Angle::fromDegrees(1.0 / 60.0)},
+    {"1deg", Angle::fromDegrees(1.0)},
+    {"10deg", Angle::fromDegrees(10.0)}
+};
+
+template <typename R>
+void benchmarkEnvelope(Benchmark & b,
+                       std::string const & name,
+                       Pixelization const & pixelization,
+                       std::vector<R> const & regions)
+{
+    size_t i = 0;
+    b.measure(name + "/envelope", 1, [&]() {
+        doNotOptimize(pixelization.envelope(regions[i]).size());
+        i = (i + 1) % regions.size();
+    });
+    b.measure(name + "/interior", 1, [&]() {
+        doNotOptimize(pixelization.interior(regions[i]).size());
+        i = (i + 1) % regions.size();
+    });
+}
+
+// `pixelSize` returns the approximate angular size of a pixel at the given
+// subdivision level, for a pixelization with root pixels of size `root`.
+double pixelSize(double root, int level) {
+    return root / static_cast<double>(uint64_t(1) << level);
+}
+
+} // unnamed namespace
+
+BENCHMARK(CircleEnvelope) {
+    for (Radius const & r: RADII) {
+        std::vector<Circle> circles = randomCircles(NUM_REGIONS, r.angle);
+        for (int level = 4; level <= 24; level += 4) {
+            if (r.angle.asRadians() > MAX_SIZE_RATIO * pixelSize(0.5 * PI, level)) {
+                continue;
+            }
+            std::string suffix = std::string("/circle/radius=") + r.name +
+                                 "/level=" + std::to_string(level);
+            benchmarkEnvelope(b, "htm" + suffix, HtmPixelization(level),
+                              circles);
+            benchmarkEnvelope(b, "q3c" + suffix, Q3cPixelization(level),
+                              circles);
+            benchmarkEnvelope(b, "mq3c" + suffix, Mq3cPixelization(level),
+                              circles);
+        }
+    }
+}
+
+BENCHMARK(PolygonEnvelope) {
+    for (int level = 4; level <= 24; level += 4) {
+        // Polygons are a fraction of the size of a trixel at their own
+        // level, and are pixelized at a finer level.
+        int polygonLevel = level - 4;
+        std::vector<ConvexPolygon> polygons =
+            polygonsNearPixelBoundaries(NUM_REGIONS, polygonLevel);
+        std::string suffix = "/boundary_polygon/level=" +
+                             std::to_string(level);
+        benchmarkEnvelope(b, "htm" + suffix, HtmPixelization(level),
+                          polygons);
+        benchmarkEnvelope(b, "q3c" + suffix, Q3cPixelization(level),
+                          polygons);
+        benchmarkEnvelope(b, "mq3c" + suffix, Mq3cPixelization(level),
+                          polygons);
+    }
+}
@@ -0,0 +1,226 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains benchmarks for pixel index and pixel region
+///        computation.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lsst/sphgeom/HtmCursor.h"
+#include "lsst/sphgeom/HtmPixelization.h"
+#include "lsst/sphgeom/HtmVertexTable.h"
+#include "lsst/sphgeom/Mq3cPixelization.h"
+#include "lsst/sphgeom/PixelCache.h"
+#include "lsst/sphgeom/Q3cPixelization.h"
+
+#include "benchmark.h"
+#include "workloads.h"
+
+using namespace lsst::sphgeom;
+
+namespace {
+
+size_t const NUM_POINTS = 4096;
+
+void benchmarkIndex(Benchmark & b,
+                    std::string const & name,
+                    Pixelization const & pixelization,
+                    std::vector<UnitVector3d> const & points)
+{
+    std::vector<double> x, y, z;
+    for (UnitVector3d const & v: points) {
+        x.push_back(v.x());
+        y.push_back(v.y());
+        z.push_back(v.z());
+    }
+    std::vector<uint64_t> indexes(points.size());
+    b.measure(name + "/single", points.size(), [&]() {
+        for (UnitVector3d const & v: points) {
+            doNotOptimize(pixelization.index(v));
+        }
+    });
+    b.measure(name + "/batch", points.size(), [&]() {
+        pixelization.index(points.data(), indexes.data(), points.size());
+        doNotOptimize(indexes[0]);
+    });
+    b.measure(name + "/batch_soa", points.size(), [&]() {
+        pixelization.index(x.data(), y.data(), z.data(),
+                           indexes.data(), points.size());
+        doNotOptimize(indexes[0]);
+    });
+}
+
+// `benchmarkPixel` measures the time taken to compute the regions of the
+// pixels containing the given points, with and without a pixel cache that
+// is large enough to hold all of them.
+template <typename P>
+void benchmarkPixel(Benchmark & b,
+                    std::string const & name,
+                    int level,
+                    std::vector<UnitVector3d> const & points)
+{
+    P plain(level);
+    P cached(level, std::make_shared<PixelCache>(points.size()));
+    std::vector<uint64_t> indexes(points.size());
+    plain.index(points.data(), indexes.data(), points.size());
+    b.measure(name + "/uncached", indexes.size(), [&]() {
+        for (uint64_t i: indexes) {
+            doNotOptimize(plain.pixel(i));
+        }
+    });
+    b.measure(name + "/cached", indexes.size(), [&]() {
+        for (uint64_t i: indexes) {
+            doNotOptimize(cached.pixel(i));
+        }
+    });
+}
+
+// `benchmarkCursor` compares HtmCursor with HtmPixelization on the given
+// points and their indexes, sorted by index so that consecutive points are
+// spatially coherent.
+void benchmarkCursor(Benchmark & b,
+                     std::string const & name,
+                     std::vector<UnitVector3d> const & points)
+{
+    HtmPixelization const pixelization(20);
+    std::vector<uint64_t> indexes(points.size());
+    pixelization.index(points.data(), indexes.data(), points.size());
+    std::vector<size_t> order(points.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t x, size_t y) {
+        return indexes[x] < indexes[y];
+    });
+    std::vector<UnitVector3d> sorted;
+    for (size_t i: order) {
+        sorted.push_back(points[i]);
+    }
+    std::sort(indexes.begin(), indexes.end());
+    b.measure(name + "/index/pixelization", sorted.size(), [&]() {
+        for (UnitVector3d const & v: sorted) {
+            doNotOptimize(pixelization.index(v));
+        }
+    });
+    b.measure(name + "/index/cursor", sorted.size(), [&]() {
+        HtmCursor cursor(20);
+        for (UnitVector3d const & v: sorted) {
+            doNotOptimize(cursor.index(v));
+        }
+    });
+    b.measure(name + "/triangle/static", indexes.size(), [&]() {
+        for (uint64_t i: indexes) {
+            doNotOptimize(HtmPixelization::triangle(i));
+        }
+    });
+    b.measure(name + "/triangle/cursor", indexes.size(), [&]() {
+        HtmCursor cursor(20);
+        for (uint64_t i: indexes) {
+            doNotOptimize(cursor.triangle(i));
+        }
+    });
+}
+
+} // unnamed namespace
+
+BENCHMARK(HtmIndex) {
+    std::vector<UnitVector3d> points = randomPoints(NUM_POINTS);
+    for (int level = 0; level <= HtmPixelization::MAX_LEVEL; level += 4) {
+        benchmarkIndex(b, "htm/index/level=" + std::to_string(level),
+                       HtmPixelization(level), points);
+    }
+}
+
+BENCHMARK(Q3cIndex) {
+    std::vector<UnitVector3d> points = randomPoints(NUM_POINTS);
+    for (int level = 0; level <= 24; level += 4) {
+        benchmarkIndex(b, "q3c/index/level=" + std::to_string(level),
+                       Q3cPixelization(level), points);
+    }
+}
+
+BENCHMARK(Mq3cIndex) {
+    std::vector<UnitVector3d> points = randomPoints(NUM_POINTS);
+    for (int level = 0; level <= 24; level += 4) {
+        benchmarkIndex(b, "mq3c/index/level=" + std::to_string(level),
+                       Mq3cPixelization(level), points);
+    }
+}
+
+BENCHMARK(Pixel) {
+    std::vector<UnitVector3d> points = randomPoints(NUM_POINTS);
+    for (int level: {8, 20}) {
+        std::string suffix = "/level=" + std::to_string(level);
+        benchmarkPixel<HtmPixelization>(b, "htm/pixel" + suffix,
+                                        level, points);
+        benchmarkPixel<Q3cPixelization>(b, "q3c/pixel" + suffix,
+                                        level, points);
+        benchmarkPixel<Mq3cPixelization>(b, "mq3c/pixel" + suffix,
+                                         level, points);
+    }
+}
+
+BENCHMARK(HtmCursorDescent) {
+    benchmarkCursor(b, "htm/cursor/level=20/uniform",
+                    randomPoints(NUM_POINTS));
+    benchmarkCursor(b, "htm/cursor/level=20/clustered",
+                    clusteredPoints(NUM_POINTS, Angle::fromDegrees(0.1)));
+}
+
+BENCHMARK(HtmVertexTableDescent) {
+    std::vector<UnitVector3d> points = randomPoints(NUM_POINTS);
+    for (int depth: {4, 8}) {
+        HtmVertexTable table(depth);
+        for (int level: {8, 20}) {
+            HtmPixelization const pixelization(level);
+            std::vector<uint64_t> indexes(points.size());
+            pixelization.index(points.data(), indexes.data(), points.size());
+            std::string name = "htm/vertex_table/depth=" +
+                               std::to_string(depth) + "/level=" +
+                               std::to_string(level);
+            b.measure(name + "/index/pixelization", points.size(), [&]() {
+                for (UnitVector3d const & v: points) {
+                    doNotOptimize(pixelization.index(v));
+                }
+            });
+            b.measure(name + "/index/table", points.size(), [&]() {
+                for (UnitVector3d const & v: points) {
+                    doNotOptimize(table.index(v, level));
+                }
+            });
+            b.measure(name + "/triangle/static", points.size(), [&]() {
+                for (uint64_t i: indexes) {
+                    doNotOptimize(HtmPixelization::triangle(i));
+                }
+            });
+            b.measure(name + "/triangle/table", points.size(), [&]() {
+                for (uint64_t i: indexes) {
+                    doNotOptimize(table.triangle(i));
+                }
+            });
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains benchmarks for orientation().
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "lsst/sphgeom/orientation.h"
+
+#include "benchmark.h"
+#include "workloads.h"
+
+using namespace lsst::sphgeom;
+
+namespace {
+
+size_t const NUM_TRIPLES = 4096;
+
+struct Triple {
+    UnitVector3d a;
+    UnitVector3d b;
+    UnitVector3d c;
+};
+
+void benchmarkOrientation(Benchmark & b,
+                          std::string const & name,
+                          std::vector<Triple> const & triples)
+{
+    b.measure(name, triples.size(), [&]() {
+        int s = 0;
+        for (Triple const & t: triples) {
+            s += orientation(t.a, t.b, t.c);
+        }
+        doNotOptimize(s);
+    });
+    // Report how many calls each stage of orientation() resolved, since
+    // changes in these proportions often explain changes in throughput.
+    resetOrientationCounts();
+    setOrientationCounting(true);
+    for (Triple const & t: triples) {
+        orientation(t.a, t.b, t.c);
+    }
+    setOrientationCounting(false);
+    OrientationCounts c = getOrientationCounts();
+    std::cerr << "# " << name << ": fixed bound " << c.fixedBound
+              << ", permanent bound " << c.permanentBound
+              << ", degenerate " << c.degenerate
+              << ", exact minors " << c.exactMinors
+              << ", expansion " << c.expansion
+              << ", arbitrary precision " << c.arbitraryPrecision
+              << std::endl;
+}
+
+} // unnamed namespace
+
+BENCHMARK(RandomOrientation) {
+    std::vector<UnitVector3d> points = randomPoints(3 * NUM_TRIPLES);
+    std::vector<Triple> triples;
+    for (size_t i = 0; i < NUM_TRIPLES; ++i) {
+        triples.push_back(Triple{points[3 * i], points[3 * i + 1],
+                                 points[3 * i + 2]});
+    }
+    benchmarkOrientation(b, "orientation/random", triples);
+}
+
+BENCHMARK(NearlyCoplanarOrientation) {
+    // Points on great circles through random pairs of points, perturbed by
+    // increasingly small amounts. Smaller perturbations force orientation()
+    // through more of its stages.
+    std::vector<UnitVector3d> points = randomPoints(3 * NUM_TRIPLES);
+    std::mt19937_64 rng(WORKLOAD_SEED);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    struct Perturbation {
+        char const * name;
+        double eps;
+    };
+    Perturbation const perturbations[] = {
+        {"1e-8", 1.0e-8}, {"1e-14", 1.0e-14}, {"1e-17", 1.0e-17}, {"0", 0.0}
+    };
+    for (Perturbation const & p: perturbations) {
+        std::vector<Triple> triples;
+        for (size_t i = 0; i < NUM_TRIPLES; ++i) {
+            UnitVector3d const & a = points[3 * i];
+            UnitVector3d const & c = points[3 * i + 1];
+            UnitVector3d n = UnitVector3d::orthogonalTo(a, c);
+            UnitVector3d m(a + uniform(rng) * c + p.eps * uniform(rng) * n);
+            triples.push_back(Triple{a, m, c});
+        }
+        benchmarkOrientation(
+            b, std::string("orientation/coplanar/eps=") + p.name, triples);
+    }
+}
+
+BENCHMARK(OrientationXYZ) {
+    std::vector<UnitVector3d> points = randomPoints(2 * NUM_TRIPLES);
+    b.measure("orientation/xyz", 3 * NUM_TRIPLES, [&]() {
+        int s = 0;
+        for (size_t i = 0; i < NUM_TRIPLES; ++i) {
+            s += orientationX(points[2 * i], points[2 * i + 1]);
+            s += orientationY(points[2 * i], points[2 * i + 1]);
+            s += orientationZ(points[2 * i], points[2 * i + 1]);
+        }
+        doNotOptimize(s);
+    });
+}
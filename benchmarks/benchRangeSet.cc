@@ -0,0 +1,230 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains benchmarks for RangeSet operations.
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "lsst/sphgeom/RangeSet.h"
+#include "lsst/sphgeom/RangeSetView.h"
+
+#include "benchmark.h"
+#include "workloads.h"
+
+using namespace lsst::sphgeom;
+
+BENCHMARK(RangeSetOperations) {
+    for (size_t n = 100; n <= 100000; n *= 10) {
+        RangeSet s = randomRangeSet(n, 16.0, WORKLOAD_SEED);
+        RangeSet t = randomRangeSet(n, 16.0, WORKLOAD_SEED + 1);
+        uint64_t items = s.size() + t.size();
+        std::string suffix = "/n=" + std::to_string(n);
+        b.measure("rangeset/intersection" + suffix, items, [&]() {
+            doNotOptimize(s.intersection(t).size());
+        });
+        b.measure("rangeset/join" + suffix, items, [&]() {
+            doNotOptimize(s.join(t).size());
+        });
+        b.measure("rangeset/difference" + suffix, items, [&]() {
+            doNotOptimize(s.difference(t).size());
+        });
+        b.measure("rangeset/symmetric_difference" + suffix, items, [&]() {
+            doNotOptimize(s.symmetricDifference(t).size());
+        });
+        RangeSet out;
+        b.measure("rangeset/intersection_into" + suffix, items, [&]() {
+            s.intersection(t, out);
+            doNotOptimize(out.size());
+        });
+        b.measure("rangeset/join_into" + suffix, items, [&]() {
+            s.join(t, out);
+            doNotOptimize(out.size());
+        });
+        b.measure("rangeset/difference_into" + suffix, items, [&]() {
+            s.difference(t, out);
+            doNotOptimize(out.size());
+        });
+        b.measure("rangeset/symmetric_difference_into" + suffix, items,
+                  [&]() {
+            s.symmetricDifference(t, out);
+            doNotOptimize(out.size());
+        });
+        RangeSet small = randomRangeSet(4, 16.0, WORKLOAD_SEED + 2);
+        b.measure("rangeset/intersection_small" + suffix, s.size(), [&]() {
+            doNotOptimize(s.intersection(small).size());
+        });
+        b.measure("rangeset/intersection_small_into" + suffix, s.size(),
+                  [&]() {
+            s.intersection(small, out);
+            doNotOptimize(out.size());
+        });
+        b.measure("rangeset/complement" + suffix, s.size(), [&]() {
+            doNotOptimize((~s).size());
+        });
+        b.measure("rangeset/intersects" + suffix, items, [&]() {
+            doNotOptimize(s.intersects(t));
+        });
+        b.measure("rangeset/contains" + suffix, items, [&]() {
+            doNotOptimize(s.contains(t));
+        });
+        b.measure("rangeset/simplified" + suffix, s.size(), [&]() {
+            doNotOptimize(s.simplified(4).size());
+        });
+        b.measure("rangeset/copy" + suffix, s.size(), [&]() {
+            RangeSet c(s);
+            doNotOptimize(c.size());
+        });
+    }
+}
+
+BENCHMARK(RangeSetMultiwayOperations) {
+    for (size_t k = 10; k <= 1000; k *= 10) {
+        std::vector<RangeSet> sets;
+        uint64_t items = 0;
+        // Each set spans about 3200 integers, and is offset from the
+        // previous one by 1000, like the pixels of a strip of overlapping
+        // exposures.
+        for (size_t i = 0; i < k; ++i) {
+            RangeSet s;
+            for (auto const & r: randomRangeSet(100, 16.0, WORKLOAD_SEED + i)) {
+                s.insert(std::get<0>(r) + 1000 * i, std::get<1>(r) + 1000 * i);
+            }
+            items += s.size();
+            sets.push_back(std::move(s));
+        }
+        std::string suffix = "/k=" + std::to_string(k);
+        b.measure("rangeset/join_folded" + suffix, items, [&]() {
+            RangeSet r;
+            for (RangeSet const & s: sets) {
+                r = r.join(s);
+            }
+            doNotOptimize(r.size());
+        });
+        b.measure("rangeset/join_all" + suffix, items, [&]() {
+            doNotOptimize(RangeSet::joinAll(sets).size());
+        });
+        b.measure("rangeset/covered_by_half" + suffix, items, [&]() {
+            doNotOptimize(RangeSet::coveredByAtLeast(sets, k / 2).size());
+        });
+    }
+}
+
+BENCHMARK(RangeSetConstruction) {
+    // Random level 20 HTM indexes, clustered in a small patch of sky.
+    std::mt19937_64 rng(WORKLOAD_SEED);
+    uint64_t const base = uint64_t(8) << 40;
+    std::uniform_int_distribution<uint64_t> dist(0, uint64_t(1) << 34);
+    for (size_t n = 1000; n <= 10000000; n *= 100) {
+        std::vector<uint64_t> values(n);
+        for (uint64_t & v: values) {
+            v = base + dist(rng);
+        }
+        std::string suffix = "/n=" + std::to_string(n);
+        if (n <= 100000) {
+            b.measure("rangeset/insert_values" + suffix, n, [&]() {
+                RangeSet s;
+                for (uint64_t v: values) {
+                    s.insert(v);
+                }
+                doNotOptimize(s.size());
+            });
+        }
+        b.measure("rangeset/from_values" + suffix, n, [&]() {
+            doNotOptimize(RangeSet::fromValues(values).size());
+        });
+        b.measure("rangeset/from_values_threaded" + suffix, n, [&]() {
+            doNotOptimize(RangeSet::fromValues(values, 0).size());
+        });
+    }
+}
+
+BENCHMARK(RangeSetLookups) {
+    for (size_t n = 100; n <= 100000; n *= 10) {
+        RangeSet s = randomRangeSet(n, 16.0);
+        uint64_t last = 0;
+        for (auto const & r: s) {
+            last = std::get<1>(r);
+        }
+        std::mt19937_64 rng(WORKLOAD_SEED);
+        std::uniform_int_distribution<uint64_t> dist(0, last);
+        std::vector<uint64_t> values(1024);
+        for (uint64_t & v: values) {
+            v = dist(rng);
+        }
+        b.measure("rangeset/contains_value/n=" + std::to_string(n),
+                  values.size(), [&]() {
+            size_t c = 0;
+            for (uint64_t v: values) {
+                c += s.contains(v);
+            }
+            doNotOptimize(c);
+        });
+        std::vector<uint64_t> sorted(values);
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<uint64_t> result((values.size() + 63) / 64);
+        b.measure("rangeset/contains_batch/n=" + std::to_string(n),
+                  values.size(), [&]() {
+            s.contains(values.data(), values.size(), result.data());
+            doNotOptimize(result[0]);
+        });
+        b.measure("rangeset/contains_sorted/n=" + std::to_string(n),
+                  sorted.size(), [&]() {
+            s.containsSorted(sorted.data(), sorted.size(), result.data());
+            doNotOptimize(result[0]);
+        });
+    }
+}
+
+BENCHMARK(RangeSetViews) {
+    for (size_t n = 100; n <= 100000; n *= 10) {
+        RangeSet s = randomRangeSet(n, 16.0, WORKLOAD_SEED);
+        RangeSet t = randomRangeSet(n, 16.0, WORKLOAD_SEED + 1);
+        std::vector<uint8_t> buffer = s.encode();
+        RangeSetView v(buffer);
+        uint64_t items = s.size() + t.size();
+        std::string suffix = "/n=" + std::to_string(n);
+        b.measure("rangeset_view/encode" + suffix, s.size(), [&]() {
+            doNotOptimize(s.encode().size());
+        });
+        b.measure("rangeset_view/decode" + suffix, s.size(), [&]() {
+            doNotOptimize(RangeSet::decode(buffer).size());
+        });
+        b.measure("rangeset_view/intersection" + suffix, items, [&]() {
+            doNotOptimize(v.intersection(t).size());
+        });
+        b.measure("rangeset_view/intersects" + suffix, items, [&]() {
+            doNotOptimize(v.intersects(t));
+        });
+        b.measure("rangeset_view/contains" + suffix, items, [&]() {
+            doNotOptimize(v.contains(t));
+        });
+        b.measure("rangeset_view/contains_range" + suffix, 1, [&]() {
+            doNotOptimize(v.contains(12345, 12346));
+        });
+    }
+}
@@ -0,0 +1,223 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains benchmarks for region point containment
+///        and spatial relationship tests.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lsst/sphgeom/Box.h"
+#include "lsst/sphgeom/Circle.h"
+#include "lsst/sphgeom/ConvexPolygon.h"
+#include "lsst/sphgeom/Ellipse.h"
+#include "lsst/sphgeom/HtmPixelization.h"
+
+#include "benchmark.h"
+#include "workloads.h"
+
+using namespace lsst::sphgeom;
+
+namespace {
+
+size_t const NUM_POINTS = 4096;
+size_t const NUM_REGIONS = 256;
+
+// `regions` returns a collection of regions of each type, with the given
+// size and random centers.
+std::vector<std::pair<std::string, std::unique_ptr<Region>>> regions(
+    Angle radius)
+{
+    std::vector<std::pair<std::string, std::unique_ptr<Region>>> r;
+    std::vector<Circle> circles = randomCircles(NUM_REGIONS, radius);
+    for (Circle const & c: circles) {
+        UnitVector3d const & v = c.getCenter();
+        r.emplace_back("circle", std::unique_ptr<Region>(new Circle(c)));
+        r.emplace_back("box", std::unique_ptr<Region>(new Box(
+            LonLat(v), radius, radius)));
+        r.emplace_back("ellipse", std::unique_ptr<Region>(new Ellipse(
+            v, radius, 0.5 * radius, Angle(0.25 * PI))));
+        std::vector<UnitVector3d> verts;
+        UnitVector3d n = UnitVector3d::orthogonalTo(v);
+        for (int k = 0; k < 6; ++k) {
+            verts.push_back(v.rotatedAround(n, radius)
+                             .rotatedAround(v, Angle(PI * k / 3.0)));
+        }
+        r.emplace_back("polygon", std::unique_ptr<Region>(
+            new ConvexPolygon(verts)));
+    }
+    return r;
+}
+
+} // unnamed namespace
+
+BENCHMARK(Contains) {
+    std::vector<UnitVector3d> points = randomPoints(NUM_POINTS);
+    std::vector<double> x, y, z;
+    for (UnitVector3d const & v: points) {
+        x.push_back(v.x());
+        y.push_back(v.y());
+        z.push_back(v.z());
+    }
+    std::vector<uint64_t> result((NUM_POINTS + 63) / 64);
+    auto r = regions(Angle::fromDegrees(30.0));
+    for (char const * type: {"circle", "box", "ellipse", "polygon"}) {
+        Region const * region = nullptr;
+        for (auto const & p: r) {
+            if (p.first == type) {
+                region = p.second.get();
+                break;
+            }
+        }
+        b.measure(std::string("contains/") + type + "/single", NUM_POINTS,
+                  [&]() {
+            size_t c = 0;
+            for (UnitVector3d const & v: points) {
+                c += region->contains(v);
+            }
+            doNotOptimize(c);
+        });
+        b.measure(std::string("contains/") + type + "/batch", NUM_POINTS,
+                  [&]() {
+            region->contains(x.data(), y.data(), z.data(), NUM_POINTS,
+                             result.data());
+            doNotOptimize(result[0]);
+        });
+    }
+}
+
+BENCHMARK(Relate) {
+    struct Radius {
+        char const * name;
+        double degrees;
+    };
+    Radius const radii[] = {{"36arcsec", 0.01}, {"1deg", 1.0}, {"10deg", 10.0}};
+    for (Radius const & radius: radii) {
+        auto r = regions(Angle::fromDegrees(radius.degrees));
+        for (char const * t1: {"circle", "box", "ellipse", "polygon"}) {
+            for (char const * t2: {"circle", "box", "ellipse", "polygon"}) {
+                std::vector<Region const *> a, b2;
+                for (auto const & p: r) {
+                    if (p.first == t1) {
+                        a.push_back(p.second.get());
+                    }
+                    if (p.first == t2) {
+                        b2.push_back(p.second.get());
+                    }
+                }
+                std::string name = std::string("relate/") + t1 + "/" + t2 +
+                                   "/radius=" + radius.name;
+                b.measure(name, 2 * a.size(), [&]() {
+                    int s = 0;
+                    for (size_t i = 0; i < a.size(); ++i) {
+                        // Relate every region to a nearby region of the
+                        // other type, and to a random one.
+                        s += a[i]->relate(*b2[i]).to_ulong();
+                        s += a[i]->relate(*b2[(i * 7 + 1) % b2.size()])
+                             .to_ulong();
+                    }
+                    doNotOptimize(s);
+                });
+            }
+        }
+    }
+}
+
+BENCHMARK(PixelRelate) {
+    // Relate regions to the trixels they straddle.
+    for (int level: {8, 16}) {
+        std::vector<ConvexPolygon> polygons =
+            polygonsNearPixelBoundaries(NUM_REGIONS, level);
+        HtmPixelization pixelization(level);
+        std::vector<ConvexPolygon> trixels;
+        for (ConvexPolygon const & p: polygons) {
+            trixels.push_back(HtmPixelization::triangle(
+                pixelization.index(p.getVertices()[0])));
+        }
+        b.measure("relate/boundary_polygon/trixel/level=" +
+                  std::to_string(level), polygons.size(), [&]() {
+            int s = 0;
+            for (size_t i = 0; i < polygons.size(); ++i) {
+                s += polygons[i].relate(trixels[i]).to_ulong();
+            }
+            doNotOptimize(s);
+        });
+    }
+}
+
+BENCHMARK(EllipseRelate) {
+    // Relate 1 degree ellipses to regions of each type whose centers are
+    // either random, so that most pairs are disjoint, or 1 degree away, so
+    // that the bounding circles of a pair overlap.
+    Angle const radius = Angle::fromDegrees(1.0);
+    auto e = regions(radius);
+    std::vector<Ellipse const *> ellipses;
+    for (auto const & p: e) {
+        if (p.first == "ellipse") {
+            ellipses.push_back(static_cast<Ellipse const *>(p.second.get()));
+        }
+    }
+    std::vector<std::pair<std::string, std::unique_ptr<Region>>> near;
+    for (Ellipse const * ellipse: ellipses) {
+        UnitVector3d const & v = ellipse->getCenter();
+        UnitVector3d w = v.rotatedAround(UnitVector3d::orthogonalTo(v),
+                                         radius);
+        near.emplace_back("circle", std::unique_ptr<Region>(
+            new Circle(w, radius)));
+        near.emplace_back("box", std::unique_ptr<Region>(
+            new Box(LonLat(w), radius, radius)));
+        near.emplace_back("ellipse", std::unique_ptr<Region>(
+            new Ellipse(w, radius, 0.5 * radius, Angle(0.75 * PI))));
+    }
+    for (char const * type: {"circle", "box", "ellipse"}) {
+        std::vector<Region const *> random, nearby;
+        for (auto const & p: e) {
+            if (p.first == type) {
+                random.push_back(p.second.get());
+            }
+        }
+        for (auto const & p: near) {
+            if (p.first == type) {
+                nearby.push_back(p.second.get());
+            }
+        }
+        std::string name = std::string("relate/ellipse/") + type +
+                           "/radius=1deg";
+        b.measure(name + "/random_pairs", ellipses.size(), [&]() {
+            int s = 0;
+            for (size_t i = 0; i < ellipses.size(); ++i) {
+                s += ellipses[i]->relate(
+                    *random[(i * 7 + 1) % random.size()]).to_ulong();
+            }
+            doNotOptimize(s);
+        });
+        b.measure(name + "/nearby_pairs", ellipses.size(), [&]() {
+            int s = 0;
+            for (size_t i = 0; i < ellipses.size(); ++i) {
+                s += ellipses[i]->relate(*nearby[i]).to_ulong();
+            }
+            doNotOptimize(s);
+        });
+    }
+}
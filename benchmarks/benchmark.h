@@ -0,0 +1,266 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_SPHGEOM_BENCHMARK_H_
+#define LSST_SPHGEOM_BENCHMARK_H_
+
+/// \file
+/// \brief This file defines a simple header-only benchmarking framework.
+///
+/// Benchmarks are defined with the BENCHMARK macro, and time operations
+/// via Benchmark::measure. Each benchmark program accepts the following
+/// command line arguments:
+///
+///   - `--filter=<s>`: only run measurements with names containing `s`.
+///   - `--min-time=<t>`: spend at least `t` seconds on each measurement
+///     (the default is 0.25).
+///   - `--csv`: print results as comma separated values, suitable for
+///     comparison between commits with `benchmarks/compare.py`.
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+namespace lsst {
+namespace sphgeom {
+
+/// `doNotOptimize` prevents the compiler from optimizing away the
+/// computation of `value`.
+template <typename T>
+inline void doNotOptimize(T const & value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static T volatile sink;
+    sink = value;
+#endif
+}
+
+
+/// `BenchmarkResult` summarizes the timings of a single measurement.
+/// Operations are timed in batches, and the batchMean fields are
+/// percentiles of the mean time per operation in each batch, in
+/// nanoseconds. They are not percentiles of single-operation latencies.
+struct BenchmarkResult {
+    std::string name;
+    uint64_t operations;
+    double itemsPerSecond;
+    double batchMeanP50;
+    double batchMeanP90;
+    double batchMeanP99;
+};
+
+
+/// `Benchmark` is passed to every benchmark function, and is used to time
+/// operations and report the results.
+class Benchmark {
+public:
+    Benchmark(std::string const & filter, double minTime, bool csv) :
+        _filter(filter), _minTime(minTime), _csv(csv), _header(false)
+    {}
+
+    /// `measure` repeatedly calls `op`, which should perform one operation
+    /// involving `itemsPerOp` items (e.g. points or ranges), and reports its
+    /// throughput and batch mean time percentiles under the given name.
+    ///
+    /// Operations are timed in batches that take at least about a
+    /// millisecond, and the mean time per operation of each batch is
+    /// recorded.
+    template <typename Op>
+    void measure(std::string const & name, uint64_t itemsPerOp, Op op);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    static double _seconds(Clock::duration d) {
+        return std::chrono::duration<double>(d).count();
+    }
+
+    void _report(BenchmarkResult const & r);
+
+    std::string _filter;
+    double _minTime;
+    bool _csv;
+    bool _header;
+};
+
+template <typename Op>
+void Benchmark::measure(std::string const & name, uint64_t itemsPerOp, Op op) {
+    static double const SAMPLE_TIME = 1.0e-3;
+    static size_t const MAX_SAMPLES = 10000;
+    if (name.find(_filter) == std::string::npos) {
+        return;
+    }
+    // Warm up, and estimate the number of operations per batch.
+    Clock::time_point start = Clock::now();
+    op();
+    double t = _seconds(Clock::now() - start);
+    uint64_t batch = 1;
+    if (t < SAMPLE_TIME) {
+        batch = static_cast<uint64_t>(SAMPLE_TIME / std::max(t, 1.0e-9));
+        start = Clock::now();
+        for (uint64_t i = 0; i < batch; ++i) {
+            op();
+        }
+        t = _seconds(Clock::now() - start) / batch;
+        batch = std::max<uint64_t>(
+            1, static_cast<uint64_t>(SAMPLE_TIME / std::max(t, 1.0e-9)));
+    }
+    std::vector<double> batchMeans;
+    double total = 0.0;
+    uint64_t operations = 0;
+    while ((total < _minTime || batchMeans.size() < 10) &&
+           batchMeans.size() < MAX_SAMPLES) {
+        start = Clock::now();
+        for (uint64_t i = 0; i < batch; ++i) {
+            op();
+        }
+        double s = _seconds(Clock::now() - start);
+        total += s;
+        operations += batch;
+        batchMeans.push_back(1.0e9 * s / batch);
+    }
+    std::sort(batchMeans.begin(), batchMeans.end());
+    auto percentile = [&batchMeans](double p) {
+        size_t i = static_cast<size_t>(p * (batchMeans.size() - 1) + 0.5);
+        return batchMeans[i];
+    };
+    BenchmarkResult r;
+    r.name = name;
+    r.operations = operations;
+    r.itemsPerSecond = static_cast<double>(operations * itemsPerOp) / total;
+    r.batchMeanP50 = percentile(0.5);
+    r.batchMeanP90 = percentile(0.9);
+    r.batchMeanP99 = percentile(0.99);
+    _report(r);
+}
+
+void Benchmark::_report(BenchmarkResult const & r) {
+    if (_csv) {
+        if (!_header) {
+            std::cout << "name,operations,items_per_second,"
+                         "batch_mean_p50_ns,batch_mean_p90_ns,"
+                         "batch_mean_p99_ns\n";
+        }
+        std::cout << r.name << ',' << r.operations << ','
+                  << std::setprecision(6) << r.itemsPerSecond << ','
+                  << r.batchMeanP50 << ',' << r.batchMeanP90 << ','
+                  << r.batchMeanP99 << std::endl;
+    } else {
+        if (!_header) {
+            std::cout << std::left << std::setw(48) << "name"
+                      << std::right << std::setw(12) << "ops"
+                      << std::setw(14) << "items/s"
+                      << std::setw(16) << "batch p50 (ns)"
+                      << std::setw(16) << "batch p90 (ns)"
+                      << std::setw(16) << "batch p99 (ns)" << '\n';
+        }
+        std::cout << std::left << std::setw(48) << r.name
+                  << std::right << std::setw(12) << r.operations
+                  << std::setprecision(4)
+                  << std::setw(14) << r.itemsPerSecond
+                  << std::setw(16) << r.batchMeanP50
+                  << std::setw(16) << r.batchMeanP90
+                  << std::setw(16) << r.batchMeanP99 << std::endl;
+    }
+    _header = true;
+}
+
+
+typedef void (*BenchmarkFunction)(Benchmark &);
+
+
+/// `Benchmarks` is a singleton that registers and runs benchmark functions.
+class Benchmarks {
+public:
+    static void add(BenchmarkFunction f) { singleton()._functions.push_back(f); }
+
+    /// `run` parses command line arguments and runs all registered
+    /// benchmark functions. It returns a process exit code.
+    static int run(int argc, char const * const * argv);
+
+private:
+    static Benchmarks & singleton() {
+        static Benchmarks b;
+        return b;
+    }
+
+    std::vector<BenchmarkFunction> _functions;
+};
+
+int Benchmarks::run(int argc, char const * const * argv) {
+    std::string filter;
+    double minTime = 0.25;
+    bool csv = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+            filter = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--min-time=", 11) == 0) {
+            minTime = std::atof(argv[i] + 11);
+        } else if (std::strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        } else {
+            std::cerr << "usage: " << argv[0]
+                      << " [--filter=<substring>] [--min-time=<seconds>]"
+                         " [--csv]" << std::endl;
+            return 1;
+        }
+    }
+    Benchmark b(filter, minTime, csv);
+    for (BenchmarkFunction f: singleton()._functions) {
+        f(b);
+    }
+    return 0;
+}
+
+
+/// `BenchmarkRegistrar` instances register benchmark functions.
+struct BenchmarkRegistrar {
+    explicit BenchmarkRegistrar(BenchmarkFunction f) { Benchmarks::add(f); }
+};
+
+}} // namespace lsst::sphgeom
+
+
+/// `BENCHMARK` defines a benchmark function and automatically registers it
+/// for execution. The function body has access to a `Benchmark` named `b`.
+#define BENCHMARK(name)\
+static void name(::lsst::sphgeom::Benchmark & b);\
+\
+static ::lsst::sphgeom::BenchmarkRegistrar name ## _registrar (name);\
+\
+static void name(::lsst::sphgeom::Benchmark & b)
+
+
+int main(int argc, char ** argv) {
+    return ::lsst::sphgeom::Benchmarks::run(argc, argv);
+}
+
+#endif // LSST_SPHGEOM_BENCHMARK_H_
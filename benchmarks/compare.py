@@ -0,0 +1,100 @@
+#!/usr/bin/env python
+#
+# LSST Data Management System
+# Copyright 2016 AURA/LSST.
+#
+# This product includes software developed by the
+# LSST Project (http://www.lsst.org/).
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the LSST License Statement and
+# the GNU General Public License along with this program.  If not,
+# see <https://www.lsstcorp.org/LegalNotices/>.
+#
+
+"""This script compares the CSV output of two runs of the sphgeom
+benchmark programs, e.g. for two different commits:
+
+    benchmarks/benchEnvelope --csv > before.csv
+    # ... check out and build another commit ...
+    benchmarks/benchEnvelope --csv > after.csv
+    python benchmarks/compare.py before.csv after.csv
+
+For each measurement present in both files, the ratio of the new median
+batch mean time per operation to the old one is printed. Operations are
+timed in batches, so this is not a single-operation latency. Measurements
+whose median changed by more than the threshold are flagged, and the exit
+status is non-zero if any of them got slower.
+"""
+
+from __future__ import print_function
+
+import argparse
+import csv
+import sys
+
+
+def read(path):
+    """Return a dict mapping measurement names to result rows."""
+    with open(path) as f:
+        rows = (line for line in f if not line.startswith("#"))
+        return {r["name"]: r for r in csv.DictReader(rows)
+                if r["name"] != "name"}
+
+
+def median(row):
+    """Return the median batch mean time per operation of a result row.
+
+    Output of older benchmark builds names this column p50_ns.
+    """
+    if "batch_mean_p50_ns" in row:
+        return float(row["batch_mean_p50_ns"])
+    return float(row["p50_ns"])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("old", help="CSV benchmark output of the baseline")
+    parser.add_argument("new", help="CSV benchmark output to compare")
+    parser.add_argument("--threshold", type=float, default=0.1,
+                        help="relative change in median batch mean time "
+                             "per operation that is reported as "
+                             "significant (default: 0.1)")
+    args = parser.parse_args()
+    old = read(args.old)
+    new = read(args.new)
+    width = max([len(n) for n in new] + [4])
+    print("{:<{w}} {:>12} {:>12} {:>8}".format(
+        "name", "old median", "new median", "ratio", w=width))
+    regressions = 0
+    for name in new:
+        if name not in old:
+            continue
+        a = median(old[name])
+        b = median(new[name])
+        ratio = b / a if a > 0.0 else float("inf")
+        flag = ""
+        if ratio > 1.0 + args.threshold:
+            flag = "  slower"
+            regressions += 1
+        elif ratio < 1.0 / (1.0 + args.threshold):
+            flag = "  faster"
+        print("{:<{w}} {:>12.4g} {:>12.4g} {:>8.3f}{}".format(
+            name, a, b, ratio, flag, w=width))
+    missing = sorted(set(old) - set(new))
+    for name in missing:
+        print("{:<{w}} missing from {}".format(name, args.new, w=width))
+    return 1 if regressions > 0 else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
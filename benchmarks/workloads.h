@@ -0,0 +1,178 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_SPHGEOM_BENCHMARKS_WORKLOADS_H_
+#define LSST_SPHGEOM_BENCHMARKS_WORKLOADS_H_
+
+/// \file
+/// \brief This file contains generators for the synthetic, reproducible
+///        workloads shared by the benchmark programs.
+///
+/// All generators use a fixed seed, so that the same inputs are produced
+/// by every run, on every machine and at every commit.
+
+#include <stdint.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "lsst/sphgeom/Angle.h"
+#include "lsst/sphgeom/Circle.h"
+#include "lsst/sphgeom/ConvexPolygon.h"
+#include "lsst/sphgeom/HtmPixelization.h"
+#include "lsst/sphgeom/RangeSet.h"
+#include "lsst/sphgeom/UnitVector3d.h"
+
+
+namespace lsst {
+namespace sphgeom {
+
+/// `WORKLOAD_SEED` seeds the random number generators of all workloads.
+static uint64_t const WORKLOAD_SEED = 0x5eed5eed5eedULL;
+
+/// `randomPoint` returns a point drawn from the uniform distribution on S².
+inline UnitVector3d randomPoint(std::mt19937_64 & rng) {
+    std::normal_distribution<double> normal;
+    while (true) {
+        double x = normal(rng);
+        double y = normal(rng);
+        double z = normal(rng);
+        if (x * x + y * y + z * z > 1.0e-10) {
+            return UnitVector3d(x, y, z);
+        }
+    }
+}
+
+/// `randomPoints` returns `n` points drawn uniformly from S².
+inline std::vector<UnitVector3d> randomPoints(size_t n,
+                                              uint64_t seed = WORKLOAD_SEED)
+{
+    std::mt19937_64 rng(seed);
+    std::vector<UnitVector3d> points;
+    points.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        points.push_back(randomPoint(rng));
+    }
+    return points;
+}
+
+/// `clusteredPoints` returns `n` points scattered around a random center,
+/// at typical angular distances of about `radius` from it, like the
+/// sources detected in a single telescope field of view.
+inline std::vector<UnitVector3d> clusteredPoints(size_t n,
+                                                 Angle radius,
+                                                 uint64_t seed = WORKLOAD_SEED)
+{
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> normal(0.0, radius.asRadians());
+    UnitVector3d center = randomPoint(rng);
+    std::vector<UnitVector3d> points;
+    points.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        points.push_back(UnitVector3d(center + Vector3d(normal(rng),
+                                                        normal(rng),
+                                                        normal(rng))));
+    }
+    return points;
+}
+
+/// `randomCircles` returns `n` circles with the given opening angle and
+/// centers drawn uniformly from S².
+inline std::vector<Circle> randomCircles(size_t n,
+                                         Angle radius,
+                                         uint64_t seed = WORKLOAD_SEED)
+{
+    std::vector<Circle> circles;
+    circles.reserve(n);
+    for (UnitVector3d const & v: randomPoints(n, seed)) {
+        circles.push_back(Circle(v, radius));
+    }
+    return circles;
+}
+
+/// `polygonsNearPixelBoundaries` returns `n` small quadrilaterals, each
+/// straddling the boundary of a randomly chosen HTM trixel at the given
+/// subdivision level. Quadrilateral centers are placed on trixel vertices
+/// or edge midpoints, and their size is a fraction of the trixel size.
+/// Such polygons defeat the early exits of pixelization traversals, and
+/// exercise the near-degenerate orientation tests of polygon-polygon
+/// relations.
+inline std::vector<ConvexPolygon> polygonsNearPixelBoundaries(
+    size_t n,
+    int level,
+    uint64_t seed = WORKLOAD_SEED)
+{
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<uint64_t> trixel(
+        8 * (uint64_t(1) << 2 * level), 16 * (uint64_t(1) << 2 * level) - 1);
+    std::uniform_int_distribution<int> vertex(0, 5);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    double size = 0.25 * HtmPixelization::triangle(8).getBoundingCircle()
+                         .getOpeningAngle().asRadians() / (1 << level);
+    std::vector<ConvexPolygon> polygons;
+    polygons.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        ConvexPolygon t = HtmPixelization::triangle(trixel(rng));
+        std::vector<UnitVector3d> const & verts = t.getVertices();
+        int j = vertex(rng);
+        UnitVector3d c = (j < 3) ? verts[j] :
+            UnitVector3d(verts[j - 3] + verts[(j - 2) % 3]);
+        UnitVector3d n0 = UnitVector3d::orthogonalTo(c);
+        UnitVector3d n1(c.cross(n0));
+        Angle rotation(2.0 * PI * uniform(rng));
+        std::vector<UnitVector3d> quad;
+        for (int k = 0; k < 4; ++k) {
+            Angle a = rotation + Angle(0.5 * PI * k);
+            quad.push_back(UnitVector3d(
+                c + size * (cos(a) * n0 + sin(a) * n1)));
+        }
+        polygons.push_back(ConvexPolygon(quad));
+    }
+    return polygons;
+}
+
+/// `randomRangeSet` returns a set of `n` disjoint ranges, with gaps and
+/// lengths drawn from geometric distributions with the given mean.
+inline RangeSet randomRangeSet(size_t n,
+                               double meanLength,
+                               uint64_t seed = WORKLOAD_SEED)
+{
+    std::mt19937_64 rng(seed);
+    std::geometric_distribution<uint64_t> length(1.0 / meanLength);
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    ranges.reserve(n);
+    uint64_t u = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t first = u + length(rng) + 1;
+        u = first + length(rng) + 1;
+        ranges.emplace_back(first, u);
+    }
+    RangeSet s;
+    for (auto const & r: ranges) {
+        s.insert(r.first, r.second);
+    }
+    return s;
+}
+
+}} // namespace lsst::sphgeom
+
+#endif // LSST_SPHGEOM_BENCHMARKS_WORKLOADS_H_
@@ -312,6 +312,12 @@ public:
         return contains(LonLat(v));
     }
 
+    void contains(double const * x,
+                  double const * y,
+                  double const * z,
+                  size_t n,
+                  uint64_t * result) const override;
+
     Relationship relate(Region const & r) const override {
         // Dispatch on the type of r.
         return invert(r.relate(*this));
@@ -0,0 +1,173 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_SPHGEOM_CHUNKPARTITIONER_H_
+#define LSST_SPHGEOM_CHUNKPARTITIONER_H_
+
+/// \file
+/// \brief This file declares a class for partitioning catalog rows
+///        into chunks.
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Chunker.h"
+#include "LonLat.h"
+
+
+namespace lsst {
+namespace sphgeom {
+
+/// `ChunkRow` describes a single row stored in a ChunkBuffer.
+struct ChunkRow {
+    /// `subChunkId` is the ID of the sub-chunk the row was assigned to.
+    int32_t subChunkId;
+    /// `overlap` is true if the row lies outside of its sub-chunk, but
+    /// within its overlap bounds.
+    bool overlap;
+    /// `offset` is the position of the row payload in ChunkBuffer::data.
+    size_t offset;
+    /// `size` is the length of the row payload in bytes.
+    size_t size;
+};
+
+
+/// `ChunkBuffer` holds rows that have been assigned to a particular chunk,
+/// in the order in which they were added.
+struct ChunkBuffer {
+    int32_t chunkId;
+    std::vector<ChunkRow> rows;
+    std::string data;
+
+    ChunkBuffer() : chunkId(-1) {}
+
+    /// `getPayload` returns the payload of the i-th row.
+    std::string getPayload(size_t i) const {
+        return data.substr(rows[i].offset, rows[i].size);
+    }
+};
+
+
+/// `ChunkPartitioner` assigns catalog rows to the chunks and sub-chunks of
+/// a Chunker, and hands them to a sink chunk by chunk.
+///
+/// Rows are added in batches. The home chunk and sub-chunk of each row in
+/// a batch are computed with Chunker::locate, and if the chunker has a
+/// positive overlap radius, so are the other sub-chunks with overlap bounds
+/// containing the row (see Chunker::getOverlapSubChunks). The batch is
+/// split between threads for this, as it dominates the cost of
+/// partitioning, unless it is too small for threads to pay off. Rows are
+/// then appended to per-chunk buffers. When several threads are used, each
+/// copies the rows in its part of the batch to chunk buffers of its own,
+/// and these are merged into the per-chunk buffers of the partitioner.
+///
+/// The total size of the buffered rows is bounded: whenever a batch pushes
+/// it over the limit, the largest buffers are passed to the sink and
+/// emptied until at most half the limit remains buffered. The sink may
+/// therefore be called several times for the same chunk, and should append
+/// rows to whatever output it maintains for that chunk. The sink is always
+/// called from the thread calling `add` or `flush`, and the order of calls
+/// depends only on the rows added, not on the number of threads used.
+///
+/// Buffered rows are not passed to the sink on destruction; call `flush`
+/// once all rows have been added.
+class ChunkPartitioner {
+public:
+    /// `Sink` is the type of the function that consumes chunk buffers.
+    typedef std::function<void(ChunkBuffer const &)> Sink;
+
+    /// `Statistics` summarizes the work done by a partitioner.
+    struct Statistics {
+        /// `numRows` is the number of rows added.
+        uint64_t numRows;
+        /// `numOverlapRows` is the number of overlap rows generated.
+        uint64_t numOverlapRows;
+        /// `numFlushes` is the number of times the sink has been called.
+        uint64_t numFlushes;
+        /// `bufferedBytes` is the current size of the buffered rows.
+        size_t bufferedBytes;
+
+        Statistics() :
+            numRows(0), numOverlapRows(0), numFlushes(0), bufferedBytes(0)
+        {}
+    };
+
+    /// `DEFAULT_MAX_BUFFERED_BYTES` is the default bound on the size
+    /// of the buffered rows.
+    static constexpr size_t DEFAULT_MAX_BUFFERED_BYTES = 64 * 1024 * 1024;
+
+    /// This constructor creates a partitioner for the given chunker.
+    /// `numThreads` is the number of threads used to assign rows to chunks,
+    /// with 0 meaning that the value returned by
+    /// `std::thread::hardware_concurrency()` should be used.
+    ChunkPartitioner(Chunker const & chunker,
+                     Sink sink,
+                     size_t maxBufferedBytes = DEFAULT_MAX_BUFFERED_BYTES,
+                     unsigned int numThreads = 1);
+
+    ChunkPartitioner(ChunkPartitioner const &) = delete;
+    ChunkPartitioner & operator=(ChunkPartitioner const &) = delete;
+
+    Chunker const & getChunker() const { return _chunker; }
+    size_t getMaxBufferedBytes() const { return _maxBufferedBytes; }
+    unsigned int getNumThreads() const { return _numThreads; }
+
+    /// `add` partitions a batch of `n` rows, where `positions[i]` is the
+    /// position of the i-th row and `payloads[i]` its content. If an
+    /// exception is thrown, for example because a position is NaN, none of
+    /// the rows in the batch are buffered.
+    void add(LonLat const * positions, std::string const * payloads, size_t n);
+
+    /// `flush` passes all buffered rows to the sink, in order of
+    /// increasing chunk ID.
+    void flush();
+
+    Statistics getStatistics() const { return _statistics; }
+
+private:
+    // `Assignment` records that a row belongs in a sub-chunk.
+    struct Assignment {
+        size_t row;
+        ChunkLocation location;
+        bool overlap;
+    };
+
+    void _assign(LonLat const * positions,
+                 size_t begin,
+                 size_t end,
+                 std::vector<Assignment> & assignments) const;
+    void _flush(size_t maxBufferedBytes);
+
+    Chunker _chunker;
+    Sink _sink;
+    size_t _maxBufferedBytes;
+    unsigned int _numThreads;
+    std::unordered_map<int32_t, ChunkBuffer> _buffers;
+    Statistics _statistics;
+};
+
+}} // namespace lsst::sphgeom
+
+#endif // LSST_SPHGEOM_CHUNKPARTITIONER_H_
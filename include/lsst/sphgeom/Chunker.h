@@ -28,10 +28,14 @@
 ///        and sub-chunks.
 
 #include <stdint.h>
+#include <utility>
 #include <vector>
 
 #include "Angle.h"
 #include "Box.h"
+#include "LonLat.h"
+#include "RangeSet.h"
+#include "UnitVector3d.h"
 
 
 namespace lsst {
@@ -39,7 +43,7 @@ namespace sphgeom {
 
 /// `SubChunks` represents a set of sub-chunks of a particular chunk.
 ///
-/// TODO(smm): implement a more memory efficient representation than this.
+/// See SubChunkRanges for a more memory efficient representation.
 struct SubChunks {
     int32_t chunkId;
     std::vector<int32_t> subChunkIds;
@@ -53,6 +57,77 @@ struct SubChunks {
 };
 
 
+/// `SubChunkRanges` represents a set of sub-chunks of a particular chunk as
+/// a sorted list of disjoint, non-adjacent, half-open sub-chunk ID ranges.
+///
+/// Sub-chunk IDs are assigned in row-major order within a chunk, so each
+/// sub-stripe of a chunk contributes at most a few ranges, and a chunk that
+/// is entirely covered by a region needs no more than one range per
+/// sub-stripe.
+struct SubChunkRanges {
+    int32_t chunkId;
+    std::vector<std::pair<int32_t, int32_t>> ranges;
+
+    SubChunkRanges() : chunkId(-1) {}
+
+    /// `getNumSubChunks` returns the number of sub-chunks in this set.
+    size_t getNumSubChunks() const {
+        size_t n = 0;
+        for (auto const & r: ranges) {
+            n += static_cast<size_t>(r.second - r.first);
+        }
+        return n;
+    }
+
+    /// `getSubChunkIds` returns the IDs of the sub-chunks in this set,
+    /// in increasing order.
+    std::vector<int32_t> getSubChunkIds() const {
+        std::vector<int32_t> ids;
+        ids.reserve(getNumSubChunks());
+        for (auto const & r: ranges) {
+            for (int32_t i = r.first; i < r.second; ++i) {
+                ids.push_back(i);
+            }
+        }
+        return ids;
+    }
+
+    /// `append` adds the sub-chunks with IDs in [begin, end) to this set.
+    /// Ranges must be appended in increasing order.
+    void append(int32_t begin, int32_t end) {
+        if (!ranges.empty() && ranges.back().second == begin) {
+            ranges.back().second = end;
+        } else {
+            ranges.emplace_back(begin, end);
+        }
+    }
+
+    void swap(SubChunkRanges & sc) {
+        std::swap(chunkId, sc.chunkId);
+        ranges.swap(sc.ranges);
+    }
+};
+
+
+/// `ChunkLocation` identifies the chunk and sub-chunk containing a point.
+struct ChunkLocation {
+    int32_t chunkId;
+    int32_t subChunkId;
+
+    ChunkLocation() : chunkId(-1), subChunkId(-1) {}
+
+    ChunkLocation(int32_t c, int32_t sc) : chunkId(c), subChunkId(sc) {}
+
+    bool operator==(ChunkLocation const & loc) const {
+        return chunkId == loc.chunkId && subChunkId == loc.subChunkId;
+    }
+
+    bool operator!=(ChunkLocation const & loc) const {
+        return chunkId != loc.chunkId || subChunkId != loc.subChunkId;
+    }
+};
+
+
 /// `Chunker` subdivides the unit sphere into longitude-latitude boxes.
 ///
 /// The unit sphere is divided into latitude angle "stripes" of fixed
@@ -63,19 +138,29 @@ struct SubChunks {
 /// subchunks - each stripe is broken into a configureable number of
 /// equal-height "substripes", and each substripe is broken into equal-width
 /// subchunks.
+///
+/// A Chunker can also have an overlap radius R. The overlap bounds of a
+/// chunk or sub-chunk are obtained by dilating its longitude-latitude box
+/// by R (see Box::dilatedBy), and contain every point within angular
+/// separation R of it. They are used to find the "overlap" rows that a
+/// chunk needs to evaluate spatial joins near its boundaries locally.
 class Chunker {
 public:
+    /// This constructor creates a Chunker with the given number of stripes
+    /// and sub-stripes per stripe, and overlap radius. The overlap radius
+    /// must be non-negative and at most the height of a sub-stripe.
     Chunker(int32_t numStripes,
-            int32_t numSubStripesPerStripe);
+            int32_t numSubStripesPerStripe,
+            Angle overlap = Angle(0.0));
 
     bool operator==(Chunker const & c) const {
         return _numStripes == c._numStripes &&
-               _numSubStripesPerStripe == c._numSubStripesPerStripe;
+               _numSubStripesPerStripe == c._numSubStripesPerStripe &&
+               _overlap == c._overlap;
     }
 
     bool operator!=(Chunker const & c) const {
-        return _numStripes != c._numStripes ||
-               _numSubStripesPerStripe != c._numSubStripesPerStripe;
+        return !(*this == c);
     }
 
     /// `getNumStripes` returns the number of fixed-height latitude intervals
@@ -90,6 +175,11 @@ public:
         return _numSubStripesPerStripe;
     }
 
+    /// `getOverlap` returns the overlap radius of this chunker.
+    Angle getOverlap() const {
+        return _overlap;
+    }
+
     /// `getChunksIntersecting` returns all the chunks that potentially
     /// intersect the given region.
     std::vector<int32_t> getChunksIntersecting(Region const & r) const;
@@ -98,6 +188,110 @@ public:
     /// intersect the given region.
     std::vector<SubChunks> getSubChunksIntersecting(Region const & r) const;
 
+    /// `getSubChunkRangesIntersecting` returns all the sub-chunks that
+    /// potentially intersect the given region, as ranges of sub-chunk IDs.
+    /// The sub-chunks are the same as those returned by
+    /// getSubChunksIntersecting, but large results take far less memory.
+    std::vector<SubChunkRanges> getSubChunkRangesIntersecting(
+        Region const & r) const;
+
+    ///@{
+    /// `locate` returns the IDs of the chunk and sub-chunk containing the
+    /// given point. IDs are computed directly from the point coordinates,
+    /// in constant time. A point on a chunk or sub-chunk boundary is
+    /// assigned to exactly one of the adjacent chunks or sub-chunks, and
+    /// the sub-chunk is always one of the sub-chunks of the chunk.
+    /// std::invalid_argument is thrown if the point is NaN.
+    ChunkLocation locate(LonLat const & p) const;
+    ChunkLocation locate(UnitVector3d const & v) const {
+        return locate(LonLat(v));
+    }
+    ///@}
+
+    ///@{
+    /// `locate` stores the chunk and sub-chunk IDs of the `n` given points
+    /// in `locations`, which must have room for `n` elements.
+    /// std::invalid_argument is thrown if any point is NaN.
+    void locate(LonLat const * points,
+                ChunkLocation * locations,
+                size_t n) const;
+    void locate(UnitVector3d const * points,
+                ChunkLocation * locations,
+                size_t n) const;
+    ///@}
+
+    ///@{
+    /// `getOverlapChunks` returns the IDs of all chunks with overlap bounds
+    /// containing the given point, in increasing order. These always
+    /// include the chunk returned by `locate`. Chunks are found with
+    /// arithmetic on per-stripe tables computed at construction time, and
+    /// no region relationship tests are performed. std::invalid_argument is
+    /// thrown if the point is NaN.
+    std::vector<int32_t> getOverlapChunks(LonLat const & p) const;
+    std::vector<int32_t> getOverlapChunks(UnitVector3d const & v) const {
+        return getOverlapChunks(LonLat(v));
+    }
+    ///@}
+
+    ///@{
+    /// `getOverlapSubChunks` returns the locations of all sub-chunks with
+    /// overlap bounds containing the given point, ordered by chunk and then
+    /// sub-chunk ID. These always include the location returned by `locate`.
+    /// std::invalid_argument is thrown if the point is NaN.
+    std::vector<ChunkLocation> getOverlapSubChunks(LonLat const & p) const;
+    std::vector<ChunkLocation> getOverlapSubChunks(
+        UnitVector3d const & v) const
+    {
+        return getOverlapSubChunks(LonLat(v));
+    }
+    ///@}
+
+    ///@{
+    /// `getOverlapSubChunks` computes the overlap sub-chunk locations of
+    /// the `n` given points. The locations for point i are stored in
+    /// `locations[offsets[i]]` through `locations[offsets[i + 1] - 1]`.
+    /// Both vectors are overwritten, and `offsets` has size n + 1 on return.
+    /// std::invalid_argument is thrown if any point is NaN.
+    void getOverlapSubChunks(LonLat const * points,
+                             size_t n,
+                             std::vector<ChunkLocation> & locations,
+                             std::vector<size_t> & offsets) const;
+    void getOverlapSubChunks(UnitVector3d const * points,
+                             size_t n,
+                             std::vector<ChunkLocation> & locations,
+                             std::vector<size_t> & offsets) const;
+    ///@}
+
+    ///@{
+    /// `getGlobalSubChunkId` returns an ID for the given sub-chunk of the
+    /// given chunk that is unique across all chunks. The global IDs of the
+    /// sub-chunks of a chunk are consecutive if the chunk has the same
+    /// number of sub-chunks in every sub-stripe, and follow those of the
+    /// preceding chunk. `getChunkLocation` inverts this mapping.
+    uint64_t getGlobalSubChunkId(int32_t chunkId, int32_t subChunkId) const {
+        return static_cast<uint64_t>(chunkId) * _getNumSubChunkIdsPerChunk() +
+               static_cast<uint64_t>(subChunkId);
+    }
+    ChunkLocation getChunkLocation(uint64_t globalSubChunkId) const {
+        uint64_t const n = _getNumSubChunkIdsPerChunk();
+        return ChunkLocation(static_cast<int32_t>(globalSubChunkId / n),
+                             static_cast<int32_t>(globalSubChunkId % n));
+    }
+    ///@}
+
+    /// `getChunkSetIntersecting` returns the IDs of all the chunks that
+    /// potentially intersect the given region, as a RangeSet. It contains
+    /// the same chunks as the result of getChunksIntersecting.
+    RangeSet getChunkSetIntersecting(Region const & r) const;
+
+    /// `getSubChunkSetIntersecting` returns the global IDs (see
+    /// getGlobalSubChunkId) of all the sub-chunks that potentially intersect
+    /// the given region, as a RangeSet. It contains the same sub-chunks as
+    /// the result of getSubChunksIntersecting, in a single allocation, and
+    /// can be combined with other sets of sub-chunks using RangeSet
+    /// operations.
+    RangeSet getSubChunkSetIntersecting(Region const & r) const;
+
     /// `getAllChunks` returns the complete set of chunk IDs for the unit
     /// sphere.
     std::vector<int32_t> getAllChunks() const;
@@ -107,13 +301,24 @@ public:
     std::vector<int32_t> getAllSubChunks(int32_t chunkId) const;
 
 private:
+    // The overlap half-widths of stripes and sub-stripes are the amounts by
+    // which the longitude intervals of their chunks and sub-chunks are
+    // dilated to obtain overlap bounds. Similarly, the bounding boxes of
+    // chunks and sub-chunks have latitude intervals `boxLat`, and longitude
+    // intervals dilated by `boxHalfWidth`. These are precomputed so that
+    // bounding boxes can be built without trigonometry.
     struct Stripe {
         Angle chunkWidth;
+        Angle overlapHalfWidth;
+        Angle boxHalfWidth;
+        AngleInterval boxLat;
         int32_t numChunksPerStripe;
         int32_t numSubChunksPerChunk;
 
         Stripe() :
             chunkWidth(0),
+            overlapHalfWidth(0),
+            boxHalfWidth(0),
             numChunksPerStripe(0),
             numSubChunksPerChunk(0)
         {}
@@ -121,11 +326,25 @@ private:
 
     struct SubStripe {
         Angle subChunkWidth;
+        Angle overlapHalfWidth;
+        Angle boxHalfWidth;
+        AngleInterval boxLat;
         int32_t numSubChunksPerChunk;
 
-        SubStripe() : subChunkWidth(), numSubChunksPerChunk(0) {}
+        SubStripe() :
+            subChunkWidth(),
+            overlapHalfWidth(0),
+            boxHalfWidth(0),
+            numSubChunksPerChunk(0)
+        {}
     };
 
+    // Sub-chunk IDs lie in [0, _getNumSubChunkIdsPerChunk()).
+    uint64_t _getNumSubChunkIdsPerChunk() const {
+        return static_cast<uint64_t>(_numSubStripesPerStripe) *
+               static_cast<uint64_t>(_maxSubChunksPerSubStripeChunk);
+    }
+
     int32_t _getStripe(int32_t chunkId) const {
         return chunkId / (2 * _numStripes);
     }
@@ -142,21 +361,66 @@ private:
         return y * _maxSubChunksPerSubStripeChunk + x;
     }
 
-    void _getSubChunks(std::vector<SubChunks> & subChunks,
-                       Region const & r,
-                       NormalizedAngleInterval const & lon,
-                       int32_t stripe,
-                       int32_t chunk,
-                       int32_t minSS,
-                       int32_t maxSS) const;
-    Box _getChunkBoundingBox(int32_t stripe, int32_t chunk) const;
-    Box _getSubChunkBoundingBox(int32_t subStripe, int32_t subChunk) const;
+    // The region query implementations below record their results in
+    // either vectors or RangeSets; see the output types in Chunker.cc.
+    template <typename Chunks>
+    void _getChunksIntersecting(Chunks & chunks, Region const & r) const;
+    template <typename SubChunkSink>
+    void _getSubChunksIntersecting(SubChunkSink & sink,
+                                   Region const & r) const;
+    template <typename Chunks>
+    void _findChunks(Chunks & chunks,
+                     Region const & r,
+                     int32_t stripe,
+                     int32_t minChunk,
+                     int32_t maxChunk) const;
+    template <typename SubChunkSink>
+    void _findSubChunks(SubChunkSink & sink,
+                        Region const & r,
+                        NormalizedAngleInterval const & lon,
+                        int32_t stripe,
+                        int32_t minChunk,
+                        int32_t maxChunk,
+                        int32_t minSS,
+                        int32_t maxSS) const;
+    template <typename SubChunkSink>
+    void _findSubChunksOfChunk(SubChunkSink & sink,
+                               Region const & r,
+                               NormalizedAngleInterval const & lon,
+                               int32_t stripe,
+                               int32_t chunk,
+                               int32_t minSS,
+                               int32_t maxSS) const;
+    template <typename SubChunkSink>
+    void _findSubChunksOfSubStripe(SubChunkSink & sink,
+                                   Region const & r,
+                                   int32_t stripe,
+                                   int32_t subStripe,
+                                   int32_t chunk,
+                                   int32_t minSubChunk,
+                                   int32_t maxSubChunk) const;
+    template <typename SubChunkSink>
+    void _appendAllSubChunks(SubChunkSink & sink, int32_t stripe) const;
+    // `_getOverlapSubStripes` computes the range [minSS, maxSS] of
+    // sub-stripes with overlap bounds containing latitude `lat`.
+    void _getOverlapSubStripes(Angle lat,
+                               int32_t & minSS,
+                               int32_t & maxSS) const;
+    void _getOverlapSubChunks(LonLat const & p,
+                              std::vector<ChunkLocation> & locations) const;
+    Box _getChunkBoundingBox(int32_t stripe,
+                             int32_t minChunk,
+                             int32_t maxChunk) const;
+    Box _getSubChunkBoundingBox(int32_t subStripe,
+                                int32_t minSubChunk,
+                                int32_t maxSubChunk) const;
 
     int32_t _numStripes;
     int32_t _numSubStripesPerStripe;
     int32_t _numSubStripes;
     int32_t _maxSubChunksPerSubStripeChunk;
     Angle _subStripeHeight;
+    Angle _overlap;
     std::vector<Stripe> _stripes;
     std::vector<SubStripe> _subStripes;
 };
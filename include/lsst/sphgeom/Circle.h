@@ -232,6 +232,12 @@ public:
                (v - _center).getSquaredNorm() <= _squaredChordLength;
     }
 
+    void contains(double const * x,
+                  double const * y,
+                  double const * z,
+                  size_t n,
+                  uint64_t * result) const override;
+
     Relationship relate(Region const & r) const override {
         // Dispatch on the type of r.
         return invert(r.relate(*this));
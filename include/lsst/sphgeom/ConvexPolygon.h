@@ -30,8 +30,11 @@
 #include <iosfwd>
 #include <vector>
 
+#include "Box3d.h"
+#include "Circle.h"
 #include "Region.h"
 #include "UnitVector3d.h"
+#include "Vector3d.h"
 
 
 namespace lsst {
@@ -54,6 +57,10 @@ namespace sphgeom {
 ///
 /// Currently, the only way to construct a convex polygon is to compute the
 /// convex hull of a point set.
+///
+/// Edge plane normals, a bounding circle and a 3-D bounding box are computed
+/// once, on construction, so that repeated point-in-polygon and relationship
+/// tests do not have to recompute them.
 class ConvexPolygon : public Region {
 public:
     static constexpr uint8_t TYPE_CODE = 'p';
@@ -78,7 +85,9 @@ public:
                   UnitVector3d const & v1,
                   UnitVector3d const & v2) :
         _vertices{v0, v1, v2}
-    {}
+    {
+        _computeCache();
+    }
 
     /// This constructor creates a quadrilateral with the given vertices.
     ///
@@ -90,7 +99,9 @@ public:
                   UnitVector3d const & v2,
                   UnitVector3d const & v3) :
         _vertices{v0, v1, v2, v3}
-    {}
+    {
+        _computeCache();
+    }
 
     /// Two convex polygons are equal iff they contain the same points.
     bool operator==(ConvexPolygon const & p) const;
@@ -100,6 +111,15 @@ public:
         return _vertices;
     }
 
+    /// `getEdgeNormals` returns the (unnormalized) normals of the planes
+    /// containing the polygon edges. Element i is vᵢ × vᵢ₊₁, where vᵢ is
+    /// vertex i and vertex indexes are taken modulo the vertex count. A point
+    /// p is on the inside of edge i when p · nᵢ > 0; the dot product is
+    /// evaluated exactly as in the first stage of `orientation(p, vᵢ, vᵢ₊₁)`.
+    std::vector<Vector3d> const & getEdgeNormals() const {
+        return _edgeNormals;
+    }
+
     /// The centroid of a polygon is its center of mass projected onto
     /// S², assuming a uniform mass distribution over the polygon surface.
     UnitVector3d getCentroid() const;
@@ -110,11 +130,17 @@ public:
     }
 
     Box getBoundingBox() const override;
-    Box3d getBoundingBox3d() const override;
-    Circle getBoundingCircle() const override;
+    Box3d getBoundingBox3d() const override { return _boundingBox3d; }
+    Circle getBoundingCircle() const override { return _boundingCircle; }
 
     bool contains(UnitVector3d const & v) const override;
 
+    void contains(double const * x,
+                  double const * y,
+                  double const * z,
+                  size_t n,
+                  uint64_t * result) const override;
+
     Relationship relate(Region const & r) const override {
         // Dispatch on the type of r.
         return invert(r.relate(*this));
@@ -140,7 +166,15 @@ private:
 
     ConvexPolygon() : _vertices() {}
 
+    void _computeCache();
+
     std::vector<UnitVector3d> _vertices;
+    // Cached per-edge quantities; see getEdgeNormals(). _robustEdgeNormals
+    // holds vᵢ.robustCross(vᵢ₊₁), which is used by the circle relation code.
+    std::vector<Vector3d> _edgeNormals;
+    std::vector<Vector3d> _robustEdgeNormals;
+    Circle _boundingCircle;
+    Box3d _boundingBox3d;
 };
 
 std::ostream & operator<<(std::ostream &, ConvexPolygon const &);
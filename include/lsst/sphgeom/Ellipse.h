@@ -28,6 +28,7 @@
 ///        regions on the unit sphere.
 
 #include <iosfwd>
+#include <memory>
 
 #include "Circle.h"
 #include "Matrix3d.h"
@@ -266,6 +267,7 @@ public:
                       -_S(2,0), -_S(2,1), -_S(2,2));
         _a = -_a;
         _b = -_b;
+        _approximations.reset();
         return *this;
     }
 
@@ -283,6 +285,12 @@ public:
 
     bool contains(UnitVector3d const &v) const override;
 
+    void contains(double const * x,
+                  double const * y,
+                  double const * z,
+                  size_t n,
+                  uint64_t * result) const override;
+
     Relationship relate(Region const & r) const override {
         // Dispatch on the type of r.
         return invert(r.relate(*this));
@@ -312,6 +320,15 @@ private:
     Angle _gamma; // Half the angle between the ellipse foci
     double _tana; // |tan a| = |cot α|
     double _tanb; // |tan b| = |cot β|
+
+    // `Approximations` holds polygons that contain, and are contained in,
+    // this ellipse. They are computed on first use by relate(), and shared
+    // between copies; see Ellipse.cc.
+    struct Approximations;
+
+    Approximations const & _getApproximations() const;
+
+    mutable std::shared_ptr<Approximations const> _approximations;
 };
 
 std::ostream & operator<<(std::ostream &, Ellipse const &);
@@ -0,0 +1,113 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_SPHGEOM_HTMCURSOR_H_
+#define LSST_SPHGEOM_HTMCURSOR_H_
+
+/// \file
+/// \brief This file declares a class for incremental descent of the
+///        HTM triangle tree.
+
+#include <cstdint>
+
+#include "ConvexPolygon.h"
+#include "HtmPixelization.h"
+#include "UnitVector3d.h"
+
+
+namespace lsst {
+namespace sphgeom {
+
+/// `HtmCursor` computes HTM indexes and triangles like HtmPixelization,
+/// but remembers the path of ancestor triangles from the last call, along
+/// with their edge midpoints. Successive calls only recompute the parts of
+/// the path that differ, so sorted or spatially coherent sequences of
+/// indexes or points are processed much faster than with HtmPixelization.
+///
+/// For `triangle`, the cost of a call is proportional to the number of
+/// levels below the deepest common ancestor of the previous and current
+/// index. For `index`, the edge midpoints (which require vector
+/// normalizations) are only computed for such levels, but the cheap
+/// orientation tests that route a point to a child triangle are repeated
+/// at every level, so that results are always identical to those of
+/// HtmPixelization::index.
+///
+/// A cursor is not thread-safe; use one per thread.
+class HtmCursor {
+public:
+    /// This constructor creates a cursor for computing the indexes of
+    /// points at the given HTM subdivision level. If `level` ∉
+    /// [0, HtmPixelization::MAX_LEVEL], a std::invalid_argument is thrown.
+    explicit HtmCursor(int level);
+
+    /// `getLevel` returns the subdivision level used by `index`.
+    int getLevel() const { return _level; }
+
+    /// `index` returns the index of the HTM triangle at level getLevel()
+    /// containing v. It is equal to `HtmPixelization(getLevel()).index(v)`.
+    uint64_t index(UnitVector3d const & v);
+
+    /// `vertices` stores the vertices of the HTM triangle with index i
+    /// in verts, which must have room for 3 elements. The triangle can
+    /// belong to any level. If i is not a valid HTM index,
+    /// a std::invalid_argument is thrown.
+    void vertices(uint64_t i, UnitVector3d * verts);
+
+    /// `triangle` returns the triangle with index i. It is equal to
+    /// `HtmPixelization::triangle(i)`. If i is not a valid HTM index,
+    /// a std::invalid_argument is thrown.
+    ConvexPolygon triangle(uint64_t i) {
+        UnitVector3d verts[3];
+        vertices(i, verts);
+        return ConvexPolygon(verts[0], verts[1], verts[2]);
+    }
+
+    /// `getNumExpansions` returns the number of times the edge midpoints
+    /// of a triangle have been computed by this cursor. Without a cursor,
+    /// this would happen once per level for every call.
+    uint64_t getNumExpansions() const { return _numExpansions; }
+
+private:
+    struct Node {
+        uint64_t index;
+        bool expanded;
+        UnitVector3d v[3];
+        // The normalized edge midpoints m01, m12 and m20 of the triangle,
+        // valid only if `expanded` is true.
+        UnitVector3d m[3];
+    };
+
+    void _setRoot(uint64_t r);
+    void _expand(Node & n);
+    void _descend(int depth, int child);
+
+    Node _path[HtmPixelization::MAX_LEVEL + 1];
+    // `_depth` is the depth of the last valid node in `_path`, or -1 if
+    // there is none.
+    int _depth;
+    int _level;
+    uint64_t _numExpansions;
+};
+
+}} // namespace lsst::sphgeom
+
+#endif // LSST_SPHGEOM_HTMCURSOR_H_
@@ -31,6 +31,7 @@
 #include <stdexcept>
 
 #include "ConvexPolygon.h"
+#include "PixelCache.h"
 #include "Pixelization.h"
 
 
@@ -40,7 +41,8 @@ namespace sphgeom {
 /// `HtmPixelization` provides [HTM indexing](\ref htm-overview) of points
 /// and regions.
 ///
-/// Instances of this class are immutable and very cheap to copy.
+/// Instances of this class are immutable and very cheap to copy. Copies
+/// share the optional PixelCache passed to the constructor.
 ///
 /// \warning Setting the `maxRanges` argument for envelope() or interior() to
 /// a non-zero value below 6 can result in very poor region pixelizations
@@ -77,20 +79,28 @@ public:
 
     /// This constructor creates an HTM pixelization of the sphere with
     /// the given subdivision level. If `level` ∉ [0, MAX_LEVEL],
-    /// a std::invalid_argument is thrown.
-    explicit HtmPixelization(int level);
+    /// a std::invalid_argument is thrown. If `cache` is not null, pixel
+    /// vertices are looked up in and added to it.
+    explicit HtmPixelization(int level,
+                             std::shared_ptr<PixelCache> cache = nullptr);
 
     /// `getLevel` returns the subdivision level of this pixelization.
     int getLevel() const { return _level; }
 
+    /// `getCache` returns the pixel vertex cache used by this
+    /// pixelization, which may be null.
+    std::shared_ptr<PixelCache> const & getCache() const {
+        return _cache;
+    }
+
     RangeSet universe() const override {
         return RangeSet(static_cast<uint64_t>(8) << 2 * _level,
                         static_cast<uint64_t>(16) << 2 * _level);
     }
 
-    std::unique_ptr<Region> pixel(uint64_t i) const override {
-        return std::unique_ptr<Region>(new ConvexPolygon(triangle(i)));
-    }
+    std::unique_ptr<Region> pixel(uint64_t i) const override;
+
+    using Pixelization::index;
 
     uint64_t index(UnitVector3d const &) const override;
 
@@ -98,9 +108,20 @@ public:
 
 private:
     int _level;
-
-    RangeSet _envelope(Region const &, size_t) const override;
-    RangeSet _interior(Region const &, size_t) const override;
+    std::shared_ptr<PixelCache> _cache;
+
+    void _index(UnitVector3d const *, uint64_t *, size_t) const override;
+    void _index(double const *, double const *, double const *,
+                uint64_t *, size_t) const override;
+    RangeSet _envelope(Region const & r,
+                       size_t maxRanges,
+                       TraversalOptions const & options) const override;
+    RangeSet _interior(Region const & r,
+                       size_t maxRanges,
+                       TraversalOptions const & options) const override;
+    void _streamEnvelope(Region const & r,
+                         std::function<void(uint64_t, uint64_t)> const & sink,
+                         TraversalOptions const & options) const override;
 };
 
 }} // namespace lsst::sphgeom
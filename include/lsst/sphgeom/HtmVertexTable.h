@@ -0,0 +1,115 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_SPHGEOM_HTMVERTEXTABLE_H_
+#define LSST_SPHGEOM_HTMVERTEXTABLE_H_
+
+/// \file
+/// \brief This file declares a table of precomputed HTM triangle edge
+///        midpoints.
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "ConvexPolygon.h"
+#include "UnitVector3d.h"
+
+
+namespace lsst {
+namespace sphgeom {
+
+/// `HtmVertexTable` stores the edge midpoints of all HTM triangles with
+/// subdivision level less than a given depth, and uses them to compute
+/// HTM indexes and triangles.
+///
+/// Computing the index of a point or the vertices of a triangle at level L
+/// involves descending the HTM triangle tree from a root triangle, and
+/// computing up to 3 normalized edge midpoints (each requiring a square
+/// root) per level. With a table of depth k, the midpoints for the first
+/// k levels are looked up instead, so that only L - k levels require
+/// normalizations. Results are identical to those of HtmPixelization.
+///
+/// The table is built on first use, and is immutable afterwards, so that
+/// a single table can be shared by any number of threads. A table of depth
+/// k holds 8(4ᵏ - 1)/3 triangles, and occupies 72 bytes per triangle -
+/// about 12.6 MB for k = 8, or 201 MB for k = 10.
+class HtmVertexTable {
+public:
+    /// `MAX_DEPTH` is the maximum supported table depth.
+    static constexpr int MAX_DEPTH = 10;
+
+    /// This constructor creates a table of the edge midpoints of HTM
+    /// triangles with subdivision level less than `depth`. The table is
+    /// filled in on first use. If `depth` ∉ [0, MAX_DEPTH],
+    /// a std::invalid_argument is thrown.
+    explicit HtmVertexTable(int depth = 8);
+
+    HtmVertexTable(HtmVertexTable const &) = delete;
+    HtmVertexTable & operator=(HtmVertexTable const &) = delete;
+
+    /// `getDepth` returns the number of HTM subdivision levels for which
+    /// edge midpoints are stored.
+    int getDepth() const { return _depth; }
+
+    /// `index` returns the index of the HTM triangle at the given
+    /// subdivision level containing v. It is equal to
+    /// `HtmPixelization(level).index(v)`. If `level` ∉
+    /// [0, HtmPixelization::MAX_LEVEL], a std::invalid_argument is thrown.
+    uint64_t index(UnitVector3d const & v, int level) const;
+
+    /// `vertices` stores the vertices of the HTM triangle with index i in
+    /// verts, which must have room for 3 elements. If i is not a valid HTM
+    /// index, a std::invalid_argument is thrown.
+    void vertices(uint64_t i, UnitVector3d * verts) const;
+
+    /// `triangle` returns the triangle with index i. It is equal to
+    /// `HtmPixelization::triangle(i)`. If i is not a valid HTM index,
+    /// a std::invalid_argument is thrown.
+    ConvexPolygon triangle(uint64_t i) const {
+        UnitVector3d verts[3];
+        vertices(i, verts);
+        return ConvexPolygon(verts[0], verts[1], verts[2]);
+    }
+
+private:
+    // `Midpoints` holds the normalized edge midpoints m01, m12 and m20
+    // of a triangle with vertices v0, v1 and v2.
+    struct Midpoints {
+        UnitVector3d m[3];
+    };
+
+    void _build() const;
+    void _build(int level, UnitVector3d const & v0, UnitVector3d const & v1,
+                UnitVector3d const & v2) const;
+
+    int _depth;
+    mutable std::once_flag _built;
+    // The midpoints are stored in depth-first (pre-)order, so that the
+    // triangles visited by a descent are close together in memory.
+    mutable std::vector<Midpoints> _midpoints;
+};
+
+}} // namespace lsst::sphgeom
+
+#endif // LSST_SPHGEOM_HTMVERTEXTABLE_H_
@@ -31,6 +31,7 @@
 #include <vector>
 
 #include "ConvexPolygon.h"
+#include "PixelCache.h"
 #include "Pixelization.h"
 
 
@@ -40,7 +41,8 @@ namespace sphgeom {
 /// `Mq3cPixelization` provides [modified Q3C indexing](\ref q3c-modified)
 /// of points and regions.
 ///
-/// Instances of this class are immutable and very cheap to copy.
+/// Instances of this class are immutable and very cheap to copy. Copies
+/// share the optional PixelCache passed to the constructor.
 ///
 /// \warning Setting the `maxRanges` argument for envelope() or interior()
 /// to a non-zero value below 4 can result in very poor region pixelizations
@@ -89,12 +91,20 @@ public:
 
     /// This constructor creates a modified Q3C pixelization of the sphere
     /// with the given subdivision level. If `level` ∉ [0, MAX_LEVEL],
-    /// a std::invalid_argument is thrown.
-    explicit Mq3cPixelization(int level);
+    /// a std::invalid_argument is thrown. If `cache` is not null, pixel
+    /// vertices are looked up in and added to it.
+    explicit Mq3cPixelization(int level,
+                              std::shared_ptr<PixelCache> cache = nullptr);
 
     /// `getLevel` returns the subdivision level of this pixelization.
     int getLevel() const { return _level; }
 
+    /// `getCache` returns the pixel vertex cache used by this
+    /// pixelization, which may be null.
+    std::shared_ptr<PixelCache> const & getCache() const {
+        return _cache;
+    }
+
     RangeSet universe() const override {
         return RangeSet(static_cast<uint64_t>(10) << 2 * _level,
                         static_cast<uint64_t>(16) << 2 * _level);
@@ -102,15 +112,33 @@ public:
 
     std::unique_ptr<Region> pixel(uint64_t i) const override;
 
+    using Pixelization::index;
+
     uint64_t index(UnitVector3d const & v) const override;
 
     std::string toString(uint64_t i) const override { return asString(i); }
 
 private:
     int _level;
-
-    RangeSet _envelope(Region const & r, size_t maxRanges) const override;
-    RangeSet _interior(Region const & r, size_t maxRanges) const override;
+    std::shared_ptr<PixelCache> _cache;
+
+    void _index(UnitVector3d const * v,
+                uint64_t * indexes,
+                size_t n) const override;
+    void _index(double const * x,
+                double const * y,
+                double const * z,
+                uint64_t * indexes,
+                size_t n) const override;
+    RangeSet _envelope(Region const & r,
+                       size_t maxRanges,
+                       TraversalOptions const & options) const override;
+    RangeSet _interior(Region const & r,
+                       size_t maxRanges,
+                       TraversalOptions const & options) const override;
+    void _streamEnvelope(Region const & r,
+                         std::function<void(uint64_t, uint64_t)> const & sink,
+                         TraversalOptions const & options) const override;
 };
 
 }} // namespace lsst::sphgeom
@@ -0,0 +1,182 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_SPHGEOM_MULTILEVELRANGESET_H_
+#define LSST_SPHGEOM_MULTILEVELRANGESET_H_
+
+/// \file
+/// \brief This file declares a class for representing sets of pixels
+///        from multiple levels of a hierarchical pixelization.
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#include "RangeSet.h"
+
+
+namespace lsst {
+namespace sphgeom {
+
+/// A `MultiLevelRangeSet` is a set of pixels from a hierarchical
+/// pixelization of the sphere, where each pixel is stored at the coarsest
+/// level at which it is fully covered - that is, in the form of a
+/// multi-order coverage map (MOC).
+///
+/// The pixelization must be one in which the children of the pixel with
+/// index i at some level have indexes 4i, 4i + 1, 4i + 2 and 4i + 3 at the
+/// next level. This is true of the HTM, Q3C and MQ3C pixelizations, so a
+/// multi-level set can be created from (and converted to) the RangeSet
+/// returned by any of their `envelope` or `interior` methods, at any level.
+///
+/// Internally, there is one RangeSet of pixel indexes per level. Each
+/// stored pixel is fully covered, and no 4 stored pixels are the children
+/// of the same parent, so the representation of a given set of pixels is
+/// unique. Set operations between multi-level sets with different maximum
+/// levels are supported, and are exact.
+///
+/// A RangeSet of pixel indexes at a single level has one range for each
+/// run of consecutive indexes, and so is already a compact representation
+/// of a large contiguous footprint. The advantage of the multi-level form
+/// is that the coverage at every level is explicit: coarser pixels can be
+/// processed without scaling or simplifying, and the set can be converted
+/// to a single-level RangeSet at any level.
+class MultiLevelRangeSet {
+public:
+    /// `MAX_LEVEL` is the maximum supported pixelization level.
+    static constexpr int MAX_LEVEL = 30;
+
+    /// This constructor creates an empty set.
+    MultiLevelRangeSet() = default;
+
+    /// This constructor creates a multi-level set containing the pixels
+    /// with the indexes in s at the given level. If `level` ∉ [0, MAX_LEVEL],
+    /// a std::invalid_argument is thrown.
+    MultiLevelRangeSet(RangeSet const & s, int level);
+
+    bool operator==(MultiLevelRangeSet const & s) const {
+        return _levels == s._levels;
+    }
+
+    bool operator!=(MultiLevelRangeSet const & s) const {
+        return _levels != s._levels;
+    }
+
+    /// `empty` returns true if this set contains no pixels.
+    bool empty() const { return _levels.empty(); }
+
+    /// `getMaxLevel` returns the finest level at which a pixel is stored,
+    /// or -1 if this set is empty.
+    int getMaxLevel() const { return static_cast<int>(_levels.size()) - 1; }
+
+    /// `getCells` returns the indexes of the pixels stored at the given
+    /// level, which are the pixels at that level that are fully covered by
+    /// this set, but whose parents are not. If `level` ∉ [0, MAX_LEVEL],
+    /// a std::invalid_argument is thrown.
+    RangeSet const & getCells(int level) const;
+
+    /// `size` returns the total number of ranges in the per-level sets
+    /// of pixel indexes.
+    size_t size() const;
+
+    /// `toRangeSet` returns the set of pixel indexes at the given level
+    /// that intersect this set. If `level` is greater than or equal to
+    /// getMaxLevel(), the conversion is exact. Otherwise, the pixels
+    /// partially covered by this set are included. If `level` ∉
+    /// [0, MAX_LEVEL], a std::invalid_argument is thrown.
+    RangeSet toRangeSet(int level) const;
+
+    /// `contains` returns true if the pixel with the given index and
+    /// level is fully covered by this set.
+    bool contains(uint64_t index, int level) const;
+
+    /// `intersects` returns true if the pixel with the given index and
+    /// level is partially or fully covered by this set.
+    bool intersects(uint64_t index, int level) const;
+
+    ///@{
+    /// `intersects` and `contains` return true if this set intersects
+    /// or contains s.
+    bool intersects(MultiLevelRangeSet const & s) const;
+    bool contains(MultiLevelRangeSet const & s) const;
+    ///@}
+
+    /// \name Set operations
+    ///@{
+    MultiLevelRangeSet intersection(MultiLevelRangeSet const & s) const;
+    MultiLevelRangeSet join(MultiLevelRangeSet const & s) const;
+    MultiLevelRangeSet difference(MultiLevelRangeSet const & s) const;
+    MultiLevelRangeSet symmetricDifference(
+        MultiLevelRangeSet const & s) const;
+
+    MultiLevelRangeSet operator&(MultiLevelRangeSet const & s) const {
+        return intersection(s);
+    }
+
+    MultiLevelRangeSet operator|(MultiLevelRangeSet const & s) const {
+        return join(s);
+    }
+
+    MultiLevelRangeSet operator-(MultiLevelRangeSet const & s) const {
+        return difference(s);
+    }
+
+    MultiLevelRangeSet operator^(MultiLevelRangeSet const & s) const {
+        return symmetricDifference(s);
+    }
+
+    MultiLevelRangeSet & operator&=(MultiLevelRangeSet const & s) {
+        return *this = intersection(s);
+    }
+
+    MultiLevelRangeSet & operator|=(MultiLevelRangeSet const & s) {
+        return *this = join(s);
+    }
+
+    MultiLevelRangeSet & operator-=(MultiLevelRangeSet const & s) {
+        return *this = difference(s);
+    }
+
+    MultiLevelRangeSet & operator^=(MultiLevelRangeSet const & s) {
+        return *this = symmetricDifference(s);
+    }
+    ///@}
+
+    /// `isValid` checks that this set is in a valid state. It is intended
+    /// for use by unit tests.
+    bool isValid() const;
+
+private:
+    // `_flatten` returns the pixels in this set as indexes at the given
+    // level, which must be at least getMaxLevel().
+    RangeSet _flatten(int level) const;
+
+    // `_levels[l]` contains the pixels stored at level l. The last
+    // element is never empty.
+    std::vector<RangeSet> _levels;
+};
+
+std::ostream & operator<<(std::ostream &, MultiLevelRangeSet const &);
+
+}} // namespace lsst::sphgeom
+
+#endif // LSST_SPHGEOM_MULTILEVELRANGESET_H_
@@ -0,0 +1,162 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_SPHGEOM_PIXELCACHE_H_
+#define LSST_SPHGEOM_PIXELCACHE_H_
+
+/// \file
+/// \brief This file declares a bounded, thread-safe cache of pixel vertices.
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "UnitVector3d.h"
+
+
+namespace lsst {
+namespace sphgeom {
+
+/// `PixelCache` is a bounded, thread-safe cache of the vertices of pixels
+/// from the HTM, Q3C and modified-Q3C pixelizations.
+///
+/// Computing the vertices of a pixel requires walking down the pixel tree
+/// from a root pixel, which involves O(L) vector normalizations for a pixel
+/// at subdivision level L. A cache can be passed to the constructors of
+/// HtmPixelization, Q3cPixelization and Mq3cPixelization, after which
+/// their `pixel` methods (and Q3cPixelization::quad) look up vertices in
+/// the cache before computing them. This speeds up workloads that refine
+/// against the same pixels repeatedly. A single cache can be shared by any
+/// number of pixelizations, of any type and level, and threads.
+///
+/// When the cache is full, an entry is evicted using the CLOCK algorithm,
+/// which approximates least-recently-used eviction: every entry has a
+/// reference bit that is set on lookup, and a "clock hand" sweeps over the
+/// entries, clearing reference bits until it finds an entry that has not
+/// been looked up since the last sweep.
+class PixelCache {
+public:
+    /// `Scheme` identifies the pixelization a cached pixel belongs to.
+    enum class Scheme : uint8_t { HTM = 0, Q3C = 1, MQ3C = 2 };
+
+    /// `MAX_VERTICES` is the maximum number of vertices of a cached pixel.
+    static constexpr size_t MAX_VERTICES = 4;
+
+    /// `Statistics` summarizes cache usage.
+    struct Statistics {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t size = 0;
+        size_t capacity = 0;
+    };
+
+    /// This constructor creates an empty cache that can hold the vertices
+    /// of up to `capacity` pixels. If `capacity` is zero,
+    /// a std::invalid_argument is thrown.
+    explicit PixelCache(size_t capacity);
+
+    PixelCache(PixelCache const &) = delete;
+    PixelCache & operator=(PixelCache const &) = delete;
+
+    size_t getCapacity() const { return _entries.size(); }
+
+    /// `find` copies the vertices of the pixel with the given scheme, level
+    /// and index to `vertices`, which must have room for MAX_VERTICES
+    /// elements, and returns the number of vertices. If the pixel is not
+    /// cached, 0 is returned.
+    size_t find(Scheme scheme, int level, uint64_t index,
+                UnitVector3d * vertices);
+
+    /// `insert` caches the `n` vertices of the pixel with the given scheme,
+    /// level and index, evicting another pixel if the cache is full. If `n`
+    /// is 0 or greater than MAX_VERTICES, a std::invalid_argument is thrown.
+    void insert(Scheme scheme, int level, uint64_t index,
+                UnitVector3d const * vertices, size_t n);
+
+    /// `get` copies the vertices of the given pixel to `vertices` and
+    /// returns their number. If the pixel is not cached, its vertices are
+    /// obtained by calling `compute(vertices)`, which must return the
+    /// number of vertices it stored, and are then inserted into the cache.
+    template <typename ComputeFunction>
+    size_t get(Scheme scheme, int level, uint64_t index,
+               UnitVector3d * vertices, ComputeFunction compute)
+    {
+        size_t n = find(scheme, level, index, vertices);
+        if (n == 0) {
+            n = compute(vertices);
+            insert(scheme, level, index, vertices, n);
+        }
+        return n;
+    }
+
+    /// `getStatistics` returns the hit, miss and eviction counts of this
+    /// cache, along with its current size and capacity.
+    Statistics getStatistics() const;
+
+    /// `clear` removes all cached pixels and resets the statistics.
+    void clear();
+
+private:
+    struct Key {
+        uint64_t index;
+        uint32_t tag;
+
+        bool operator==(Key const & k) const {
+            return index == k.index && tag == k.tag;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(Key const & k) const {
+            // Mix the bits of the key with a multiplicative hash, so
+            // that sibling pixels map to unrelated buckets.
+            uint64_t h = (k.index ^ (static_cast<uint64_t>(k.tag) << 56)) *
+                         UINT64_C(0x9e3779b97f4a7c15);
+            return static_cast<size_t>(h ^ (h >> 32));
+        }
+    };
+
+    struct Entry {
+        Key key;
+        uint8_t numVertices = 0;
+        bool referenced = false;
+        UnitVector3d vertices[MAX_VERTICES];
+    };
+
+    static Key _key(Scheme scheme, int level, uint64_t index) {
+        return Key{index, (static_cast<uint32_t>(scheme) << 8) |
+                          static_cast<uint32_t>(level)};
+    }
+
+    mutable std::mutex _mutex;
+    std::vector<Entry> _entries;
+    std::unordered_map<Key, size_t, KeyHash> _slots;
+    size_t _hand = 0;
+    Statistics _stats;
+};
+
+}} // namespace lsst::sphgeom
+
+#endif // LSST_SPHGEOM_PIXELCACHE_H_
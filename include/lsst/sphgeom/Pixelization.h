@@ -26,6 +26,12 @@
 /// \file
 /// \brief This file defines an interface for pixelizations of the sphere.
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
 
 #include "RangeSet.h"
@@ -38,6 +44,53 @@ class Region;
 class UnitVector3d;
 
 
+/// `TraversalStats` reports on a pixel tree traversal performed by
+/// Pixelization::envelope() or Pixelization::interior().
+struct TraversalStats {
+    /// `nodesVisited` is the number of pixels tested against the region.
+    uint64_t nodesVisited = 0;
+
+    /// `truncated` is true if the traversal was stopped early, because of
+    /// a deadline, a cancellation request or an exhausted node budget.
+    bool truncated = false;
+};
+
+/// `TraversalOptions` controls how Pixelization::envelope() and
+/// Pixelization::interior() traverse a hierarchical pixelization.
+///
+/// A traversal can be bounded by a deadline, a cancellation flag and a
+/// budget on the number of pixels tested against the region. When any of
+/// these limits is hit, the traversal stops early and returns a coarser
+/// but still correct answer: envelope() adds all pixels that have not been
+/// tested yet, and so returns a superset of the intersecting pixels, while
+/// interior() leaves them out, and so returns a subset of the interior
+/// pixels. Limits are checked every few hundred pixels, so a deadline or
+/// cancellation request takes effect after a small amount of extra work.
+struct TraversalOptions {
+    /// `numThreads` is the number of threads to use for the traversal. A
+    /// value of 1 (the default) means that the traversal runs entirely on
+    /// the calling thread, and 0 means that the number of threads returned
+    /// by `std::thread::hardware_concurrency()` should be used.
+    unsigned int numThreads = 1;
+
+    /// `deadline` is the time after which the traversal stops early.
+    std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::time_point::max();
+
+    /// If `cancelled` is not null, the traversal stops early once the
+    /// flag it points to is set.
+    std::atomic<bool> const * cancelled = nullptr;
+
+    /// `maxNodes` is the maximum number of pixels to test against the
+    /// region, or 0 for no limit.
+    uint64_t maxNodes = 0;
+
+    /// If `stats` is not null, statistics for the traversal are stored in
+    /// the object it points to.
+    TraversalStats * stats = nullptr;
+};
+
+
 /// A `Pixelization` (or partitioning) of the sphere is a mapping between
 /// points on the sphere and a set of pixels (a.k.a. cells or partitions)
 /// with 64 bit integer labels (indexes), where each point is assigned to
@@ -96,6 +149,30 @@ public:
     /// `index` computes the index of the pixel for v.
     virtual uint64_t index(UnitVector3d const & v) const = 0;
 
+    /// This `index` overload computes the pixel indexes of the `n` unit
+    /// vectors in the array `v`, and stores them in `indexes`, which must
+    /// have room for at least `n` values. The results are identical to those
+    /// obtained by calling `index(v[i])` for each i, but implementations are
+    /// free to amortize per-point overheads over the whole array, e.g. by
+    /// processing several points at once with SIMD instructions.
+    void index(UnitVector3d const * v, uint64_t * indexes, size_t n) const {
+        _index(v, indexes, n);
+    }
+
+    /// This `index` overload computes the pixel indexes of `n` unit vectors
+    /// stored in structure-of-arrays form, where the components of the i-th
+    /// vector are `x[i]`, `y[i]` and `z[i]`. The vectors must be normalized.
+    /// The results are identical to those obtained by calling
+    /// `index(UnitVector3d::fromNormalized(x[i], y[i], z[i]))` for each i.
+    void index(double const * x,
+               double const * y,
+               double const * z,
+               uint64_t * indexes,
+               size_t n) const
+    {
+        _index(x, y, z, indexes, n);
+    }
+
     /// `toString` converts the given pixel index to a human-readable string.
     virtual std::string toString(uint64_t i) const = 0;
 
@@ -129,7 +206,49 @@ public:
     /// too many ranges have been found. Each coarse pixel I at level L - n
     /// corresponds to pixels [I*4ⁿ, (I + 1)*4ⁿ) at level L.
     RangeSet envelope(Region const & r, size_t maxRanges = 0) const {
-        return _envelope(r, maxRanges);
+        return _envelope(r, maxRanges, TraversalOptions());
+    }
+
+    /// This `envelope` overload accepts options that control the traversal.
+    ///
+    /// When `options.numThreads` is greater than 1, subtrees of the pixel
+    /// hierarchy are searched concurrently. If `maxRanges` is 0, the result
+    /// is identical to that of a single-threaded traversal. Otherwise, the
+    /// order in which pixels are found is no longer deterministic, so the
+    /// subdivision level may be lowered at different points than it would be
+    /// by a single-threaded traversal. The result is still guaranteed to be a
+    /// superset of the intersecting pixels containing at most `maxRanges`
+    /// ranges, but may differ from the single-threaded result.
+    RangeSet envelope(Region const & r,
+                      size_t maxRanges,
+                      TraversalOptions const & options) const
+    {
+        return _envelope(r, maxRanges, options);
+    }
+
+    /// `streamEnvelope` computes the indexes of the pixels intersecting the
+    /// spherical region r, and passes them to `sink` as they are found,
+    /// rather than accumulating them in a RangeSet.
+    ///
+    /// `sink` is called once for each maximal range [first, last) of pixel
+    /// indexes, in ascending order, so adjacent ranges are always separated
+    /// by at least one index. As for RangeSet, a value of 0 for `last`
+    /// stands for 2^64. Concatenating the ranges yields exactly the
+    /// contents of `envelope(r)`.
+    ///
+    /// Since ranges are emitted as soon as they are known, a consumer can
+    /// start processing them before the traversal finishes, and memory usage
+    /// does not grow with the size of the result. Because ranges cannot be
+    /// retracted once emitted, there is no equivalent of the envelope()
+    /// `maxRanges` argument, and `options.numThreads` is ignored. The other
+    /// traversal options are obeyed; when the traversal is stopped early, the
+    /// pixels that were not examined are emitted wholesale.
+    void streamEnvelope(
+        Region const & r,
+        std::function<void(uint64_t, uint64_t)> const & sink,
+        TraversalOptions const & options = TraversalOptions()) const
+    {
+        _streamEnvelope(r, sink, options);
     }
 
     /// `interior` returns the indexes of the pixels within the spherical
@@ -141,12 +260,39 @@ public:
     /// maximum. The return value is therefore always a subset of the interior
     /// pixels.
     RangeSet interior(Region const & r, size_t maxRanges = 0) const {
-        return _interior(r, maxRanges);
+        return _interior(r, maxRanges, TraversalOptions());
+    }
+
+    /// This `interior` overload accepts options that control the traversal.
+    /// Multi-threaded traversals return a subset of the interior pixels
+    /// containing at most `maxRanges` ranges; see the corresponding
+    /// envelope() overload for details.
+    RangeSet interior(Region const & r,
+                      size_t maxRanges,
+                      TraversalOptions const & options) const
+    {
+        return _interior(r, maxRanges, options);
     }
 
 private:
-    virtual RangeSet _envelope(Region const & r, size_t maxRanges) const = 0;
-    virtual RangeSet _interior(Region const & r, size_t maxRanges) const = 0;
+    virtual void _index(UnitVector3d const * v,
+                        uint64_t * indexes,
+                        size_t n) const;
+    virtual void _index(double const * x,
+                        double const * y,
+                        double const * z,
+                        uint64_t * indexes,
+                        size_t n) const;
+    virtual RangeSet _envelope(Region const & r,
+                               size_t maxRanges,
+                               TraversalOptions const & options) const = 0;
+    virtual RangeSet _interior(Region const & r,
+                               size_t maxRanges,
+                               TraversalOptions const & options) const = 0;
+    virtual void _streamEnvelope(
+        Region const & r,
+        std::function<void(uint64_t, uint64_t)> const & sink,
+        TraversalOptions const & options) const;
 };
 
 }} // namespace lsst::sphgeom
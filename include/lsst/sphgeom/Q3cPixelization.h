@@ -31,6 +31,7 @@
 #include <vector>
 
 #include "ConvexPolygon.h"
+#include "PixelCache.h"
 #include "Pixelization.h"
 
 
@@ -40,7 +41,8 @@ namespace sphgeom {
 /// `Q3cPixelization` provides [Q3C indexing](\ref q3c-original) of points
 /// and regions.
 ///
-/// Instances of this class are immutable and very cheap to copy.
+/// Instances of this class are immutable and very cheap to copy. Copies
+/// share the optional PixelCache passed to the constructor.
 ///
 /// \warning Setting the `maxRanges` argument for envelope() or interior()
 /// to a non-zero value below 4 can result in very poor region pixelizations
@@ -54,12 +56,20 @@ public:
 
     /// This constructor creates a Q3C pixelization of the sphere with
     /// the given subdivision level. If `level` ∉ [0, MAX_LEVEL],
-    /// a std::invalid_argument is thrown.
-    explicit Q3cPixelization(int level);
+    /// a std::invalid_argument is thrown. If `cache` is not null, pixel
+    /// vertices are looked up in and added to it.
+    explicit Q3cPixelization(int level,
+                             std::shared_ptr<PixelCache> cache = nullptr);
 
     /// `getLevel` returns the subdivision level of this pixelization.
     int getLevel() const { return _level; }
 
+    /// `getCache` returns the pixel vertex cache used by this
+    /// pixelization, which may be null.
+    std::shared_ptr<PixelCache> const & getCache() const {
+        return _cache;
+    }
+
     /// `quad` returns the quadrilateral corresponding to the Q3C pixel with
     /// index `i`.
     ///
@@ -80,6 +90,8 @@ public:
 
     std::unique_ptr<Region> pixel(uint64_t i) const override;
 
+    using Pixelization::index;
+
     uint64_t index(UnitVector3d const & v) const override;
 
     /// `toString` converts the given Q3C index to a human readable string.
@@ -96,9 +108,29 @@ public:
 
 private:
     int _level;
-
-    RangeSet _envelope(Region const & r, size_t maxRanges) const override;
-    RangeSet _interior(Region const & r, size_t maxRanges) const override;
+    std::shared_ptr<PixelCache> _cache;
+
+    // `_makeQuad` computes the vertices of the pixel with index i, or
+    // looks them up in the pixel cache.
+    void _makeQuad(uint64_t i, UnitVector3d * verts) const;
+
+    void _index(UnitVector3d const * v,
+                uint64_t * indexes,
+                size_t n) const override;
+    void _index(double const * x,
+                double const * y,
+                double const * z,
+                uint64_t * indexes,
+                size_t n) const override;
+    RangeSet _envelope(Region const & r,
+                       size_t maxRanges,
+                       TraversalOptions const & options) const override;
+    RangeSet _interior(Region const & r,
+                       size_t maxRanges,
+                       TraversalOptions const & options) const override;
+    void _streamEnvelope(Region const & r,
+                         std::function<void(uint64_t, uint64_t)> const & sink,
+                         TraversalOptions const & options) const override;
 };
 
 }} // namespace lsst::sphgeom
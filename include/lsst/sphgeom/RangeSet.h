@@ -27,6 +27,7 @@
 /// \brief This file provides a type for representing integer sets.
 
 #include <cstddef>
+#include <algorithm>
 #include <cstdint>
 #include <initializer_list>
 #include <iosfwd>
@@ -56,11 +57,11 @@ namespace sphgeom {
 /// > http://www.aanda.org/articles/aa/abs/2015/08/aa26549-15/aa26549-15.html
 ///
 /// The beginning and end points of the disjoint, non-empty, half-open integer
-/// ranges in the set are stored in a std::vector<uint64_t>, with monotonically
-/// increasing values, except for the last one. Each pair of consecutive
-/// elements [begin, end) in the vector is a non-empty half-open range, where
-/// the value of end is defined as the integer obtained by adding one to the
-/// largest element in the range.
+/// ranges in the set are stored in a vector of uint64_t values, with
+/// monotonically increasing values, except for the last one. Each pair of
+/// consecutive elements [begin, end) in the vector is a non-empty half-open
+/// range, where the value of end is defined as the integer obtained by adding
+/// one to the largest element in the range.
 ///
 /// Mathematically, a half-open range with largest element equal to 2^64 - 1
 /// would have an end point of 2^64. But arithmetic for unsigned 64 bit
@@ -69,6 +70,10 @@ namespace sphgeom {
 /// of 0. Note that overflow is undefined for signed integers, which motivates
 /// the use of unsigned 64 bit integers for this class.
 ///
+/// The vector stores a small number of values (enough for 3 ranges) inline,
+/// so that sets with few ranges - e.g. the pixels intersecting a small
+/// region - can be created and copied without any heap allocation.
+///
 /// The first and last values of the internal vector are are always 0, even if
 /// no range in the set has a beginning or end point of 0. To illustrate why,
 /// consider the contents of the vector for a set containing a single
@@ -98,6 +103,8 @@ namespace sphgeom {
 /// invalidate all iterators.
 class RangeSet {
 public:
+    /// `TYPE_CODE` is the first byte of the binary encoding of a RangeSet.
+    static constexpr uint8_t TYPE_CODE = 'r';
 
     /// A constant iterator over the ranges (represented as 2-tuples) in a
     /// RangeSet.
@@ -219,7 +226,9 @@ public:
     ///@}
 
     /// This generic constructor creates a set containing the integers or
-    /// ranges obtained by dereferencing the iterators in [a, b).
+    /// ranges obtained by dereferencing the iterators in [a, b). Integers
+    /// are inserted one at a time, so fromValues should be preferred for
+    /// creating sets from large numbers of unsorted integers.
     ///
     /// It is hidden via SFINAE if InputIterator is not a standard
     /// input iterator.
@@ -320,6 +329,30 @@ public:
     void erase(uint64_t first, uint64_t last);
     ///@}
 
+    ///@{
+    /// `fromValues` returns the set of the n given integers, which may be
+    /// in any order, and may contain duplicates.
+    ///
+    /// Unsorted values are radix sorted, using up to `numThreads` threads
+    /// for large inputs (0 means that the number of threads returned by
+    /// `std::thread::hardware_concurrency()` should be used). Runs of
+    /// consecutive integers are then coalesced into ranges, and the result
+    /// is created with a single allocation. This takes O(n) time, whereas
+    /// inserting the values one at a time can take O(n²) time.
+    ///
+    /// Temporary storage for 2n integers is required, unless the values
+    /// are already sorted.
+    static RangeSet fromValues(uint64_t const * values,
+                               size_t n,
+                               unsigned int numThreads = 1);
+
+    static RangeSet fromValues(std::vector<uint64_t> const & values,
+                               unsigned int numThreads = 1)
+    {
+        return fromValues(values.data(), values.size(), numThreads);
+    }
+    ///@}
+
     /// \name Set operations
     ///@{
 
@@ -347,6 +380,60 @@ public:
     /// this set and s.
     RangeSet symmetricDifference(RangeSet const & s) const;
 
+    ///@{
+    /// These overloads store the result of a set operation in `out`, which
+    /// may be this set or s. They reuse the memory already allocated by
+    /// `out`, which only grows when it cannot hold the range end points of
+    /// both inputs. A loop performing many set operations with the same
+    /// output set therefore stops allocating after the first few.
+    void intersection(RangeSet const & s, RangeSet & out) const;
+    void join(RangeSet const & s, RangeSet & out) const;
+    void difference(RangeSet const & s, RangeSet & out) const;
+    void symmetricDifference(RangeSet const & s, RangeSet & out) const;
+    ///@}
+
+    ///@{
+    /// `coveredByAtLeast` returns the set of integers contained in at least
+    /// m of the n given sets. All input sets are merged in a single pass
+    /// over their ranges, using a heap of size n, so computing the union or
+    /// intersection of n sets with a total of k ranges takes O(k log n)
+    /// time, rather than the O(k n) required by pairwise folding. The
+    /// result is allocated once.
+    static RangeSet coveredByAtLeast(RangeSet const * sets,
+                                     size_t n,
+                                     size_t m);
+
+    static RangeSet coveredByAtLeast(std::vector<RangeSet> const & sets,
+                                     size_t m)
+    {
+        return coveredByAtLeast(sets.data(), sets.size(), m);
+    }
+    ///@}
+
+    ///@{
+    /// `joinAll` returns the union of the n given sets, which is empty
+    /// if n is 0.
+    static RangeSet joinAll(RangeSet const * sets, size_t n) {
+        return coveredByAtLeast(sets, n, 1);
+    }
+
+    static RangeSet joinAll(std::vector<RangeSet> const & sets) {
+        return coveredByAtLeast(sets.data(), sets.size(), 1);
+    }
+    ///@}
+
+    ///@{
+    /// `intersectAll` returns the intersection of the n given sets, which
+    /// is the universe [0, 2^64) if n is 0.
+    static RangeSet intersectAll(RangeSet const * sets, size_t n) {
+        return coveredByAtLeast(sets, n, n);
+    }
+
+    static RangeSet intersectAll(std::vector<RangeSet> const & sets) {
+        return coveredByAtLeast(sets.data(), sets.size(), sets.size());
+    }
+    ///@}
+
     /// The ~ operator returns the complement of this set.
     RangeSet operator~() const {
         RangeSet s(*this);
@@ -378,8 +465,7 @@ public:
     /// It is strongly exception safe.
     RangeSet & operator&=(RangeSet const & s) {
         if (this != &s) {
-            RangeSet r = intersection(s);
-            swap(r);
+            _merge(*this, s, AND);
         }
         return *this;
     }
@@ -388,8 +474,7 @@ public:
     /// It is strongly exception safe.
     RangeSet & operator|=(RangeSet const & s) {
         if (this != &s) {
-            RangeSet r = join(s);
-            swap(r);
+            _merge(*this, s, OR);
         }
         return *this;
     }
@@ -398,8 +483,7 @@ public:
     /// to this set. It is strongly exception safe.
     RangeSet & operator-=(RangeSet const & s) {
         if (this != &s) {
-            RangeSet r = difference(s);
-            swap(r);
+            _merge(*this, s, AND_NOT);
         } else {
             clear();
         }
@@ -410,8 +494,7 @@ public:
     /// and s to this set. It is strongly exception safe.
     RangeSet & operator^=(RangeSet const & s) {
         if (this != &s) {
-            RangeSet r = symmetricDifference(s);
-            swap(r);
+            _merge(*this, s, XOR);
         } else {
             clear();
         }
@@ -439,6 +522,25 @@ public:
     bool contains(RangeSet const & s) const;
     ///@}
 
+    /// This `contains` overload tests whether each of the `n` integers in
+    /// `values` is in this set. The results are packed into `result`, which
+    /// must have room for at least ⌈n/64⌉ values: bit `i % 64` of
+    /// `result[i / 64]` is set if and only if `contains(values[i])` is true.
+    /// Unused bits of the last result value are cleared.
+    ///
+    /// The values may be in any order. Several values are searched for
+    /// at once, using branch-free binary searches that proceed in lockstep,
+    /// so that the memory accesses of independent searches overlap.
+    void contains(uint64_t const * values, size_t n, uint64_t * result) const;
+
+    /// `containsSorted` is equivalent to the batch `contains` overload,
+    /// but requires the values to be sorted in ascending order, and uses
+    /// a galloping merge that is faster when they are. A
+    /// std::invalid_argument is thrown if the values are not sorted.
+    void containsSorted(uint64_t const * values,
+                        size_t n,
+                        uint64_t * result) const;
+
     ///@{
     /// `isWithin` returns true iff every integer in this set is also one of
     /// the given integers.
@@ -550,6 +652,43 @@ public:
         swap(_offset, s._offset);
     }
 
+    /// `encode` serializes this set into a compact byte string, which can be
+    /// deserialized with decode, or queried in place with a RangeSetView.
+    ///
+    /// The encoding stores the sorted, distinct beginning and end points of
+    /// the ranges in the set (excluding 0 and 2^64), as the differences
+    /// between consecutive points. These are small for sets of nearby
+    /// pixels, and are stored as variable length integers, so that most
+    /// take only one or two bytes. Additionally, every `BLOCK_SIZE`-th
+    /// point and its offset in the byte string are stored with full
+    /// precision, allowing random access without decoding the entire set.
+    ///
+    /// The byte string consists of:
+    ///
+    /// - a byte equal to TYPE_CODE
+    /// - a byte that is 1 if the set contains 0, and 0 otherwise
+    /// - the number of points m, as a variable length integer
+    /// - ⌈m / BLOCK_SIZE⌉ - 1 index entries. Entry j - 1 contains point
+    ///   j·BLOCK_SIZE - 1 (counting from 0), followed by the offset of the
+    ///   encoding of point j·BLOCK_SIZE relative to the first byte after
+    ///   the index. Both are 8 byte little-endian unsigned integers.
+    /// - the m points. Point i is encoded as the difference between it and
+    ///   point i - 1 (or 0 if i = 0), minus 1, as a variable length integer.
+    ///
+    /// Variable length integers are encoded with encodeVarint.
+    std::vector<uint8_t> encode() const;
+
+    ///@{
+    /// `decode` deserializes a RangeSet from a byte string produced by encode.
+    /// A std::runtime_error is thrown if the byte string is not a valid
+    /// RangeSet encoding.
+    static RangeSet decode(std::vector<uint8_t> const & s) {
+        return decode(s.data(), s.size());
+    }
+
+    static RangeSet decode(uint8_t const * buffer, size_t n);
+    ///@}
+
     /// `isValid` checks that this RangeSet is in a valid state.
     ///
     /// It is intended for use by unit tests, but calling it in other contexts
@@ -558,7 +697,174 @@ public:
     bool isValid() const;
 
 private:
-    std::vector<uint64_t> _ranges = {0, 0};
+    friend class RangeSetView;
+
+    // `BLOCK_SIZE` is the number of range end points between index
+    // entries in the binary encoding of a RangeSet.
+    static constexpr size_t BLOCK_SIZE = 64;
+
+    // `Storage` is a minimal vector of uint64_t values. It holds up to
+    // INLINE_CAPACITY values in an array embedded in the RangeSet itself,
+    // and only allocates memory on the heap when more values are stored.
+    // A set with up to 3 ranges therefore never touches the allocator,
+    // which makes the many small sets produced by pixelizing small regions
+    // cheap to create, copy and destroy.
+    class Storage {
+    public:
+        static constexpr size_t INLINE_CAPACITY = 8;
+
+        Storage() :
+            _begin{_inline}, _end{_inline}, _capEnd{_inline + INLINE_CAPACITY}
+        {}
+
+        Storage(std::initializer_list<uint64_t> list) : Storage() {
+            assign(list.begin(), list.end());
+        }
+
+        Storage(Storage const & s) : Storage() { assign(s.begin(), s.end()); }
+
+        Storage(Storage && s) noexcept : Storage() { _steal(s); }
+
+        ~Storage() { _release(); }
+
+        Storage & operator=(Storage const & s) {
+            if (this != &s) {
+                assign(s.begin(), s.end());
+            }
+            return *this;
+        }
+
+        Storage & operator=(Storage && s) noexcept {
+            if (this != &s) {
+                _release();
+                _steal(s);
+            }
+            return *this;
+        }
+
+        Storage & operator=(std::initializer_list<uint64_t> list) {
+            assign(list.begin(), list.end());
+            return *this;
+        }
+
+        bool operator==(Storage const & s) const {
+            return size() == s.size() && std::equal(begin(), end(), s.begin());
+        }
+
+        bool operator!=(Storage const & s) const { return !(*this == s); }
+
+        uint64_t * data() { return _begin; }
+        uint64_t const * data() const { return _begin; }
+        uint64_t * begin() { return _begin; }
+        uint64_t const * begin() const { return _begin; }
+        uint64_t * end() { return _end; }
+        uint64_t const * end() const { return _end; }
+        uint64_t front() const { return _begin[0]; }
+        uint64_t back() const { return _end[-1]; }
+
+        size_t size() const { return static_cast<size_t>(_end - _begin); }
+
+        size_t capacity() const {
+            return static_cast<size_t>(_capEnd - _begin);
+        }
+
+        size_t max_size() const {
+            return static_cast<size_t>(PTRDIFF_MAX) / sizeof(uint64_t);
+        }
+
+        // `reserve` ensures that at least n values can be stored without
+        // further allocation. Only members that grow the storage can throw,
+        // and they leave it unchanged when they do.
+        void reserve(size_t n) {
+            if (n > capacity()) {
+                _grow(n);
+            }
+        }
+
+        void assign(uint64_t const * first, uint64_t const * last) {
+            reserve(static_cast<size_t>(last - first));
+            _end = std::copy(first, last, _begin);
+        }
+
+        void push_back(uint64_t u) {
+            if (_end != _capEnd) {
+                *_end++ = u;
+            } else {
+                _growAndAppend(u);
+            }
+        }
+
+        void pop_back() { --_end; }
+
+        // `resize` changes the number of stored values to n. Unlike
+        // std::vector::resize, new values are left uninitialized.
+        void resize(size_t n) {
+            reserve(n);
+            _end = _begin + n;
+        }
+
+        uint64_t * insert(uint64_t * pos,
+                          uint64_t const * first,
+                          uint64_t const * last);
+
+        uint64_t * insert(uint64_t * pos, uint64_t u) {
+            return insert(pos, &u, &u + 1);
+        }
+
+        uint64_t * insert(uint64_t * pos,
+                          std::initializer_list<uint64_t> list)
+        {
+            return insert(pos, list.begin(), list.end());
+        }
+
+        uint64_t * erase(uint64_t * first, uint64_t * last) {
+            _end = std::copy(last, _end, first);
+            return first;
+        }
+
+        void swap(Storage & s) noexcept {
+            Storage t(std::move(s));
+            s = std::move(*this);
+            *this = std::move(t);
+        }
+
+    private:
+        void _grow(size_t n);
+        void _growAndAppend(uint64_t u);
+
+        void _release() {
+            if (_begin != _inline) {
+                delete [] _begin;
+            }
+        }
+
+        // `_steal` moves the contents of s to this storage, which must not
+        // own heap memory, and leaves s empty.
+        void _steal(Storage & s) {
+            if (s._begin == s._inline) {
+                _begin = _inline;
+                _end = std::copy(s._begin, s._end, _inline);
+                _capEnd = _inline + INLINE_CAPACITY;
+            } else {
+                _begin = s._begin;
+                _end = s._end;
+                _capEnd = s._capEnd;
+                s._begin = s._inline;
+                s._capEnd = s._inline + INLINE_CAPACITY;
+            }
+            s._end = s._begin;
+        }
+
+        // Pointers (rather than a size and capacity) delimit the values, so
+        // that stores to values cannot alias them. This lets compilers keep
+        // them in registers while appending.
+        uint64_t * _begin;
+        uint64_t * _end;
+        uint64_t * _capEnd;
+        uint64_t _inline[INLINE_CAPACITY];
+    };
+
+    Storage _ranges = {0, 0};
 
     // The offset of the first range in _ranges. It is 0 (false) if the
     // first integer in the set is 0, and 1 (true) otherwise.
@@ -586,11 +892,23 @@ private:
 
     void _insert(uint64_t first, uint64_t last);
 
-    static void _intersectOne(std::vector<uint64_t> &,
+    // Truth tables for the binary set operations supported by _merge. Bit
+    // 2a + b is the output state for input states a and b.
+    static constexpr unsigned AND = 0x8;
+    static constexpr unsigned OR = 0xe;
+    static constexpr unsigned AND_NOT = 0x4;
+    static constexpr unsigned NOT_AND = 0x2;
+    static constexpr unsigned XOR = 0x6;
+
+    // `_merge` replaces this set with the result of a binary set operation
+    // between a and b. This set may be a, but must not be b.
+    void _merge(RangeSet const & a, RangeSet const & b, unsigned op);
+
+    static void _intersectOne(Storage &,
                               uint64_t const *,
                               uint64_t const *, uint64_t const *);
 
-    static void _intersect(std::vector<uint64_t> &,
+    static void _intersect(Storage &,
                            uint64_t const *, uint64_t const *,
                            uint64_t const *, uint64_t const *);
 
@@ -0,0 +1,131 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_SPHGEOM_RANGESETVIEW_H_
+#define LSST_SPHGEOM_RANGESETVIEW_H_
+
+/// \file
+/// \brief This file provides a read-only view of an encoded RangeSet.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "RangeSet.h"
+
+
+namespace lsst {
+namespace sphgeom {
+
+/// A `RangeSetView` is a read-only view of a RangeSet encoded as a byte
+/// string by RangeSet::encode. It answers queries directly from the
+/// encoded bytes, which may e.g. belong to a memory-mapped file or a
+/// message buffer, without decoding them into a RangeSet first.
+///
+/// Point and range queries use the index embedded in the encoding to
+/// skip to the relevant part of the byte string, and then decode at most
+/// a few dozen range end points. Queries involving another set sweep
+/// through the end points of both in ascending order, skipping over
+/// stretches of either set that cannot affect the result.
+///
+/// A view does not own its byte string, which must outlive it. The
+/// constructor checks the header of the encoding, but the remaining bytes
+/// are validated as they are decoded, so any method may throw a
+/// std::runtime_error if the byte string is not a valid RangeSet encoding.
+class RangeSetView {
+public:
+    /// This constructor creates a view of the RangeSet encoded in
+    /// the `n` bytes starting at `buffer`.
+    RangeSetView(uint8_t const * buffer, size_t n);
+
+    /// This constructor creates a view of the RangeSet encoded in `s`.
+    explicit RangeSetView(std::vector<uint8_t> const & s) :
+        RangeSetView(s.data(), s.size()) {}
+
+    /// `empty` checks whether there are any integers in the viewed set.
+    bool empty() const { return _numPoints == 0 && !_containsZero; }
+
+    /// `full` checks whether all integers in the universe of range sets,
+    /// [0, 2^64), are in the viewed set.
+    bool full() const { return _numPoints == 0 && _containsZero; }
+
+    /// `size` returns the number of ranges in the viewed set.
+    size_t size() const {
+        return static_cast<size_t>((_numPoints + 1 + _containsZero) / 2);
+    }
+
+    ///@{
+    /// `intersects` returns true iff the intersection of the viewed set
+    /// and the given integers is non-empty.
+    bool intersects(uint64_t u) const { return contains(u); }
+
+    bool intersects(uint64_t first, uint64_t last) const {
+        return intersects(RangeSet(first, last));
+    }
+
+    bool intersects(RangeSet const & s) const;
+
+    bool intersects(RangeSetView const & s) const;
+    ///@}
+
+    ///@{
+    /// `contains` returns true iff every one of the given integers is in
+    /// the viewed set.
+    bool contains(uint64_t u) const;
+
+    bool contains(uint64_t first, uint64_t last) const {
+        return contains(RangeSet(first, last));
+    }
+
+    bool contains(RangeSet const & s) const;
+
+    bool contains(RangeSetView const & s) const;
+    ///@}
+
+    ///@{
+    /// `intersection` returns the intersection of the viewed set and s.
+    RangeSet intersection(RangeSet const & s) const;
+
+    RangeSet intersection(RangeSetView const & s) const;
+    ///@}
+
+    /// `decode` returns the viewed set.
+    RangeSet decode() const;
+
+private:
+    class Stream;
+
+    // `_findBlock` returns the index of the last block of range end
+    // points with a preceding end point less than or equal to u.
+    size_t _findBlock(uint64_t u) const;
+
+    uint8_t const * _index;
+    uint8_t const * _points;
+    uint8_t const * _end;
+    uint64_t _numPoints;
+    size_t _numBlocks;
+    bool _containsZero;
+};
+
+}} // namespace lsst::sphgeom
+
+#endif // LSST_SPHGEOM_RANGESETVIEW_H_
@@ -26,6 +26,8 @@
 /// \file
 /// \brief This file defines an interface for spherical regions.
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -95,6 +97,24 @@ public:
     /// `contains` tests whether the given unit vector is inside this region.
     virtual bool contains(UnitVector3d const &) const = 0;
 
+    /// This `contains` overload tests whether each of the `n` unit vectors
+    /// with components `x[i]`, `y[i]` and `z[i]` is inside this region. The
+    /// vectors must be normalized. The results are packed into `result`,
+    /// which must have room for at least ⌈n/64⌉ values: bit `i % 64` of
+    /// `result[i / 64]` is set if and only if
+    /// `contains(UnitVector3d::fromNormalized(x[i], y[i], z[i]))` is true.
+    /// Unused bits of the last result value are cleared.
+    ///
+    /// Subclasses override this to avoid per-point virtual function calls,
+    /// and where possible to test several points at once using SIMD
+    /// instructions. Their results are always identical to those of the
+    /// single-point test.
+    virtual void contains(double const * x,
+                          double const * y,
+                          double const * z,
+                          size_t n,
+                          uint64_t * result) const;
+
     ///@{
     /// `relate` computes the spatial relationships between this region A and
     /// another region B. The return value S is a bitset with the following
@@ -27,6 +27,7 @@
 /// \brief This file contains simple helper functions for encoding and
 ///        decoding primitive types to/from byte strings.
 
+#include <cstdint>
 #include <vector>
 
 
@@ -74,6 +75,62 @@ inline double decodeDouble(uint8_t const * buffer) {
 #endif
 }
 
+/// `encodeU64` appends an unsigned 64 bit integer in little-endian byte order
+/// to the end of buffer.
+inline void encodeU64(uint64_t item, std::vector<uint8_t> & buffer) {
+    for (int i = 0; i < 64; i += 8) {
+        buffer.push_back(static_cast<uint8_t>(item >> i));
+    }
+}
+
+/// `decodeU64` extracts an unsigned 64 bit integer from the 8 byte
+/// little-endian byte sequence in buffer.
+inline uint64_t decodeU64(uint8_t const * buffer) {
+    uint64_t u = 0;
+    for (int i = 0; i < 8; ++i) {
+        u |= static_cast<uint64_t>(buffer[i]) << (8 * i);
+    }
+    return u;
+}
+
+/// `encodeVarint` appends an unsigned 64 bit integer to the end of buffer
+/// as a variable length (LEB128) byte sequence. Each byte stores 7 bits of
+/// the integer, least significant bits first, and has its most significant
+/// bit set if more bytes follow. Integers less than 128 are encoded as a
+/// single byte, and no integer requires more than 10.
+inline void encodeVarint(uint64_t item, std::vector<uint8_t> & buffer) {
+    while (item >= 0x80) {
+        buffer.push_back(static_cast<uint8_t>(item) | 0x80);
+        item >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(item));
+}
+
+/// `decodeVarint` extracts a variable length integer written by
+/// encodeVarint from the bytes in [buffer, end), and advances buffer past
+/// it. It returns false, leaving buffer and item unchanged, if the byte
+/// sequence is truncated or does not encode a 64 bit integer.
+inline bool decodeVarint(uint8_t const * & buffer,
+                         uint8_t const * end,
+                         uint64_t & item)
+{
+    uint64_t u = 0;
+    uint8_t const * p = buffer;
+    for (int shift = 0; p != end && shift < 64; shift += 7) {
+        uint8_t b = *p++;
+        u |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if ((b & 0x80) == 0) {
+            if (shift == 63 && b > 1) {
+                return false;
+            }
+            buffer = p;
+            item = u;
+            return true;
+        }
+    }
+    return false;
+}
+
 }} // namespace lsst::sphgeom
 
 #endif // LSST_SPHGEOM_CODEC_H_
\ No newline at end of file
@@ -52,13 +52,46 @@ int orientationExact(Vector3d const & a,
 /// a · (b x c), which is the sign of the determinant of the 3x3 matrix with
 /// a, b and c as columns/rows.
 ///
-/// The implementation proceeds by first computing a double precision
-/// approximation, and then falling back to arbitrary precision arithmetic
-/// when necessary. Consequently, the result is exact.
+/// The implementation proceeds in stages of increasing cost. It first
+/// computes a double precision approximation, then (when the sign of the
+/// approximation is uncertain) an approximation from exactly computed
+/// components of b x c, and then the exact determinant as a floating point
+/// expansion. Arbitrary precision arithmetic is only used for inputs with
+/// components small enough to cause floating point underflow. Consequently,
+/// the result is exact.
 int orientation(UnitVector3d const & a,
                 UnitVector3d const & b,
                 UnitVector3d const & c);
 
+/// `OrientationCounts` records how many calls to `orientation` were resolved
+/// by each of its stages, in order of increasing cost.
+struct OrientationCounts {
+    /// Calls resolved by a fixed error bound on the determinant.
+    uint64_t fixedBound = 0;
+    /// Calls resolved by an error bound proportional to the permanent.
+    uint64_t permanentBound = 0;
+    /// Calls with identical or antipodal inputs.
+    uint64_t degenerate = 0;
+    /// Calls resolved using exactly computed cross product components.
+    uint64_t exactMinors = 0;
+    /// Calls resolved by computing the determinant as an expansion.
+    uint64_t expansion = 0;
+    /// Calls resolved using arbitrary precision arithmetic.
+    uint64_t arbitraryPrecision = 0;
+};
+
+/// `setOrientationCounting` turns counting of `orientation` calls on or off.
+/// Counting is off by default, and adds a small amount of overhead to every
+/// call when on.
+void setOrientationCounting(bool enabled);
+
+/// `getOrientationCounts` returns the number of `orientation` calls resolved
+/// by each stage, since the last reset and while counting was on.
+OrientationCounts getOrientationCounts();
+
+/// `resetOrientationCounts` sets all `orientation` stage counts to zero.
+void resetOrientationCounts();
+
 /// `orientationX(b, c)` is equivalent to `orientation(UnitVector3d::X(), b, c)`.
 int orientationX(UnitVector3d const & b, UnitVector3d const & c);
 
@@ -35,14 +35,18 @@ from .circle import *
 from .convexPolygon import *
 from .curve import *
 from .ellipse import *
+from .htmCursor import *
 from .htmPixelization import *
+from .htmVertexTable import *
 from .interval1d import *
 from .lonLat import *
 from .matrix3d import *
 from .mq3cPixelization import *
+from .multiLevelRangeSet import *
 from .normalizedAngle import *
 from .normalizedAngleInterval import *
 from .orientation import *
+from .pixelCache import *
 from .q3cPixelization import *
 from .rangeSet import *
 from .relationship import *
@@ -34,18 +34,36 @@ namespace sphgeom {
 namespace {
 
 py::str toString(Chunker const & self) {
-    return py::str("Chunker({!s}, {!s})")
-            .format(self.getNumStripes(), self.getNumSubStripesPerStripe());
+    if (self.getOverlap() == Angle(0.0)) {
+        return py::str("Chunker({!s}, {!s})")
+                .format(self.getNumStripes(),
+                        self.getNumSubStripesPerStripe());
+    }
+    return py::str("Chunker({!s}, {!s}, {!r})")
+            .format(self.getNumStripes(), self.getNumSubStripesPerStripe(),
+                    self.getOverlap());
+}
+
+py::list toList(std::vector<ChunkLocation> const & locations) {
+    py::list results;
+    for (ChunkLocation const & loc: locations) {
+        results.append(py::make_tuple(loc.chunkId, loc.subChunkId));
+    }
+    return results;
 }
 
 
 PYBIND11_PLUGIN(chunker) {
     py::module mod("chunker");
+    py::module::import("lsst.sphgeom.angle");
+    py::module::import("lsst.sphgeom.lonLat");
+    py::module::import("lsst.sphgeom.rangeSet");
+    py::module::import("lsst.sphgeom.unitVector3d");
 
     py::class_<Chunker, std::shared_ptr<Chunker>> cls(mod, "Chunker");
 
-    cls.def(py::init<int32_t, int32_t>(), "numStripes"_a,
-            "numSubStripesPerStripe"_a);
+    cls.def(py::init<int32_t, int32_t, Angle>(), "numStripes"_a,
+            "numSubStripesPerStripe"_a, "overlap"_a = Angle(0.0));
 
     cls.def("__eq__", &Chunker::operator==, py::is_operator());
     cls.def("__ne__", &Chunker::operator!=, py::is_operator());
@@ -53,6 +71,7 @@ PYBIND11_PLUGIN(chunker) {
     cls.def_property_readonly("numStripes", &Chunker::getNumStripes);
     cls.def_property_readonly("numSubStripesPerStripe",
                               &Chunker::getNumSubStripesPerStripe);
+    cls.def_property_readonly("overlap", &Chunker::getOverlap);
 
     cls.def("getChunksIntersecting", &Chunker::getChunksIntersecting,
             "region"_a);
@@ -65,6 +84,58 @@ PYBIND11_PLUGIN(chunker) {
                 return results;
             },
             "region"_a);
+    cls.def("getSubChunkRangesIntersecting",
+            [](Chunker const &self, Region const &region) {
+                py::list results;
+                for (auto const & sc:
+                     self.getSubChunkRangesIntersecting(region)) {
+                    results.append(py::make_tuple(sc.chunkId, sc.ranges));
+                }
+                return results;
+            },
+            "region"_a);
+    cls.def("getChunkSetIntersecting", &Chunker::getChunkSetIntersecting,
+            "region"_a);
+    cls.def("getSubChunkSetIntersecting",
+            &Chunker::getSubChunkSetIntersecting, "region"_a);
+    cls.def("getGlobalSubChunkId", &Chunker::getGlobalSubChunkId,
+            "chunkId"_a, "subChunkId"_a);
+    cls.def("getChunkLocation",
+            [](Chunker const &self, uint64_t globalSubChunkId) {
+                ChunkLocation loc = self.getChunkLocation(globalSubChunkId);
+                return py::make_tuple(loc.chunkId, loc.subChunkId);
+            },
+            "globalSubChunkId"_a);
+    cls.def("locate",
+            [](Chunker const &self, LonLat const &p) {
+                ChunkLocation loc = self.locate(p);
+                return py::make_tuple(loc.chunkId, loc.subChunkId);
+            },
+            "p"_a);
+    cls.def("locate",
+            [](Chunker const &self, UnitVector3d const &v) {
+                ChunkLocation loc = self.locate(v);
+                return py::make_tuple(loc.chunkId, loc.subChunkId);
+            },
+            "v"_a);
+    cls.def("getOverlapChunks",
+            (std::vector<int32_t>(Chunker::*)(LonLat const &) const) &
+                    Chunker::getOverlapChunks,
+            "p"_a);
+    cls.def("getOverlapChunks",
+            (std::vector<int32_t>(Chunker::*)(UnitVector3d const &) const) &
+                    Chunker::getOverlapChunks,
+            "v"_a);
+    cls.def("getOverlapSubChunks",
+            [](Chunker const &self, LonLat const &p) {
+                return toList(self.getOverlapSubChunks(p));
+            },
+            "p"_a);
+    cls.def("getOverlapSubChunks",
+            [](Chunker const &self, UnitVector3d const &v) {
+                return toList(self.getOverlapSubChunks(v));
+            },
+            "v"_a);
     cls.def("getAllChunks", &Chunker::getAllChunks);
     cls.def("getAllSubChunks", &Chunker::getAllSubChunks, "chunkId"_a);
 
@@ -74,7 +145,8 @@ PYBIND11_PLUGIN(chunker) {
     cls.def("__reduce__", [cls](Chunker const &self) {
         return py::make_tuple(cls,
                               py::make_tuple(self.getNumStripes(),
-                                             self.getNumSubStripesPerStripe()));
+                                             self.getNumSubStripesPerStripe(),
+                                             self.getOverlap()));
     });
 
     return mod.ptr();
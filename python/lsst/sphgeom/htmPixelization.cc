@@ -32,6 +32,7 @@ namespace {
 
 PYBIND11_PLUGIN(htmPixelization) {
     py::module mod("htmPixelization");
+    py::module::import("lsst.sphgeom.pixelCache");
     py::module::import("lsst.sphgeom.pixelization");
     py::module::import("lsst.sphgeom.region");
 
@@ -44,9 +45,12 @@ PYBIND11_PLUGIN(htmPixelization) {
     cls.def_static("asString", &HtmPixelization::asString, "i"_a);
 
     cls.def(py::init<int>(), "level"_a);
+    cls.def(py::init<int, std::shared_ptr<PixelCache>>(), "level"_a,
+            "cache"_a);
     cls.def(py::init<HtmPixelization const &>(), "htmPixelization"_a);
 
     cls.def("getLevel", &HtmPixelization::getLevel);
+    cls.def("getCache", &HtmPixelization::getCache);
 
     cls.def("__eq__",
             [](HtmPixelization const &self, HtmPixelization const &other) {
@@ -0,0 +1,60 @@
+/*
+ * LSST Data Management System
+ * See COPYRIGHT file at the top of the source tree.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include "pybind11/pybind11.h"
+
+#include <memory>
+
+#include "lsst/sphgeom/HtmVertexTable.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace sphgeom {
+namespace {
+
+PYBIND11_PLUGIN(htmVertexTable) {
+    py::module mod("htmVertexTable");
+    py::module::import("lsst.sphgeom.convexPolygon");
+    py::module::import("lsst.sphgeom.unitVector3d");
+
+    py::class_<HtmVertexTable, std::shared_ptr<HtmVertexTable>> cls(
+            mod, "HtmVertexTable");
+
+    cls.attr("MAX_DEPTH") = py::int_(HtmVertexTable::MAX_DEPTH);
+
+    cls.def(py::init<int>(), "depth"_a = 8);
+
+    cls.def("getDepth", &HtmVertexTable::getDepth);
+    cls.def("index", &HtmVertexTable::index, "v"_a, "level"_a);
+    cls.def("triangle", &HtmVertexTable::triangle, "i"_a);
+
+    cls.def("__repr__", [](HtmVertexTable const &self) {
+        return py::str("HtmVertexTable({!s})").format(self.getDepth());
+    });
+
+    return mod.ptr();
+}
+
+}  // <anonymous>
+}  // sphgeom
+}  // lsst
@@ -32,6 +32,7 @@ namespace {
 
 PYBIND11_PLUGIN(mq3cPixelization) {
     py::module mod("mq3cPixelization");
+    py::module::import("lsst.sphgeom.pixelCache");
     py::module::import("lsst.sphgeom.pixelization");
     py::module::import("lsst.sphgeom.region");
 
@@ -45,9 +46,12 @@ PYBIND11_PLUGIN(mq3cPixelization) {
     cls.def_static("asString", &Mq3cPixelization::asString);
 
     cls.def(py::init<int>(), "level"_a);
+    cls.def(py::init<int, std::shared_ptr<PixelCache>>(), "level"_a,
+            "cache"_a);
     cls.def(py::init<Mq3cPixelization const &>(), "mq3cPixelization"_a);
 
     cls.def("getLevel", &Mq3cPixelization::getLevel);
+    cls.def("getCache", &Mq3cPixelization::getCache);
 
     cls.def("__eq__",
             [](Mq3cPixelization const &self, Mq3cPixelization const &other) {
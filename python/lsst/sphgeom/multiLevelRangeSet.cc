@@ -0,0 +1,114 @@
+/*
+ * LSST Data Management System
+ * See COPYRIGHT file at the top of the source tree.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include "pybind11/pybind11.h"
+
+#include <algorithm>
+
+#include "lsst/sphgeom/MultiLevelRangeSet.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace sphgeom {
+namespace {
+
+/// `finestLevel` returns the level at which the given set can be converted
+/// to a RangeSet and back without loss.
+int finestLevel(MultiLevelRangeSet const &self) {
+    return std::max(self.getMaxLevel(), 0);
+}
+
+PYBIND11_PLUGIN(multiLevelRangeSet) {
+    py::module mod("multiLevelRangeSet");
+
+    py::module::import("lsst.sphgeom.rangeSet");
+
+    py::class_<MultiLevelRangeSet> cls(mod, "MultiLevelRangeSet");
+
+    cls.attr("MAX_LEVEL") = py::int_(MultiLevelRangeSet::MAX_LEVEL);
+
+    cls.def(py::init<>());
+    cls.def(py::init<RangeSet const &, int>(), "rangeSet"_a, "level"_a);
+    cls.def(py::init<MultiLevelRangeSet const &>(), "multiLevelRangeSet"_a);
+
+    cls.def("__eq__", &MultiLevelRangeSet::operator==, py::is_operator());
+    cls.def("__ne__", &MultiLevelRangeSet::operator!=, py::is_operator());
+
+    cls.def("__len__", &MultiLevelRangeSet::size);
+    cls.def("empty", &MultiLevelRangeSet::empty);
+    cls.def("getMaxLevel", &MultiLevelRangeSet::getMaxLevel);
+    cls.def("getCells", &MultiLevelRangeSet::getCells, "level"_a);
+    cls.def("toRangeSet", &MultiLevelRangeSet::toRangeSet, "level"_a);
+
+    cls.def("contains",
+            (bool (MultiLevelRangeSet::*)(uint64_t, int) const) &
+                    MultiLevelRangeSet::contains,
+            "index"_a, "level"_a);
+    cls.def("contains",
+            (bool (MultiLevelRangeSet::*)(MultiLevelRangeSet const &) const) &
+                    MultiLevelRangeSet::contains,
+            "multiLevelRangeSet"_a);
+    cls.def("intersects",
+            (bool (MultiLevelRangeSet::*)(uint64_t, int) const) &
+                    MultiLevelRangeSet::intersects,
+            "index"_a, "level"_a);
+    cls.def("intersects",
+            (bool (MultiLevelRangeSet::*)(MultiLevelRangeSet const &) const) &
+                    MultiLevelRangeSet::intersects,
+            "multiLevelRangeSet"_a);
+
+    cls.def("intersection", &MultiLevelRangeSet::intersection,
+            "multiLevelRangeSet"_a);
+    cls.def("join", &MultiLevelRangeSet::join, "multiLevelRangeSet"_a);
+    cls.def("difference", &MultiLevelRangeSet::difference,
+            "multiLevelRangeSet"_a);
+    cls.def("symmetricDifference", &MultiLevelRangeSet::symmetricDifference,
+            "multiLevelRangeSet"_a);
+    cls.def("__and__", &MultiLevelRangeSet::operator&, py::is_operator());
+    cls.def("__or__", &MultiLevelRangeSet::operator|, py::is_operator());
+    cls.def("__sub__", &MultiLevelRangeSet::operator-, py::is_operator());
+    cls.def("__xor__", &MultiLevelRangeSet::operator^, py::is_operator());
+    cls.def("__iand__", &MultiLevelRangeSet::operator&=);
+    cls.def("__ior__", &MultiLevelRangeSet::operator|=);
+    cls.def("__isub__", &MultiLevelRangeSet::operator-=);
+    cls.def("__ixor__", &MultiLevelRangeSet::operator^=);
+
+    cls.def("isValid", &MultiLevelRangeSet::isValid);
+
+    cls.def("__repr__", [](MultiLevelRangeSet const &self) {
+        return py::str("MultiLevelRangeSet({!r}, {!s})")
+                .format(self.toRangeSet(finestLevel(self)), finestLevel(self));
+    });
+
+    cls.def("__reduce__", [cls](MultiLevelRangeSet const &self) {
+        return py::make_tuple(
+                cls, py::make_tuple(self.toRangeSet(finestLevel(self)),
+                                    finestLevel(self)));
+    });
+
+    return mod.ptr();
+}
+
+}  // <anonymous>
+}  // sphgeom
+}  // lsst
@@ -0,0 +1,65 @@
+/*
+ * LSST Data Management System
+ * See COPYRIGHT file at the top of the source tree.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+#include "pybind11/pybind11.h"
+
+#include <memory>
+
+#include "lsst/sphgeom/PixelCache.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace sphgeom {
+namespace {
+
+PYBIND11_PLUGIN(pixelCache) {
+    py::module mod("pixelCache");
+
+    py::class_<PixelCache, std::shared_ptr<PixelCache>> cls(mod,
+                                                            "PixelCache");
+
+    cls.def(py::init<size_t>(), "capacity"_a);
+
+    cls.def("getCapacity", &PixelCache::getCapacity);
+    cls.def("getStatistics", [](PixelCache const &self) {
+        PixelCache::Statistics s = self.getStatistics();
+        py::dict d;
+        d["hits"] = s.hits;
+        d["misses"] = s.misses;
+        d["evictions"] = s.evictions;
+        d["size"] = s.size;
+        d["capacity"] = s.capacity;
+        return d;
+    });
+    cls.def("clear", &PixelCache::clear);
+
+    cls.def("__repr__", [](PixelCache const &self) {
+        return py::str("PixelCache({!s})").format(self.getCapacity());
+    });
+
+    return mod.ptr();
+}
+
+}  // <anonymous>
+}  // sphgeom
+}  // lsst
@@ -20,6 +20,7 @@
  * see <https://www.lsstcorp.org/LegalNotices/>.
  */
 #include "pybind11/pybind11.h"
+#include "pybind11/functional.h"
 
 #include "lsst/sphgeom/Pixelization.h"
 #include "lsst/sphgeom/Region.h"
@@ -39,10 +40,26 @@ PYBIND11_PLUGIN(pixelization) {
 
     cls.def("universe", &Pixelization::universe);
     cls.def("pixel", &Pixelization::pixel, "i"_a);
-    cls.def("index", &Pixelization::index, "i"_a);
+    cls.def("index",
+            (uint64_t (Pixelization::*)(UnitVector3d const &) const) &
+                    Pixelization::index,
+            "i"_a);
     cls.def("toString", &Pixelization::toString, "i"_a);
-    cls.def("envelope", &Pixelization::envelope, "region"_a, "maxRanges"_a = 0);
-    cls.def("interior", &Pixelization::interior, "region"_a, "maxRanges"_a = 0);
+    cls.def("envelope",
+            (RangeSet (Pixelization::*)(Region const &, size_t) const) &
+                    Pixelization::envelope,
+            "region"_a, "maxRanges"_a = 0);
+    cls.def("streamEnvelope",
+            [](Pixelization const & self,
+               Region const & region,
+               std::function<void(uint64_t, uint64_t)> const & sink) {
+                self.streamEnvelope(region, sink);
+            },
+            "region"_a, "sink"_a);
+    cls.def("interior",
+            (RangeSet (Pixelization::*)(Region const &, size_t) const) &
+                    Pixelization::interior,
+            "region"_a, "maxRanges"_a = 0);
 
     return mod.ptr();
 }
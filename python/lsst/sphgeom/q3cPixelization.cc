@@ -32,6 +32,7 @@ namespace {
 
 PYBIND11_PLUGIN(q3cPixelization) {
     py::module mod("q3cPixelization");
+    py::module::import("lsst.sphgeom.pixelCache");
     py::module::import("lsst.sphgeom.pixelization");
     py::module::import("lsst.sphgeom.region");
 
@@ -40,9 +41,12 @@ PYBIND11_PLUGIN(q3cPixelization) {
     cls.attr("MAX_LEVEL") = py::int_(Q3cPixelization::MAX_LEVEL);
 
     cls.def(py::init<int>(), "level"_a);
+    cls.def(py::init<int, std::shared_ptr<PixelCache>>(), "level"_a,
+            "cache"_a);
     cls.def(py::init<Q3cPixelization const &>(), "q3cPixelization"_a);
 
     cls.def("getLevel", &Q3cPixelization::getLevel);
+    cls.def("getCache", &Q3cPixelization::getCache);
     cls.def("quad", &Q3cPixelization::quad);
     cls.def("neighborhood", &Q3cPixelization::neighborhood);
 
@@ -22,6 +22,7 @@
 #include "pybind11/pybind11.h"
 
 #include <stdexcept>
+#include <vector>
 
 #include "lsst/sphgeom/RangeSet.h"
 #include "lsst/sphgeom/python/utils.h"
@@ -64,6 +65,15 @@ RangeSet makeRangeSet(py::iterable iterable) {
     return rs;
 }
 
+/// Make a vector of RangeSets from an iterable of RangeSets.
+std::vector<RangeSet> makeRangeSets(py::iterable iterable) {
+    std::vector<RangeSet> sets;
+    for (py::handle item : iterable) {
+        sets.push_back(item.cast<RangeSet>());
+    }
+    return sets;
+}
+
 /// Make a python list of the ranges in the given RangeSet.
 py::list ranges(RangeSet const &self) {
     py::list list;
@@ -117,6 +127,31 @@ PYBIND11_PLUGIN(rangeSet) {
     cls.def("difference", &RangeSet::difference, "rangeSet"_a);
     cls.def("symmetricDifference", &RangeSet::symmetricDifference,
             "rangeSet"_a);
+    cls.def_static("fromValues",
+                   [](py::iterable iterable, unsigned int numThreads) {
+                       std::vector<uint64_t> values;
+                       for (py::handle item : iterable) {
+                           values.push_back(_uint64(item));
+                       }
+                       return RangeSet::fromValues(values, numThreads);
+                   },
+                   "values"_a, "numThreads"_a = 1);
+    cls.def_static("joinAll",
+                   [](py::iterable sets) {
+                       return RangeSet::joinAll(makeRangeSets(sets));
+                   },
+                   "rangeSets"_a);
+    cls.def_static("intersectAll",
+                   [](py::iterable sets) {
+                       return RangeSet::intersectAll(makeRangeSets(sets));
+                   },
+                   "rangeSets"_a);
+    cls.def_static("coveredByAtLeast",
+                   [](py::iterable sets, size_t m) {
+                       return RangeSet::coveredByAtLeast(makeRangeSets(sets),
+                                                         m);
+                   },
+                   "rangeSets"_a, "m"_a);
     cls.def("__invert__", &RangeSet::operator~, py::is_operator());
     cls.def("__and__", &RangeSet::operator&, py::is_operator());
     cls.def("__or__", &RangeSet::operator|, py::is_operator());
@@ -199,6 +234,21 @@ PYBIND11_PLUGIN(rangeSet) {
     // requirement, and the latter doesn't seem relevant to Python.
     cls.def("isValid", &RangeSet::cardinality);
     cls.def("ranges", &ranges);
+    cls.def("encode", [](RangeSet const &self) {
+        std::vector<uint8_t> bytes = self.encode();
+        return py::bytes(reinterpret_cast<char const *>(bytes.data()),
+                         bytes.size());
+    });
+    cls.def_static(
+            "decode",
+            [](py::bytes bytes) {
+                uint8_t const *buffer = reinterpret_cast<uint8_t const *>(
+                        PYBIND11_BYTES_AS_STRING(bytes.ptr()));
+                size_t n =
+                        static_cast<size_t>(PYBIND11_BYTES_SIZE(bytes.ptr()));
+                return RangeSet::decode(buffer, n);
+            },
+            "bytes"_a);
 
     cls.def("__str__",
             [](RangeSet const &self) { return py::str(ranges(self)); });
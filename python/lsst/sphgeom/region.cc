@@ -57,8 +57,12 @@ PYBIND11_PLUGIN(region) {
     cls.def("getBoundingBox", &Region::getBoundingBox);
     cls.def("getBoundingBox3d", &Region::getBoundingBox3d);
     cls.def("getBoundingCircle", &Region::getBoundingCircle);
-    cls.def("contains", &Region::contains, "unitVector"_a);
-    cls.def("__contains__", &Region::contains, "unitVector"_a,
+    cls.def("contains",
+            (bool (Region::*)(UnitVector3d const &) const) & Region::contains,
+            "unitVector"_a);
+    cls.def("__contains__",
+            (bool (Region::*)(UnitVector3d const &) const) & Region::contains,
+            "unitVector"_a,
             py::is_operator());
     // The per-subclass relate() overloads are used to implement
     // double-dispatch in C++, and are not needed in Python.
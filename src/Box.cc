@@ -36,6 +36,8 @@
 #include "lsst/sphgeom/codec.h"
 #include "lsst/sphgeom/utils.h"
 
+#include "ContainsImpl.h"
+
 
 namespace lsst {
 namespace sphgeom {
@@ -315,6 +317,20 @@ Circle Box::getBoundingCircle() const {
     return Circle(v, r + 4.0 * Angle(MAX_ASIN_ERROR));
 }
 
+void Box::contains(double const * x,
+                   double const * y,
+                   double const * z,
+                   size_t n,
+                   uint64_t * result) const
+{
+    // Converting to spherical coordinates requires evaluating atan2, which
+    // does not vectorize, so points are tested one at a time. This still
+    // avoids a virtual function call per point.
+    detail::containsBatch(x, y, z, n, result, [this](UnitVector3d const & v) {
+        return contains(LonLat(v));
+    });
+}
+
 Relationship Box::relate(Circle const & c) const {
     if (isEmpty()) {
         if (c.isEmpty()) {
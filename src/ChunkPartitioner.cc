@@ -0,0 +1,314 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains the ChunkPartitioner implementation.
+
+#include "lsst/sphgeom/ChunkPartitioner.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "parallel.h"
+
+
+namespace lsst {
+namespace sphgeom {
+
+namespace {
+
+// Batches are only split between threads if each thread receives at least
+// this many rows, as starting a thread is not free.
+size_t const MIN_ROWS_PER_THREAD = 1024;
+
+size_t bufferSize(ChunkBuffer const & b) {
+    return b.data.size() + b.rows.size() * sizeof(ChunkRow);
+}
+
+typedef std::unordered_map<int32_t, ChunkBuffer> BufferMap;
+
+// `Journal` records the changes made to the buffers in a BufferMap while
+// adding a batch, so that they can be undone if adding it fails. Space for
+// the given number of changes is reserved up front, so that recording them
+// cannot throw.
+class Journal {
+public:
+    explicit Journal(size_t n) {
+        _created.reserve(n);
+        _appended.reserve(n);
+    }
+
+    void created(int32_t chunkId) { _created.push_back(chunkId); }
+
+    void appending(ChunkBuffer & b) {
+        Mark m = {&b, b.rows.size(), b.data.size()};
+        _appended.push_back(m);
+    }
+
+    // `undo` restores the buffers to their state before the first change.
+    void undo(BufferMap & buffers) {
+        for (auto i = _appended.rbegin(); i != _appended.rend(); ++i) {
+            i->buffer->rows.resize(i->numRows);
+            i->buffer->data.resize(i->numBytes);
+        }
+        for (int32_t chunkId: _created) {
+            buffers.erase(chunkId);
+        }
+    }
+
+private:
+    struct Mark {
+        ChunkBuffer * buffer;
+        size_t numRows;
+        size_t numBytes;
+    };
+
+    std::vector<int32_t> _created;
+    std::vector<Mark> _appended;
+};
+
+// `append` appends a row to the buffer for its chunk, creating the buffer
+// if necessary. Changes are recorded in `journal` if it is not null.
+void append(BufferMap & buffers,
+            ChunkLocation const & location,
+            bool overlap,
+            std::string const & payload,
+            Journal * journal)
+{
+    auto i = buffers.find(location.chunkId);
+    if (i == buffers.end()) {
+        i = buffers.emplace(location.chunkId, ChunkBuffer()).first;
+        i->second.chunkId = location.chunkId;
+        if (journal) {
+            journal->created(location.chunkId);
+        }
+    } else if (journal) {
+        journal->appending(i->second);
+    }
+    ChunkBuffer & b = i->second;
+    ChunkRow row;
+    row.subChunkId = location.subChunkId;
+    row.overlap = overlap;
+    row.offset = b.data.size();
+    row.size = payload.size();
+    b.rows.push_back(row);
+    b.data.append(payload);
+}
+
+// `merge` appends the rows in `staged` to the buffers for their chunks.
+// Staged buffers for chunks without a buffer are moved rather than copied.
+void merge(BufferMap & buffers, BufferMap & staged, Journal & journal) {
+    for (auto & entry: staged) {
+        ChunkBuffer & s = entry.second;
+        auto i = buffers.find(entry.first);
+        if (i == buffers.end()) {
+            i = buffers.emplace(entry.first, ChunkBuffer()).first;
+            journal.created(entry.first);
+            std::swap(i->second, s);
+            continue;
+        }
+        ChunkBuffer & b = i->second;
+        journal.appending(b);
+        size_t offset = b.data.size();
+        for (ChunkRow row: s.rows) {
+            row.offset += offset;
+            b.rows.push_back(row);
+        }
+        b.data.append(s.data);
+    }
+}
+
+} // unnamed namespace
+
+
+constexpr size_t ChunkPartitioner::DEFAULT_MAX_BUFFERED_BYTES;
+
+ChunkPartitioner::ChunkPartitioner(Chunker const & chunker,
+                                   Sink sink,
+                                   size_t maxBufferedBytes,
+                                   unsigned int numThreads) :
+    _chunker(chunker),
+    _sink(std::move(sink)),
+    _maxBufferedBytes(maxBufferedBytes),
+    _numThreads(numThreads)
+{
+    if (!_sink) {
+        throw std::invalid_argument("A sink must be provided");
+    }
+    if (_numThreads == 0) {
+        _numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+}
+
+void ChunkPartitioner::add(LonLat const * positions,
+                           std::string const * payloads,
+                           size_t n)
+{
+    if (n == 0) {
+        return;
+    }
+    // Assign rows to chunks, using contiguous slices of the batch per
+    // thread. If there are several threads, each also copies its rows to
+    // per-thread chunk buffers; concatenating these for a chunk in thread
+    // order yields its rows in row order.
+    unsigned int numThreads = static_cast<unsigned int>(std::max<size_t>(
+        1, std::min<size_t>(_numThreads, n / MIN_ROWS_PER_THREAD)));
+    std::vector<std::vector<Assignment>> assignments(numThreads);
+    std::vector<BufferMap> staged(numThreads > 1 ? numThreads : 0);
+    std::vector<uint64_t> numOverlapRows(numThreads, 0);
+    std::vector<size_t> numBytes(numThreads, 0);
+    runInParallel(numThreads, [&](unsigned int t) {
+        size_t begin = n * t / numThreads;
+        size_t end = n * (t + 1) / numThreads;
+        _assign(positions, begin, end, assignments[t]);
+        for (Assignment const & a: assignments[t]) {
+            numOverlapRows[t] += a.overlap ? 1 : 0;
+            numBytes[t] += payloads[a.row].size() + sizeof(ChunkRow);
+        }
+        if (numThreads > 1) {
+            staged[t].reserve(assignments[t].size());
+            for (Assignment const & a: assignments[t]) {
+                append(staged[t], a.location, a.overlap, payloads[a.row],
+                       nullptr);
+            }
+        }
+    });
+    // Append rows to chunk buffers, undoing all changes if that fails.
+    if (numThreads == 1) {
+        Journal journal(assignments[0].size());
+        try {
+            for (Assignment const & a: assignments[0]) {
+                append(_buffers, a.location, a.overlap, payloads[a.row],
+                       &journal);
+            }
+        } catch (...) {
+            journal.undo(_buffers);
+            throw;
+        }
+    } else {
+        size_t numStaged = 0;
+        for (BufferMap const & m: staged) {
+            numStaged += m.size();
+        }
+        Journal journal(numStaged);
+        try {
+            for (BufferMap & m: staged) {
+                merge(_buffers, m, journal);
+            }
+        } catch (...) {
+            journal.undo(_buffers);
+            throw;
+        }
+    }
+    for (unsigned int t = 0; t < numThreads; ++t) {
+        _statistics.numOverlapRows += numOverlapRows[t];
+        _statistics.bufferedBytes += numBytes[t];
+    }
+    _statistics.numRows += n;
+    if (_statistics.bufferedBytes > _maxBufferedBytes) {
+        _flush(_maxBufferedBytes / 2);
+    }
+}
+
+void ChunkPartitioner::flush() {
+    std::vector<int32_t> chunkIds;
+    chunkIds.reserve(_buffers.size());
+    for (auto const & entry: _buffers) {
+        chunkIds.push_back(entry.first);
+    }
+    std::sort(chunkIds.begin(), chunkIds.end());
+    for (int32_t chunkId: chunkIds) {
+        auto i = _buffers.find(chunkId);
+        _sink(i->second);
+        ++_statistics.numFlushes;
+        _statistics.bufferedBytes -= bufferSize(i->second);
+        _buffers.erase(i);
+    }
+}
+
+void ChunkPartitioner::_assign(LonLat const * positions,
+                               size_t begin,
+                               size_t end,
+                               std::vector<Assignment> & assignments) const
+{
+    for (size_t i = begin; i < end; ++i) {
+        if (positions[i].getLat().isNan()) {
+            throw std::invalid_argument("Row positions must not be NaN");
+        }
+    }
+    bool const hasOverlap = _chunker.getOverlap() > Angle(0.0);
+    std::vector<ChunkLocation> locations;
+    std::vector<size_t> offsets;
+    if (hasOverlap) {
+        _chunker.getOverlapSubChunks(positions + begin, end - begin,
+                                     locations, offsets);
+    }
+    assignments.reserve(locations.size() + end - begin);
+    for (size_t i = begin; i < end; ++i) {
+        Assignment a;
+        a.row = i;
+        a.location = _chunker.locate(positions[i]);
+        a.overlap = false;
+        assignments.push_back(a);
+        if (!hasOverlap) {
+            continue;
+        }
+        ChunkLocation const home = a.location;
+        a.overlap = true;
+        for (size_t j = offsets[i - begin]; j < offsets[i - begin + 1]; ++j) {
+            if (locations[j] != home) {
+                a.location = locations[j];
+                assignments.push_back(a);
+            }
+        }
+    }
+}
+
+void ChunkPartitioner::_flush(size_t maxBufferedBytes) {
+    // Flush the largest buffers first, breaking ties by chunk ID so that
+    // the order of sink calls is deterministic.
+    std::vector<std::pair<size_t, int32_t>> sizes;
+    sizes.reserve(_buffers.size());
+    for (auto const & entry: _buffers) {
+        sizes.emplace_back(bufferSize(entry.second), entry.first);
+    }
+    std::sort(sizes.begin(), sizes.end(),
+              [](std::pair<size_t, int32_t> const & a,
+                 std::pair<size_t, int32_t> const & b) {
+                  return a.first > b.first ||
+                         (a.first == b.first && a.second < b.second);
+              });
+    for (auto const & s: sizes) {
+        if (_statistics.bufferedBytes <= maxBufferedBytes) {
+            break;
+        }
+        auto i = _buffers.find(s.second);
+        _sink(i->second);
+        ++_statistics.numFlushes;
+        _statistics.bufferedBytes -= s.first;
+        _buffers.erase(i);
+    }
+}
+
+}} // namespace lsst::sphgeom
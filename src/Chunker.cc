@@ -25,6 +25,10 @@
 
 #include "lsst/sphgeom/Chunker.h"
 
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
 namespace lsst {
 namespace sphgeom {
 
@@ -51,16 +55,132 @@ int32_t computeNumSegments(AngleInterval const & latitudes, Angle width) {
 
 constexpr double BOX_EPSILON = 5.0e-12; // ~1 micro-arcsecond
 
+// `getOverlapRange` computes the range [a, b] of indexes of the longitude
+// segments with the given width and overlap half-width that contain lon in
+// their overlap bounds. Segment i spans [i * width, (i + 1) * width], and
+// is dilated by halfWidth on both sides. The returned indexes must be
+// reduced modulo n, the number of segments in a full circle.
+void getOverlapRange(Angle lon, Angle width, Angle halfWidth, int32_t n,
+                     int32_t & a, int32_t & b)
+{
+    double xa = std::ceil((lon - halfWidth) / width) - 1.0;
+    double xb = std::floor((lon + halfWidth) / width);
+    if (halfWidth.asRadians() >= PI || xb - xa + 1.0 >= n) {
+        a = 0;
+        b = n - 1;
+    } else {
+        a = static_cast<int32_t>(xa);
+        b = static_cast<int32_t>(xb);
+    }
+}
+
+// `getBoxGeometry` computes the longitude half-width and latitude interval
+// used to build the bounding boxes of chunks or sub-chunks with the given
+// latitude interval. The boxes are dilated by BOX_EPSILON to guard against
+// rounding errors, and are identical to those produced by dilating the
+// undilated boxes with Box::dilatedBy.
+void getBoxGeometry(AngleInterval const & lat,
+                    Angle & halfWidth,
+                    AngleInterval & boxLat)
+{
+    Box b = Box(NormalizedAngleInterval(Angle(0.0)), lat).dilatedBy(
+        Angle(BOX_EPSILON));
+    halfWidth = Angle(Box::halfWidthForCircle(
+        Angle(BOX_EPSILON), std::max(abs(lat.getA()), abs(lat.getB()))));
+    boxLat = b.getLat();
+}
+
+int32_t wrap(int32_t i, int32_t n) {
+    i %= n;
+    return i < 0 ? i + n : i;
+}
+
+// `appendChunks` records the chunks with IDs in [first, last] found by a
+// region query. Runs are found in order of increasing chunk ID, so each
+// call appends to the end of the output.
+void appendChunks(std::vector<int32_t> & chunkIds, int32_t first,
+                  int32_t last)
+{
+    for (int32_t c = first; c <= last; ++c) {
+        chunkIds.push_back(c);
+    }
+}
+
+void appendChunks(RangeSet & chunkIds, int32_t first, int32_t last) {
+    chunkIds.insert(static_cast<uint64_t>(first),
+                    static_cast<uint64_t>(last) + 1);
+}
+
+// Sub-chunk sinks record the sub-chunks found by a region query. Chunks are
+// visited in order of increasing chunk ID. Between `beginChunk` and
+// `endChunk`, `append` is called with runs of sub-chunk IDs in increasing
+// order.
+
+// `SubChunkRangesSink` stores one SubChunkRanges per chunk that has any
+// sub-chunks intersecting the region. The ranges of each chunk are
+// collected in a reused buffer, so that each stored SubChunkRanges is
+// allocated once, with the exact size required.
+class SubChunkRangesSink {
+public:
+    explicit SubChunkRangesSink(std::vector<SubChunkRanges> & chunks) :
+        _chunks(chunks)
+    {}
+
+    void beginChunk(int32_t chunkId) { _current.chunkId = chunkId; }
+
+    void append(int32_t begin, int32_t end) { _current.append(begin, end); }
+
+    void endChunk() {
+        if (!_current.ranges.empty()) {
+            _chunks.push_back(_current);
+            _current.ranges.clear();
+        }
+    }
+
+private:
+    std::vector<SubChunkRanges> & _chunks;
+    SubChunkRanges _current;
+};
+
+// `SubChunkSetSink` appends global sub-chunk IDs directly to a RangeSet,
+// without storing per-chunk ranges.
+class SubChunkSetSink {
+public:
+    SubChunkSetSink(RangeSet & subChunkIds, uint64_t numSubChunkIdsPerChunk) :
+        _subChunkIds(subChunkIds),
+        _numSubChunkIdsPerChunk(numSubChunkIdsPerChunk),
+        _base(0)
+    {}
+
+    void beginChunk(int32_t chunkId) {
+        _base = static_cast<uint64_t>(chunkId) * _numSubChunkIdsPerChunk;
+    }
+
+    void append(int32_t begin, int32_t end) {
+        _subChunkIds.insert(_base + static_cast<uint64_t>(begin),
+                            _base + static_cast<uint64_t>(end));
+    }
+
+    void endChunk() {}
+
+private:
+    RangeSet & _subChunkIds;
+    uint64_t _numSubChunkIdsPerChunk;
+    uint64_t _base;
+};
+
 } // unnamed namespace
 
 
 Chunker::Chunker(int32_t numStripes,
-                 int32_t numSubStripesPerStripe) :
+                 int32_t numSubStripesPerStripe,
+                 Angle overlap) :
     _numStripes(numStripes),
     _numSubStripesPerStripe(numSubStripesPerStripe),
     _numSubStripes(numStripes * numSubStripesPerStripe),
     _maxSubChunksPerSubStripeChunk(0),
-    _subStripeHeight(Angle(PI) / _numSubStripes)
+    _subStripeHeight(Angle(PI) / _numSubStripes),
+    _overlap(overlap)
 {
     if (numStripes < 1 || numSubStripesPerStripe < 1) {
         throw std::runtime_error("The number of stripes and sub-stripes "
@@ -69,6 +189,10 @@ Chunker::Chunker(int32_t numStripes,
     if (numStripes * numSubStripesPerStripe > 180*3600) {
         throw std::runtime_error("Sub-stripes are too small");
     }
+    if (!(overlap >= Angle(0.0) && overlap <= _subStripeHeight)) {
+        throw std::runtime_error("The overlap radius must be non-negative "
+                                 "and at most the sub-stripe height");
+    }
     Angle const stripeHeight = Angle(PI) / _numStripes;
     _stripes.reserve(_numStripes);
     _subStripes.reserve(_numSubStripes);
@@ -80,6 +204,9 @@ Chunker::Chunker(int32_t numStripes,
         int32_t const nc = computeNumSegments(sLat, stripeHeight);
         stripe.chunkWidth = Angle(2.0 * PI) / nc;
         stripe.numChunksPerStripe = nc;
+        stripe.overlapHalfWidth = Angle(Box::halfWidthForCircle(
+            overlap, std::max(abs(sLat.getA()), abs(sLat.getB()))));
+        getBoxGeometry(sLat, stripe.boxHalfWidth, stripe.boxLat);
         int32_t ss = s * _numSubStripesPerStripe;
         int32_t const ssEnd = ss + _numSubStripesPerStripe;
         for (; ss < ssEnd; ++ss) {
@@ -94,6 +221,9 @@ Chunker::Chunker(int32_t numStripes,
                 _maxSubChunksPerSubStripeChunk = nsc;
             }
             subStripe.subChunkWidth = Angle(2.0 * PI) / (nsc * nc);
+            subStripe.overlapHalfWidth = Angle(Box::halfWidthForCircle(
+                overlap, std::max(abs(ssLat.getA()), abs(ssLat.getB()))));
+            getBoxGeometry(ssLat, subStripe.boxHalfWidth, subStripe.boxLat);
             _subStripes.push_back(subStripe);
         }
         _stripes.push_back(stripe);
@@ -102,6 +232,46 @@ Chunker::Chunker(int32_t numStripes,
 
 std::vector<int32_t> Chunker::getChunksIntersecting(Region const & r) const {
     std::vector<int32_t> chunkIds;
+    _getChunksIntersecting(chunkIds, r);
+    return chunkIds;
+}
+
+std::vector<SubChunks> Chunker::getSubChunksIntersecting(
+    Region const & r) const
+{
+    std::vector<SubChunkRanges> ranges = getSubChunkRangesIntersecting(r);
+    std::vector<SubChunks> chunks(ranges.size());
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        chunks[i].chunkId = ranges[i].chunkId;
+        chunks[i].subChunkIds = ranges[i].getSubChunkIds();
+    }
+    return chunks;
+}
+
+std::vector<SubChunkRanges> Chunker::getSubChunkRangesIntersecting(
+    Region const & r) const
+{
+    std::vector<SubChunkRanges> chunks;
+    SubChunkRangesSink sink(chunks);
+    _getSubChunksIntersecting(sink, r);
+    return chunks;
+}
+
+RangeSet Chunker::getChunkSetIntersecting(Region const & r) const {
+    RangeSet chunkIds;
+    _getChunksIntersecting(chunkIds, r);
+    return chunkIds;
+}
+
+RangeSet Chunker::getSubChunkSetIntersecting(Region const & r) const {
+    RangeSet subChunkIds;
+    SubChunkSetSink sink(subChunkIds, _getNumSubChunkIdsPerChunk());
+    _getSubChunksIntersecting(sink, r);
+    return subChunkIds;
+}
+
+template <typename Chunks>
+void Chunker::_getChunksIntersecting(Chunks & chunks, Region const & r) const {
     // Find the stripes that intersect the bounding box of r.
     Box b = r.getBoundingBox().dilatedBy(Angle(BOX_EPSILON));
     double ya = std::floor((b.getLat().getA() + Angle(0.5 * PI)) / _subStripeHeight);
@@ -122,33 +292,21 @@ std::vector<int32_t> Chunker::getChunksIntersecting(Region const & r) const {
             ca = 0;
             cb = nc - 1;
         }
-        // Examine each chunk overlapping the bounding box of r.
+        // Examine the chunks overlapping the bounding box of r, in order of
+        // increasing chunk ID.
         if (ca <= cb) {
-            for (int32_t c = ca; c <= cb; ++c) {
-                if ((r.relate(_getChunkBoundingBox(s, c)) & DISJOINT) == 0) {
-                    chunkIds.push_back(_getChunkId(s, c));
-                }
-            }
+            _findChunks(chunks, r, s, ca, cb);
         } else {
-            for (int32_t c = 0; c <= cb; ++c) {
-                if ((r.relate(_getChunkBoundingBox(s, c)) & DISJOINT) == 0) {
-                    chunkIds.push_back(_getChunkId(s, c));
-                }
-            }
-            for (int32_t c = ca; c < nc; ++c) {
-                if ((r.relate(_getChunkBoundingBox(s, c)) & DISJOINT) == 0) {
-                    chunkIds.push_back(_getChunkId(s, c));
-                }
-            }
+            _findChunks(chunks, r, s, 0, cb);
+            _findChunks(chunks, r, s, ca, nc - 1);
         }
     }
-    return chunkIds;
 }
 
-std::vector<SubChunks> Chunker::getSubChunksIntersecting(
-    Region const & r) const
+template <typename SubChunkSink>
+void Chunker::_getSubChunksIntersecting(SubChunkSink & sink,
+                                        Region const & r) const
 {
-    std::vector<SubChunks> chunks;
     // Find the stripes that intersect the bounding box of r.
     Box b = r.getBoundingBox().dilatedBy(Angle(BOX_EPSILON));
     double ya = std::floor((b.getLat().getA() + Angle(0.5 * PI)) / _subStripeHeight);
@@ -169,90 +327,257 @@ std::vector<SubChunks> Chunker::getSubChunksIntersecting(
             ca = 0;
             cb = nc - 1;
         }
-        // Examine sub-chunks for each chunk overlapping the bounding box of r.
+        // Examine sub-chunks for each chunk overlapping the bounding box of
+        // r, in order of increasing chunk ID.
         if (ca <= cb) {
-            for (int32_t c = ca; c <= cb; ++c) {
-                _getSubChunks(chunks, r, b.getLon(), s, c, minSS, maxSS);
+            _findSubChunks(sink, r, b.getLon(), s, ca, cb, minSS, maxSS);
+        } else {
+            _findSubChunks(sink, r, b.getLon(), s, 0, cb, minSS, maxSS);
+            _findSubChunks(sink, r, b.getLon(), s, ca, nc - 1, minSS, maxSS);
+        }
+    }
+}
+
+template <typename Chunks>
+void Chunker::_findChunks(Chunks & chunks,
+                          Region const & r,
+                          int32_t stripe,
+                          int32_t minChunk,
+                          int32_t maxChunk) const
+{
+    // Relate r to the bounding box of a run of chunks, and only split the
+    // run in two if r intersects but does not contain it. This requires
+    // O(log n) relationship tests for each point where the boundary of r
+    // crosses a run of n chunks, rather than one per chunk.
+    Relationship rel = r.relate(
+        _getChunkBoundingBox(stripe, minChunk, maxChunk));
+    if ((rel & DISJOINT) != 0) {
+        return;
+    }
+    if ((rel & CONTAINS) != 0 || minChunk == maxChunk) {
+        appendChunks(chunks, _getChunkId(stripe, minChunk),
+                     _getChunkId(stripe, maxChunk));
+        return;
+    }
+    int32_t mid = minChunk + (maxChunk - minChunk) / 2;
+    _findChunks(chunks, r, stripe, minChunk, mid);
+    _findChunks(chunks, r, stripe, mid + 1, maxChunk);
+}
+
+template <typename SubChunkSink>
+void Chunker::_findSubChunks(SubChunkSink & sink,
+                             Region const & r,
+                             NormalizedAngleInterval const & lon,
+                             int32_t stripe,
+                             int32_t minChunk,
+                             int32_t maxChunk,
+                             int32_t minSS,
+                             int32_t maxSS) const
+{
+    // See _findChunks. Chunks contained by r are recorded without
+    // examining their sub-chunks.
+    Relationship rel = r.relate(
+        _getChunkBoundingBox(stripe, minChunk, maxChunk));
+    if ((rel & DISJOINT) != 0) {
+        return;
+    }
+    if ((rel & CONTAINS) != 0) {
+        for (int32_t c = minChunk; c <= maxChunk; ++c) {
+            sink.beginChunk(_getChunkId(stripe, c));
+            _appendAllSubChunks(sink, stripe);
+            sink.endChunk();
+        }
+        return;
+    }
+    if (minChunk == maxChunk) {
+        _findSubChunksOfChunk(sink, r, lon, stripe, minChunk, minSS, maxSS);
+        return;
+    }
+    int32_t mid = minChunk + (maxChunk - minChunk) / 2;
+    _findSubChunks(sink, r, lon, stripe, minChunk, mid, minSS, maxSS);
+    _findSubChunks(sink, r, lon, stripe, mid + 1, maxChunk, minSS, maxSS);
+}
+
+template <typename SubChunkSink>
+void Chunker::_findSubChunksOfChunk(SubChunkSink & sink,
+                                    Region const & r,
+                                    NormalizedAngleInterval const & lon,
+                                    int32_t stripe,
+                                    int32_t chunk,
+                                    int32_t minSS,
+                                    int32_t maxSS) const
+{
+    sink.beginChunk(_getChunkId(stripe, chunk));
+    // Find the sub-stripes to iterate over.
+    minSS = std::max(minSS, stripe * _numSubStripesPerStripe);
+    maxSS = std::min(maxSS, (stripe + 1) * _numSubStripesPerStripe - 1);
+    int32_t const nc = _stripes[stripe].numChunksPerStripe;
+    for (int32_t ss = minSS; ss <= maxSS; ++ss) {
+        // Find the sub-chunks of ss to iterate over.
+        Angle subChunkWidth = _subStripes[ss].subChunkWidth;
+        int32_t const nsc = _subStripes[ss].numSubChunksPerChunk;
+        double xa = std::floor(lon.getA() / subChunkWidth);
+        double xb = std::floor(lon.getB() / subChunkWidth);
+        int32_t sca = std::min(static_cast<int32_t>(xa), nc * nsc - 1);
+        int32_t scb = std::min(static_cast<int32_t>(xb), nc * nsc - 1);
+        if (sca == scb && lon.wraps()) {
+            sca = 0;
+            scb = nc * nsc - 1;
+        }
+        int32_t minSC = chunk * nsc;
+        int32_t maxSC = (chunk + 1) * nsc - 1;
+        // Find the sub-chunks of this chunk that intersect r, in order of
+        // increasing sub-chunk ID.
+        if (sca <= scb) {
+            minSC = std::max(sca, minSC);
+            maxSC = std::min(scb, maxSC);
+            if (minSC <= maxSC) {
+                _findSubChunksOfSubStripe(sink, r, stripe, ss, chunk,
+                                          minSC, maxSC);
             }
         } else {
-            for (int32_t c = 0; c <= cb; ++c) {
-                _getSubChunks(chunks, r, b.getLon(), s, c, minSS, maxSS);
+            sca = std::max(sca, minSC);
+            scb = std::min(scb, maxSC);
+            if (minSC <= scb) {
+                _findSubChunksOfSubStripe(sink, r, stripe, ss, chunk,
+                                          minSC, scb);
             }
-            for (int32_t c = ca; c < nc; ++c) {
-                _getSubChunks(chunks, r, b.getLon(), s, c, minSS, maxSS);
+            if (sca <= maxSC) {
+                _findSubChunksOfSubStripe(sink, r, stripe, ss, chunk,
+                                          sca, maxSC);
             }
         }
     }
-    return chunks;
+    sink.endChunk();
 }
 
-void Chunker::_getSubChunks(std::vector<SubChunks> & chunks,
-                            Region const & r,
-                            NormalizedAngleInterval const & lon,
-                            int32_t stripe,
-                            int32_t chunk,
-                            int32_t minSS,
-                            int32_t maxSS) const
+template <typename SubChunkSink>
+void Chunker::_findSubChunksOfSubStripe(SubChunkSink & sink,
+                                        Region const & r,
+                                        int32_t stripe,
+                                        int32_t subStripe,
+                                        int32_t chunk,
+                                        int32_t minSubChunk,
+                                        int32_t maxSubChunk) const
 {
-    SubChunks subChunks;
-    subChunks.chunkId = _getChunkId(stripe, chunk);
-    if ((r.relate(_getChunkBoundingBox(stripe, chunk)) & CONTAINS) != 0) {
-        // r contains the entire chunk, so there is no need to test sub-chunks
-        // for intersection with r.
-        subChunks.subChunkIds = getAllSubChunks(subChunks.chunkId);
-    } else {
-        // Find the sub-stripes to iterate over.
-        minSS = std::max(minSS, stripe * _numSubStripesPerStripe);
-        maxSS = std::min(maxSS, (stripe + 1) * _numSubStripesPerStripe - 1);
-        int32_t const nc = _stripes[stripe].numChunksPerStripe;
-        for (int32_t ss = minSS; ss <= maxSS; ++ss) {
-            // Find the sub-chunks of ss to iterate over.
-            Angle subChunkWidth = _subStripes[ss].subChunkWidth;
-            int32_t const nsc = _subStripes[ss].numSubChunksPerChunk;
-            double xa = std::floor(lon.getA() / subChunkWidth);
-            double xb = std::floor(lon.getB() / subChunkWidth);
-            int32_t sca = std::min(static_cast<int32_t>(xa), nc * nsc - 1);
-            int32_t scb = std::min(static_cast<int32_t>(xb), nc * nsc - 1);
-            if (sca == scb && lon.wraps()) {
-                sca = 0;
-                scb = nc * nsc - 1;
-            }
-            int32_t minSC = chunk * nsc;
-            int32_t maxSC = (chunk + 1) * nsc - 1;
-            // Test each sub-chunk against r, and record those that intersect.
-            if (sca <= scb) {
-                minSC = std::max(sca, minSC);
-                maxSC = std::min(scb, maxSC);
-                for (int32_t sc = minSC; sc <= maxSC; ++sc) {
-                    if ((r.relate(_getSubChunkBoundingBox(ss, sc)) & DISJOINT) == 0) {
-                        subChunks.subChunkIds.push_back(
-                            _getSubChunkId(stripe, ss, chunk, sc));
-                    }
-                }
-            } else {
-                sca = std::max(sca, minSC);
-                scb = std::min(scb, maxSC);
-                for (int32_t sc = sca; sc <= maxSC; ++sc) {
-                    if ((r.relate(_getSubChunkBoundingBox(ss, sc)) & DISJOINT) == 0) {
-                        subChunks.subChunkIds.push_back(
-                            _getSubChunkId(stripe, ss, chunk, sc));
-                    }
-                }
-                for (int32_t sc = minSC; sc <= scb; ++sc) {
-                    if ((r.relate(_getSubChunkBoundingBox(ss, sc)) & DISJOINT) == 0) {
-                        subChunks.subChunkIds.push_back(
-                            _getSubChunkId(stripe, ss, chunk, sc));
-                    }
-                }
-            }
+    // See _findChunks. The sub-chunks of a chunk in a sub-stripe have
+    // consecutive IDs, so a run of sub-chunks that is contained by r
+    // becomes a single range.
+    Relationship rel = r.relate(
+        _getSubChunkBoundingBox(subStripe, minSubChunk, maxSubChunk));
+    if ((rel & DISJOINT) != 0) {
+        return;
+    }
+    if ((rel & CONTAINS) != 0 || minSubChunk == maxSubChunk) {
+        sink.append(
+            _getSubChunkId(stripe, subStripe, chunk, minSubChunk),
+            _getSubChunkId(stripe, subStripe, chunk, maxSubChunk) + 1);
+        return;
+    }
+    int32_t mid = minSubChunk + (maxSubChunk - minSubChunk) / 2;
+    _findSubChunksOfSubStripe(sink, r, stripe, subStripe, chunk,
+                              minSubChunk, mid);
+    _findSubChunksOfSubStripe(sink, r, stripe, subStripe, chunk,
+                              mid + 1, maxSubChunk);
+}
+
+ChunkLocation Chunker::locate(LonLat const & p) const {
+    // Compute the sub-stripe and sub-chunk containing p exactly as the
+    // bounding box of a region is mapped to sub-stripes and sub-chunks in
+    // getSubChunksIntersecting, and derive the stripe and chunk from them.
+    // LonLat coordinates are always in range, but may be NaN, and converting
+    // NaN to an integer is undefined.
+    if (p.getLat().isNan()) {
+        throw std::invalid_argument("Cannot locate a NaN point");
+    }
+    double y = std::floor((p.getLat() + Angle(0.5 * PI)) / _subStripeHeight);
+    int32_t ss = std::min(std::max(static_cast<int32_t>(y), 0),
+                          _numSubStripes - 1);
+    int32_t s = ss / _numSubStripesPerStripe;
+    SubStripe const & subStripe = _subStripes[ss];
+    int32_t const nsc = subStripe.numSubChunksPerChunk;
+    int32_t const maxSC = _stripes[s].numChunksPerStripe * nsc - 1;
+    double x = std::floor(p.getLon() / subStripe.subChunkWidth);
+    int32_t sc = std::min(std::max(static_cast<int32_t>(x), 0), maxSC);
+    int32_t c = sc / nsc;
+    return ChunkLocation(_getChunkId(s, c), _getSubChunkId(s, ss, c, sc));
+}
+
+void Chunker::locate(LonLat const * points,
+                     ChunkLocation * locations,
+                     size_t n) const
+{
+    for (size_t i = 0; i < n; ++i) {
+        locations[i] = locate(points[i]);
+    }
+}
+
+void Chunker::locate(UnitVector3d const * points,
+                     ChunkLocation * locations,
+                     size_t n) const
+{
+    for (size_t i = 0; i < n; ++i) {
+        locations[i] = locate(LonLat(points[i]));
+    }
+}
+
+std::vector<int32_t> Chunker::getOverlapChunks(LonLat const & p) const {
+    std::vector<int32_t> chunkIds;
+    // A point is in the overlap bounds of a stripe iff it is in the overlap
+    // bounds of one of its sub-stripes, so the stripes to examine can be
+    // derived from the sub-stripes. This guarantees that the stripe found
+    // by locate is always among them.
+    int32_t minSS, maxSS;
+    _getOverlapSubStripes(p.getLat(), minSS, maxSS);
+    for (int32_t s = minSS / _numSubStripesPerStripe;
+         s <= maxSS / _numSubStripesPerStripe; ++s) {
+        Stripe const & stripe = _stripes[s];
+        int32_t const nc = stripe.numChunksPerStripe;
+        int32_t ca, cb;
+        getOverlapRange(p.getLon(), stripe.chunkWidth,
+                        stripe.overlapHalfWidth, nc, ca, cb);
+        for (int32_t c = ca; c <= cb; ++c) {
+            chunkIds.push_back(_getChunkId(s, wrap(c, nc)));
         }
     }
-    // If any sub-chunks of this chunk intersect r,
-    // append them to the result vector.
-    if (!subChunks.subChunkIds.empty()) {
-        chunks.push_back(SubChunks());
-        chunks.back().swap(subChunks);
+    std::sort(chunkIds.begin(), chunkIds.end());
+    return chunkIds;
+}
+
+std::vector<ChunkLocation> Chunker::getOverlapSubChunks(
+    LonLat const & p) const
+{
+    std::vector<ChunkLocation> locations;
+    _getOverlapSubChunks(p, locations);
+    return locations;
+}
+
+void Chunker::getOverlapSubChunks(LonLat const * points,
+                                  size_t n,
+                                  std::vector<ChunkLocation> & locations,
+                                  std::vector<size_t> & offsets) const
+{
+    locations.clear();
+    offsets.clear();
+    offsets.reserve(n + 1);
+    offsets.push_back(0);
+    for (size_t i = 0; i < n; ++i) {
+        _getOverlapSubChunks(points[i], locations);
+        offsets.push_back(locations.size());
+    }
+}
+
+void Chunker::getOverlapSubChunks(UnitVector3d const * points,
+                                  size_t n,
+                                  std::vector<ChunkLocation> & locations,
+                                  std::vector<size_t> & offsets) const
+{
+    std::vector<LonLat> lonLats;
+    lonLats.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        lonLats.push_back(LonLat(points[i]));
     }
+    getOverlapSubChunks(lonLats.data(), n, locations, offsets);
 }
 
 std::vector<int32_t> Chunker::getAllChunks() const {
@@ -282,24 +607,88 @@ std::vector<int32_t> Chunker::getAllSubChunks(int32_t chunkId) const {
     return subChunkIds;
 }
 
-Box Chunker::_getChunkBoundingBox(int32_t stripe, int32_t chunk) const {
-    Angle chunkWidth = _stripes[stripe].chunkWidth;
-    NormalizedAngleInterval lon(chunkWidth * chunk,
-                                chunkWidth * (chunk + 1));
-    int32_t ss = stripe * _numSubStripesPerStripe;
-    int32_t ssEnd = ss + _numSubStripesPerStripe;
-    AngleInterval lat(ss * _subStripeHeight - Angle(0.5 * PI),
-                      ssEnd * _subStripeHeight - Angle(0.5 * PI));
-    return Box(lon, lat).dilatedBy(Angle(BOX_EPSILON));
-}
-
-Box Chunker::_getSubChunkBoundingBox(int32_t subStripe, int32_t subChunk) const {
-    Angle subChunkWidth = _subStripes[subStripe].subChunkWidth;
-    NormalizedAngleInterval lon(subChunkWidth * subChunk,
-                                subChunkWidth * (subChunk + 1));
-    AngleInterval lat(subStripe * _subStripeHeight - Angle(0.5 * PI),
-                      (subStripe + 1) * _subStripeHeight - Angle(0.5 * PI));
-    return Box(lon, lat).dilatedBy(Angle(BOX_EPSILON));
+void Chunker::_getOverlapSubChunks(
+    LonLat const & p,
+    std::vector<ChunkLocation> & locations) const
+{
+    size_t const begin = locations.size();
+    int32_t minSS, maxSS;
+    _getOverlapSubStripes(p.getLat(), minSS, maxSS);
+    for (int32_t ss = minSS; ss <= maxSS; ++ss) {
+        int32_t const s = ss / _numSubStripesPerStripe;
+        SubStripe const & subStripe = _subStripes[ss];
+        int32_t const nsc = subStripe.numSubChunksPerChunk;
+        int32_t const n = _stripes[s].numChunksPerStripe * nsc;
+        int32_t sca, scb;
+        getOverlapRange(p.getLon(), subStripe.subChunkWidth,
+                        subStripe.overlapHalfWidth, n, sca, scb);
+        for (int32_t sc = sca; sc <= scb; ++sc) {
+            int32_t const x = wrap(sc, n);
+            int32_t const c = x / nsc;
+            locations.push_back(ChunkLocation(
+                _getChunkId(s, c), _getSubChunkId(s, ss, c, x)));
+        }
+    }
+    std::sort(locations.begin() + begin, locations.end(),
+              [](ChunkLocation const & a, ChunkLocation const & b) {
+                  return a.chunkId < b.chunkId ||
+                         (a.chunkId == b.chunkId &&
+                          a.subChunkId < b.subChunkId);
+              });
+}
+
+void Chunker::_getOverlapSubStripes(Angle lat,
+                                    int32_t & minSS,
+                                    int32_t & maxSS) const
+{
+    // The overlap bounds of sub-stripe ss span latitudes
+    // [ss*h - R, (ss + 1)*h + R], where h is the sub-stripe height and R
+    // is the overlap radius.
+    if (lat.isNan()) {
+        throw std::invalid_argument("Cannot locate a NaN point");
+    }
+    Angle y = lat + Angle(0.5 * PI);
+    double ya = std::ceil((y - _overlap) / _subStripeHeight) - 1.0;
+    double yb = std::floor((y + _overlap) / _subStripeHeight);
+    minSS = std::min(std::max(static_cast<int32_t>(ya), 0),
+                     _numSubStripes - 1);
+    maxSS = std::min(std::max(static_cast<int32_t>(yb), 0),
+                     _numSubStripes - 1);
+}
+
+template <typename SubChunkSink>
+void Chunker::_appendAllSubChunks(SubChunkSink & sink, int32_t stripe) const {
+    // All chunks in a stripe have the same sub-chunk IDs.
+    int32_t const ssBeg = stripe * _numSubStripesPerStripe;
+    int32_t const ssEnd = ssBeg + _numSubStripesPerStripe;
+    for (int32_t ss = ssBeg; ss < ssEnd; ++ss) {
+        int32_t const nsc = _subStripes[ss].numSubChunksPerChunk;
+        if (nsc > 0) {
+            int32_t const subChunkIdBase =
+                _maxSubChunksPerSubStripeChunk * (ss - ssBeg);
+            sink.append(subChunkIdBase, subChunkIdBase + nsc);
+        }
+    }
+}
+
+Box Chunker::_getChunkBoundingBox(int32_t stripe,
+                                  int32_t minChunk,
+                                  int32_t maxChunk) const
+{
+    Stripe const & s = _stripes[stripe];
+    NormalizedAngleInterval lon(s.chunkWidth * minChunk,
+                                s.chunkWidth * (maxChunk + 1));
+    return Box(lon.dilatedBy(s.boxHalfWidth), s.boxLat);
+}
+
+Box Chunker::_getSubChunkBoundingBox(int32_t subStripe,
+                                     int32_t minSubChunk,
+                                     int32_t maxSubChunk) const
+{
+    SubStripe const & ss = _subStripes[subStripe];
+    NormalizedAngleInterval lon(ss.subChunkWidth * minSubChunk,
+                                ss.subChunkWidth * (maxSubChunk + 1));
+    return Box(lon.dilatedBy(ss.boxHalfWidth), ss.boxLat);
 }
 
 }} // namespace lsst::sphgeom
@@ -25,6 +25,7 @@
 
 #include "lsst/sphgeom/Circle.h"
 
+#include <limits>
 #include <ostream>
 #include <stdexcept>
 
@@ -34,6 +35,8 @@
 #include "lsst/sphgeom/Ellipse.h"
 #include "lsst/sphgeom/codec.h"
 
+#include "ContainsImpl.h"
+
 
 namespace lsst {
 namespace sphgeom {
@@ -265,6 +268,39 @@ Box3d Circle::getBoundingBox3d() const {
     return Box3d(e[0], e[1], e[2]);
 }
 
+void Circle::contains(double const * x,
+                      double const * y,
+                      double const * z,
+                      size_t n,
+                      uint64_t * result) const
+{
+    auto pointTest = [this](UnitVector3d const & v) { return contains(v); };
+#if defined(NO_SIMD) || !defined(__x86_64__)
+    detail::containsBatch(x, y, z, n, result, pointTest);
+#else
+    // Compute squared chord lengths exactly as the single-point test does,
+    // two vectors at a time. A full circle contains every unit vector, even
+    // those with a computed squared chord length slightly above 4.
+    __m128d const cx = _mm_set1_pd(_center.x());
+    __m128d const cy = _mm_set1_pd(_center.y());
+    __m128d const cz = _mm_set1_pd(_center.z());
+    __m128d const cl = _mm_set1_pd(
+        isFull() ? std::numeric_limits<double>::infinity() :
+                   _squaredChordLength);
+    detail::containsBatch(x, y, z, n, result,
+        [=](__m128d vx, __m128d vy, __m128d vz) {
+            __m128d dx = _mm_sub_pd(vx, cx);
+            __m128d dy = _mm_sub_pd(vy, cy);
+            __m128d dz = _mm_sub_pd(vz, cz);
+            __m128d d = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx),
+                                              _mm_mul_pd(dy, dy)),
+                                   _mm_mul_pd(dz, dz));
+            return _mm_movemask_pd(_mm_cmple_pd(d, cl));
+        },
+        pointTest);
+#endif
+}
+
 Relationship Circle::relate(UnitVector3d const & v) const {
     if (contains(v)) {
         return CONTAINS;
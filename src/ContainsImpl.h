@@ -0,0 +1,106 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_SPHGEOM_CONTAINSIMPL_H_
+#define LSST_SPHGEOM_CONTAINSIMPL_H_
+
+/// \file
+/// \brief This file contains helpers for implementing the batch form of
+///        Region::contains.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#if !defined(NO_SIMD) && defined(__x86_64__)
+    #include <x86intrin.h>
+#endif
+
+#include "lsst/sphgeom/UnitVector3d.h"
+
+
+namespace lsst {
+namespace sphgeom {
+namespace detail {
+
+// `containsBatch` evaluates a point-in-region predicate for the n unit
+// vectors with components x[i], y[i] and z[i], and packs the results into
+// `result`, least significant bit first. Bits of the last result word that
+// do not correspond to an input vector are cleared.
+template <typename PointTest>
+void containsBatch(double const * x,
+                   double const * y,
+                   double const * z,
+                   size_t n,
+                   uint64_t * result,
+                   PointTest pointTest)
+{
+    for (size_t i = 0; i < n; i += 64, ++result) {
+        size_t m = std::min<size_t>(n - i, 64);
+        uint64_t bits = 0;
+        for (size_t j = 0; j < m; ++j) {
+            UnitVector3d v = UnitVector3d::fromNormalized(
+                x[i + j], y[i + j], z[i + j]);
+            bits |= static_cast<uint64_t>(pointTest(v)) << j;
+        }
+        *result = bits;
+    }
+}
+
+#if !defined(NO_SIMD) && defined(__x86_64__)
+
+// This `containsBatch` overload processes vectors in pairs with `pairTest`,
+// which is passed the components of 2 unit vectors and must return a 2 bit
+// mask (e.g. as obtained from _mm_movemask_pd). If n is odd, the last vector
+// is passed to `pointTest`.
+template <typename PairTest, typename PointTest>
+void containsBatch(double const * x,
+                   double const * y,
+                   double const * z,
+                   size_t n,
+                   uint64_t * result,
+                   PairTest pairTest,
+                   PointTest pointTest)
+{
+    for (size_t i = 0; i < n; i += 64, ++result) {
+        size_t m = std::min<size_t>(n - i, 64);
+        uint64_t bits = 0;
+        size_t j = 0;
+        for (; j + 2 <= m; j += 2) {
+            int mask = pairTest(_mm_loadu_pd(x + i + j),
+                                _mm_loadu_pd(y + i + j),
+                                _mm_loadu_pd(z + i + j));
+            bits |= static_cast<uint64_t>(mask) << j;
+        }
+        if (j < m) {
+            UnitVector3d v = UnitVector3d::fromNormalized(
+                x[i + j], y[i + j], z[i + j]);
+            bits |= static_cast<uint64_t>(pointTest(v)) << j;
+        }
+        *result = bits;
+    }
+}
+
+#endif
+
+}}} // namespace lsst::sphgeom::detail
+
+#endif // LSST_SPHGEOM_CONTAINSIMPL_H_
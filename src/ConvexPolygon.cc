@@ -31,6 +31,7 @@
 #include "lsst/sphgeom/codec.h"
 #include "lsst/sphgeom/orientation.h"
 
+#include "ContainsImpl.h"
 #include "ConvexPolygonImpl.h"
 
 
@@ -256,6 +257,25 @@ ConvexPolygon::ConvexPolygon(std::vector<UnitVector3d> const & points) :
     _vertices(points)
 {
     computeHull(_vertices);
+    _computeCache();
+}
+
+void ConvexPolygon::_computeCache() {
+    size_t const n = _vertices.size();
+    _edgeNormals.clear();
+    _robustEdgeNormals.clear();
+    _edgeNormals.reserve(n);
+    _robustEdgeNormals.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        UnitVector3d const & a = _vertices[i];
+        UnitVector3d const & b = _vertices[i + 1 == n ? 0 : i + 1];
+        _edgeNormals.push_back(a.cross(b));
+        _robustEdgeNormals.push_back(a.robustCross(b));
+    }
+    _boundingCircle = detail::boundingCircle(_vertices.begin(),
+                                             _vertices.end());
+    _boundingBox3d = detail::boundingBox3d(_vertices.begin(),
+                                           _vertices.end());
 }
 
 bool ConvexPolygon::operator==(ConvexPolygon const & p) const {
@@ -297,20 +317,98 @@ UnitVector3d ConvexPolygon::getCentroid() const {
     return detail::centroid(_vertices.begin(), _vertices.end());
 }
 
-Circle ConvexPolygon::getBoundingCircle() const {
-    return detail::boundingCircle(_vertices.begin(), _vertices.end());
-}
-
 Box ConvexPolygon::getBoundingBox() const {
     return detail::boundingBox(_vertices.begin(), _vertices.end());
 }
 
-Box3d ConvexPolygon::getBoundingBox3d() const {
-    return detail::boundingBox3d(_vertices.begin(), _vertices.end());
+bool ConvexPolygon::contains(UnitVector3d const & v) const {
+    if (!_boundingBox3d.contains(v)) {
+        return false;
+    }
+    return detail::contains(_vertices.begin(), _vertices.end(),
+                            _edgeNormals.data(), v);
 }
 
-bool ConvexPolygon::contains(UnitVector3d const & v) const {
-    return detail::contains(_vertices.begin(), _vertices.end(), v);
+void ConvexPolygon::contains(double const * x,
+                             double const * y,
+                             double const * z,
+                             size_t n,
+                             uint64_t * result) const
+{
+    auto pointTest = [this](UnitVector3d const & v) { return contains(v); };
+#if defined(NO_SIMD) || !defined(__x86_64__)
+    detail::containsBatch(x, y, z, n, result, pointTest);
+#else
+    // A unit vector v is inside this polygon iff orientation(v, a, b) ≥ 0
+    // for every edge (a, b). The first stage of orientation() computes the
+    // determinant v · (a × b) and compares it to a fixed error bound. The
+    // cached edge normals are computed in the same way, so that the
+    // determinants below are bit-identical to the ones it computes.
+    // Vectors for which some determinant is within the error bound of 0
+    // are handed to the exact single-point test. Normal components are
+    // broadcast straight from the cached normals, so no per-call buffer is
+    // needed.
+    //
+    // As in the single-point test, lanes outside the bounding box are
+    // rejected before any determinant is computed, and the edge loop stops
+    // as soon as both lanes are known to be outside.
+    Vector3d const * const normalsBegin = _edgeNormals.data();
+    Vector3d const * const normalsEnd = normalsBegin + _edgeNormals.size();
+    __m128d const upper = _mm_set1_pd(detail::MAX_ORIENTATION_ERROR);
+    __m128d const lower = _mm_set1_pd(-detail::MAX_ORIENTATION_ERROR);
+    __m128d const xa = _mm_set1_pd(_boundingBox3d.x().getA());
+    __m128d const xb = _mm_set1_pd(_boundingBox3d.x().getB());
+    __m128d const ya = _mm_set1_pd(_boundingBox3d.y().getA());
+    __m128d const yb = _mm_set1_pd(_boundingBox3d.y().getB());
+    __m128d const za = _mm_set1_pd(_boundingBox3d.z().getA());
+    __m128d const zb = _mm_set1_pd(_boundingBox3d.z().getB());
+    detail::containsBatch(x, y, z, n, result,
+        [&](__m128d vx, __m128d vy, __m128d vz) {
+            __m128d inBox = _mm_and_pd(
+                _mm_and_pd(_mm_and_pd(_mm_cmpge_pd(vx, xa),
+                                      _mm_cmple_pd(vx, xb)),
+                           _mm_and_pd(_mm_cmpge_pd(vy, ya),
+                                      _mm_cmple_pd(vy, yb))),
+                _mm_and_pd(_mm_cmpge_pd(vz, za), _mm_cmple_pd(vz, zb)));
+            int out = 3 & ~_mm_movemask_pd(inBox);
+            if (out == 3) {
+                return 0;
+            }
+            // Lanes that are definitely outside the polygon.
+            __m128d outside = _mm_setzero_pd();
+            // Lanes that may be on the boundary of the polygon.
+            __m128d uncertain = _mm_setzero_pd();
+            for (Vector3d const * e = normalsBegin; e != normalsEnd; ++e) {
+                __m128d d = _mm_add_pd(
+                    _mm_add_pd(_mm_mul_pd(vx, _mm_set1_pd(e->x())),
+                               _mm_mul_pd(vy, _mm_set1_pd(e->y()))),
+                    _mm_mul_pd(vz, _mm_set1_pd(e->z())));
+                outside = _mm_or_pd(outside, _mm_cmplt_pd(d, lower));
+                uncertain = _mm_or_pd(uncertain, _mm_cmple_pd(d, upper));
+                if ((out | _mm_movemask_pd(outside)) == 3) {
+                    return 0;
+                }
+            }
+            out |= _mm_movemask_pd(outside);
+            int unknown = _mm_movemask_pd(uncertain) & ~out;
+            int mask = 3 & ~(out | unknown);
+            if (unknown != 0) {
+                double px[2], py[2], pz[2];
+                _mm_storeu_pd(px, vx);
+                _mm_storeu_pd(py, vy);
+                _mm_storeu_pd(pz, vz);
+                for (int lane = 0; lane < 2; ++lane) {
+                    if ((unknown & (1 << lane)) != 0 &&
+                        contains(UnitVector3d::fromNormalized(
+                            px[lane], py[lane], pz[lane]))) {
+                        mask |= 1 << lane;
+                    }
+                }
+            }
+            return mask;
+        },
+        pointTest);
+#endif
 }
 
 Relationship ConvexPolygon::relate(Box const & b) const {
@@ -318,7 +416,11 @@ Relationship ConvexPolygon::relate(Box const & b) const {
 }
 
 Relationship ConvexPolygon::relate(Circle const & c) const {
-    return detail::relate(_vertices.begin(), _vertices.end(), c);
+    if (!c.isEmpty() && _boundingCircle.isDisjointFrom(c)) {
+        return DISJOINT;
+    }
+    return detail::relate(_vertices.begin(), _vertices.end(), c,
+                          _robustEdgeNormals.data());
 }
 
 Relationship ConvexPolygon::relate(ConvexPolygon const & p) const {
@@ -326,6 +428,10 @@ Relationship ConvexPolygon::relate(ConvexPolygon const & p) const {
 }
 
 Relationship ConvexPolygon::relate(Ellipse const & e) const {
+    if (!e.isEmpty() &&
+        _boundingCircle.isDisjointFrom(e.getBoundingCircle())) {
+        return DISJOINT;
+    }
     return detail::relate(_vertices.begin(), _vertices.end(), e);
 }
 
@@ -360,6 +466,7 @@ std::unique_ptr<ConvexPolygon> ConvexPolygon::decode(uint8_t const * buffer,
             decodeDouble(buffer + 16)
         ));
     }
+    poly->_computeCache();
     return poly;
 }
 
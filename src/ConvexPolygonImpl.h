@@ -32,10 +32,16 @@
 /// a spherical region use them to avoid the cost of creating ConvexPolygon
 /// objects for each triangle/quad.
 
+#include <cmath>
+#include <iterator>
+#include <vector>
+
 #include "lsst/sphgeom/Box.h"
 #include "lsst/sphgeom/Box3d.h"
 #include "lsst/sphgeom/Circle.h"
+#include "lsst/sphgeom/ConvexPolygon.h"
 #include "lsst/sphgeom/Ellipse.h"
+#include "lsst/sphgeom/Matrix3d.h"
 #include "lsst/sphgeom/orientation.h"
 #include "lsst/sphgeom/utils.h"
 
@@ -44,6 +50,11 @@ namespace lsst {
 namespace sphgeom {
 namespace detail {
 
+// `MAX_ORIENTATION_ERROR` is the absolute error bound used by the first
+// stage of orientation(). If |a · (b × c)| exceeds it, the sign of the
+// floating point determinant is the orientation of (a, b, c).
+double const MAX_ORIENTATION_ERROR = 1.7e-15;
+
 template <typename VertexIterator>
 UnitVector3d centroid(VertexIterator const begin, VertexIterator const end) {
     // The center of mass is obtained via trivial generalization of
@@ -254,6 +265,49 @@ bool contains(VertexIterator const begin,
     return true;
 }
 
+// `contains` tests whether v is inside the polygon with vertices
+// [begin, end) and edge normals [normals, normals + (end - begin)), as
+// returned by ConvexPolygon::getEdgeNormals(). The determinant computed by
+// the first stage of orientation() is v · nᵢ, so orientation() only needs to
+// be called when that dot product is within its error bound of zero.
+template <typename VertexIterator>
+bool contains(VertexIterator const begin,
+              VertexIterator const end,
+              Vector3d const * normals,
+              UnitVector3d const & v)
+{
+    for (VertexIterator i = begin; i != end; ++i, ++normals) {
+        double d = v.dot(*normals);
+        if (d < -MAX_ORIENTATION_ERROR) {
+            return false;
+        }
+        if (d <= MAX_ORIENTATION_ERROR) {
+            VertexIterator j = std::next(i);
+            if (orientation(v, *i, j == end ? *begin : *j) < 0) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// `isOutside` returns true if all the vertices in [begin, end) are
+// conclusively on the negative side of the plane with normal n = a × b.
+// When n is the normal of an edge (a, b) of a convex polygon and [begin, end)
+// are the vertices of another, the two polygons are then disjoint.
+template <typename VertexIterator>
+bool isOutside(VertexIterator const begin,
+               VertexIterator const end,
+               Vector3d const & n)
+{
+    for (VertexIterator v = begin; v != end; ++v) {
+        if (v->dot(n) >= -MAX_ORIENTATION_ERROR) {
+            return false;
+        }
+    }
+    return true;
+}
+
 template <typename VertexIterator>
 Relationship relate(VertexIterator const begin,
                     VertexIterator const end,
@@ -263,10 +317,14 @@ Relationship relate(VertexIterator const begin,
     return boundingBox(begin, end).relate(b) & (DISJOINT | WITHIN);
 }
 
+// If `normals` is not null, it must point to the robustCross() edge normals
+// of the polygon, where normals[i] is the normal of the edge from
+// vertex i to vertex i + 1.
 template <typename VertexIterator>
 Relationship relate(VertexIterator const begin,
                     VertexIterator const end,
-                    Circle const & c)
+                    Circle const & c,
+                    Vector3d const * normals = nullptr)
 {
     if (c.isEmpty()) {
         return CONTAINS | DISJOINT;
@@ -297,7 +355,7 @@ Relationship relate(VertexIterator const begin,
         // All polygon vertices are inside c. Look for points in the polygon
         // edge interiors that are outside c.
         for (VertexIterator a = std::prev(end), b = begin; b != end; a = b, ++b) {
-            Vector3d n = a->robustCross(*b);
+            Vector3d n = normals ? normals[a - begin] : a->robustCross(*b);
             double d = getMaxSquaredChordLength(c.getCenter(), *a, *b, n);
             if (d > c.getSquaredChordLength() -
                     MAX_SQUARED_CHORD_LENGTH_ERROR) {
@@ -316,7 +374,7 @@ Relationship relate(VertexIterator const begin,
     // All polygon vertices are outside c. Look for points in the polygon edge
     // interiors that are inside c.
     for (VertexIterator a = std::prev(end), b = begin; b != end; a = b, ++b) {
-        Vector3d n = a->robustCross(*b);
+        Vector3d n = normals ? normals[a - begin] : a->robustCross(*b);
         double d = getMinSquaredChordLength(c.getCenter(), *a, *b, n);
         if (d < c.getSquaredChordLength() + MAX_SQUARED_CHORD_LENGTH_ERROR) {
             return INTERSECTS;
@@ -331,6 +389,34 @@ Relationship relate(VertexIterator const begin,
     return DISJOINT;
 }
 
+// `edgesCross` considers all possible pairs of edges from two polygons, and
+// returns true if it finds a non-degenerate edge crossing.
+template <typename VertexIterator1,
+          typename VertexIterator2>
+bool edgesCross(VertexIterator1 const begin1,
+                VertexIterator1 const end1,
+                VertexIterator2 const begin2,
+                VertexIterator2 const end2)
+{
+    for (VertexIterator1 a = std::prev(end1), b = begin1;
+         b != end1; a = b, ++b) {
+        for (VertexIterator2 c = std::prev(end2), d = begin2;
+             d != end2; c = d, ++d) {
+            int acd = orientation(*a, *c, *d);
+            int bdc = orientation(*b, *d, *c);
+            if (acd == bdc && acd != 0) {
+                int cba = orientation(*c, *b, *a);
+                int dab = orientation(*d, *a, *b);
+                if (cba == dab && cba == acd) {
+                    // Found a non-degenerate edge crossing
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
 template <typename VertexIterator1,
           typename VertexIterator2>
 Relationship relate(VertexIterator1 const begin1,
@@ -369,33 +455,227 @@ Relationship relate(VertexIterator1 const begin1,
         // The polygons have at least one point in common.
         return INTERSECTS;
     }
-    // No vertex of either polygon is inside the other. Consider all
-    // possible edge pairs and look for a crossing.
-    for (VertexIterator1 a = std::prev(end1), b = begin1;
-         b != end1; a = b, ++b) {
-        for (VertexIterator2 c = std::prev(end2), d = begin2;
-             d != end2; c = d, ++d) {
-            int acd = orientation(*a, *c, *d);
-            int bdc = orientation(*b, *d, *c);
-            if (acd == bdc && acd != 0) {
-                int cba = orientation(*c, *b, *a);
-                int dab = orientation(*d, *a, *b);
-                if (cba == dab && cba == acd) {
-                    // Found a non-degenerate edge crossing
-                    return INTERSECTS;
-                }
-            }
+    // No vertex of either polygon is inside the other.
+    return edgesCross(begin1, end1, begin2, end2) ? INTERSECTS : DISJOINT;
+}
+
+// This overload is used to relate HTM triangles and Q3C quads to polygons
+// during pixel index traversal, and takes advantage of the edge normals
+// cached by `p`. It returns the same results as the generic version above.
+template <typename VertexIterator>
+Relationship relate(VertexIterator const begin,
+                    VertexIterator const end,
+                    ConvexPolygon const & p)
+{
+    typedef std::vector<UnitVector3d>::const_iterator PolygonIterator;
+    PolygonIterator const pbegin = p.getVertices().begin();
+    PolygonIterator const pend = p.getVertices().end();
+    std::vector<Vector3d> const & pnormals = p.getEdgeNormals();
+    // Most pixels examined during a traversal are far from the polygon
+    // boundary, and are disjoint from it. Look for a separating edge plane
+    // before resorting to vertex containment tests.
+    for (Vector3d const & n: pnormals) {
+        if (isOutside(begin, end, n)) {
+            return DISJOINT;
         }
     }
-    return DISJOINT;
+    for (VertexIterator a = std::prev(end), b = begin; b != end; a = b, ++b) {
+        if (isOutside(pbegin, pend, a->cross(*b))) {
+            return DISJOINT;
+        }
+    }
+    bool all1 = true;
+    bool any1 = false;
+    bool all2 = true;
+    bool any2 = false;
+    for (VertexIterator i = begin; i != end; ++i) {
+        bool b = contains(pbegin, pend, pnormals.data(), *i);
+        all1 = b && all1;
+        any1 = b || any1;
+    }
+    for (PolygonIterator j = pbegin; j != pend; ++j) {
+        bool b = contains(begin, end, *j);
+        all2 = b && all2;
+        any2 = b || any2;
+    }
+    if (all1 || all2) {
+        return (all1 ? WITHIN : INTERSECTS) | (all2 ? CONTAINS : INTERSECTS);
+    }
+    if (any1 || any2) {
+        return INTERSECTS;
+    }
+    return edgesCross(begin, end, pbegin, pend) ? INTERSECTS : DISJOINT;
+}
+
+// `EllipseCone` is the representation of an Ellipse used to relate it to
+// polygons. The boundary of an ellipse that is neither empty nor full is the
+// intersection of S² with the elliptical cone (Eq. 3 in Ellipse.h):
+//
+//     x² tan²a + y² tan²b - z² = 0,    where (x, y, z) = S v
+//
+// The linear map T = diag(±|tan a|, |tan b|, 1) S, with the sign chosen so
+// that det T > 0, takes this cone to the circular cone with opening angle
+// π/4 about the z axis. Invertible linear maps take planes through the
+// origin to planes through the origin, and maps with positive determinant
+// preserve orientation, so T takes a convex polygon to a convex polygon with
+// the same relationship to the circle T(e) as the original has to e.
+// Relating polygons to ellipses therefore reduces to relating the polygons
+// with vertices T vᵢ/‖T vᵢ‖ to a circle, which unlike the bounding circle
+// of the ellipse is tight even for very elongated ellipses.
+//
+// Rounding errors in the computation of T and T vᵢ are accounted for by
+// relating polygons to circles with opening angles π/4 ± m, where the margin
+// m grows with the condition number of T. Ellipses that are close to great
+// circles, for which m is too large to be useful, are related to polygons
+// via their bounding circles instead.
+class EllipseCone {
+public:
+    explicit EllipseCone(Ellipse const & e) :
+        _empty(e.isEmpty()),
+        _full(e.isFull()),
+        _valid(false),
+        _large(e.getAlpha().asRadians() > 0.5 * PI),
+        _boundingCircle(e.getBoundingCircle())
+    {
+        if (_empty || _full) {
+            return;
+        }
+        double const a = e.getAlpha().asRadians() - 0.5 * PI;
+        double const b = e.getBeta().asRadians() - 0.5 * PI;
+        double const tana = std::fabs(std::tan(a));
+        double const tanb = std::fabs(std::tan(b));
+        double const mintan = std::min(std::min(tana, tanb), 1.0);
+        if (!(mintan > 0.0) || !std::isfinite(tana) || !std::isfinite(tanb)) {
+            return;
+        }
+        Matrix3d const & S = e.getTransformMatrix();
+        Vector3d s0 = S.getRow(0);
+        Vector3d const s1 = S.getRow(1);
+        Vector3d const s2 = S.getRow(2);
+        double const sign = s0.dot(s1.cross(s2)) < 0.0 ? -1.0 : 1.0;
+        s0 *= sign * tana;
+        _transform = Matrix3d(s0.x(), s0.y(), s0.z(),
+                              tanb * s1.x(), tanb * s1.y(), tanb * s1.z(),
+                              s2.x(), s2.y(), s2.z());
+        _inverse = Matrix3d(S(0,0) * sign / tana, S(1,0) / tanb, S(2,0),
+                            S(0,1) * sign / tana, S(1,1) / tanb, S(2,1),
+                            S(0,2) * sign / tana, S(1,2) / tanb, S(2,2));
+        // The error in a component of T v is a small multiple of ε times the
+        // norm of the corresponding row of T, and ‖T v‖ is at least the
+        // smallest singular value of T, so the angular error in T v/‖T v‖ is
+        // bounded by a small multiple of ε times the condition number of T.
+        // The same bound applies to the inverse map. The semi-axis angles of
+        // the ellipse are only available as α and β, so |tan a| and |tan b|
+        // must be recomputed from them. The relative error in the results is
+        // at most about 2 ulp(π/2) / |sin 2a|, and perturbs the angular radius
+        // of T(e) by no more than that.
+        double const cond = std::sqrt(tana * tana + tanb * tanb + 1.0) / mintan;
+        double const tanError = 1.0e-15 * (1.0 / std::fabs(std::sin(2.0 * a)) +
+                                           1.0 / std::fabs(std::sin(2.0 * b)));
+        _margin = 4.0 * (1.0e-15 * cond + tanError) + 1.0e-14;
+        if (!(_margin < 0.01)) {
+            return;
+        }
+        UnitVector3d const axis = _large ? -UnitVector3d::Z() : UnitVector3d::Z();
+        _inner = Circle(axis, Angle(0.25 * PI - _margin));
+        _outer = Circle(axis, Angle(0.25 * PI + _margin));
+        _valid = true;
+    }
+
+    bool isEmpty() const { return _empty; }
+    bool isFull() const { return _full; }
+
+    // `isLarge` returns true if the ellipse is larger than a hemisphere.
+    bool isLarge() const { return _large; }
+
+    // `isValid` returns false if polygons are related to the ellipse via its
+    // bounding circle.
+    bool isValid() const { return _valid; }
+
+    // `getMargin` returns the margin m described above.
+    double getMargin() const { return _margin; }
+
+    UnitVector3d transform(UnitVector3d const & v) const {
+        return UnitVector3d(_transform * v);
+    }
+
+    UnitVector3d inverseTransform(Vector3d const & w) const {
+        return UnitVector3d(_inverse * w);
+    }
+
+    // `relate` computes the relationship between the polygon with
+    // the given vertices and the ellipse.
+    template <typename VertexIterator>
+    Relationship relate(VertexIterator const begin,
+                        VertexIterator const end) const;
+
+private:
+    bool _empty;
+    bool _full;
+    bool _valid;
+    bool _large;
+    double _margin;
+    Matrix3d _transform;
+    Matrix3d _inverse;
+    Circle _inner;
+    Circle _outer;
+    Circle _boundingCircle;
+};
+
+template <typename VertexIterator>
+Relationship EllipseCone::relate(VertexIterator const begin,
+                                 VertexIterator const end) const
+{
+    if (_empty) {
+        return CONTAINS | DISJOINT;
+    }
+    if (_full) {
+        return WITHIN;
+    }
+    if (!_valid) {
+        return detail::relate(begin, end, _boundingCircle) &
+               (CONTAINS | DISJOINT);
+    }
+    // Transform the polygon vertices. Pixels have at most 4 vertices, so
+    // avoid heap allocation for small polygons.
+    static size_t const BUFFER_SIZE = 8;
+    size_t const n = static_cast<size_t>(std::distance(begin, end));
+    UnitVector3d buffer[BUFFER_SIZE];
+    std::vector<UnitVector3d> vertices;
+    UnitVector3d * w = buffer;
+    if (n > BUFFER_SIZE) {
+        vertices.resize(n);
+        w = vertices.data();
+    }
+    UnitVector3d * i = w;
+    for (VertexIterator v = begin; v != end; ++v, ++i) {
+        *i = transform(*v);
+    }
+    // The inner circle is contained in T(e) or its complement, and the
+    // outer circle contains it.
+    Relationship outer = detail::relate(w, w + n, _outer);
+    if (!_large) {
+        if ((outer & DISJOINT) != 0) {
+            return DISJOINT;
+        }
+        Relationship inner = detail::relate(w, w + n, _inner);
+        return (outer & CONTAINS) | (inner & WITHIN);
+    }
+    // The ellipse is the closure of the complement of the circular cone
+    // about -z. A convex polygon cannot contain it.
+    Relationship r = (outer & DISJOINT) != 0 ? WITHIN : Relationship();
+    if ((detail::relate(w, w + n, _inner) & WITHIN) != 0) {
+        r |= DISJOINT;
+    }
+    return r;
 }
 
 template <typename VertexIterator>
 Relationship relate(VertexIterator const begin,
                     VertexIterator const end,
-                    ConvexPolygon const & p)
+                    EllipseCone const & e)
 {
-    return relate(begin, end, p.getVertices().begin(), p.getVertices().end());
+    return e.relate(begin, end);
 }
 
 template <typename VertexIterator>
@@ -403,7 +683,7 @@ Relationship relate(VertexIterator const begin,
                     VertexIterator const end,
                     Ellipse const & e)
 {
-    return relate(begin, end, e.getBoundingCircle()) & (CONTAINS | DISJOINT);
+    return EllipseCone(e).relate(begin, end);
 }
 
 }}} // namespace lsst::sphgeom::detail
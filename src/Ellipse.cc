@@ -26,6 +26,7 @@
 #include "lsst/sphgeom/Ellipse.h"
 
 #include <cmath>
+#include <memory>
 #include <ostream>
 #include <stdexcept>
 
@@ -35,10 +36,81 @@
 #include "lsst/sphgeom/ConvexPolygon.h"
 #include "lsst/sphgeom/codec.h"
 
+#include "ContainsImpl.h"
+#include "ConvexPolygonImpl.h"
+
 
 namespace lsst {
 namespace sphgeom {
 
+namespace {
+
+// `approximatingPolygon` returns a convex polygon that contains the ellipse
+// corresponding to `cone` if `outer` is true, and that is contained in it
+// otherwise. The polygon is the inverse image under T (see detail::EllipseCone)
+// of a regular polygon circumscribed about or inscribed in a circle that is
+// slightly larger or smaller than T(e). A null pointer is returned if the
+// ellipse cannot be approximated in this way.
+std::unique_ptr<ConvexPolygon> approximatingPolygon(
+    detail::EllipseCone const & cone,
+    bool outer)
+{
+    static int const numVertices = 16;
+    std::unique_ptr<ConvexPolygon> polygon;
+    if (!cone.isValid() || cone.isLarge()) {
+        return polygon;
+    }
+    double r;
+    if (outer) {
+        r = std::tan(0.25 * PI + cone.getMargin()) /
+            std::cos(PI / numVertices);
+    } else {
+        r = std::tan(0.25 * PI - cone.getMargin());
+    }
+    std::vector<UnitVector3d> points;
+    points.reserve(numVertices);
+    for (int i = 0; i < numVertices; ++i) {
+        double phi = (2.0 * PI * i) / numVertices;
+        points.push_back(cone.inverseTransform(
+            Vector3d(r * std::cos(phi), r * std::sin(phi), 1.0)));
+    }
+    // Computing the convex hull guards against rounding errors in the
+    // vertices, which could otherwise produce a slightly non-convex polygon
+    // for very elongated ellipses.
+    try {
+        polygon.reset(new ConvexPolygon(points));
+    } catch (std::invalid_argument const &) {
+        polygon.reset();
+    }
+    return polygon;
+}
+
+} // unnamed namespace
+
+struct Ellipse::Approximations {
+    explicit Approximations(Ellipse const & e) {
+        detail::EllipseCone const cone(e);
+        outer = approximatingPolygon(cone, true);
+        inner = approximatingPolygon(cone, false);
+    }
+
+    // Null if the ellipse cannot be approximated by polygons.
+    std::unique_ptr<ConvexPolygon> outer;
+    std::unique_ptr<ConvexPolygon> inner;
+};
+
+Ellipse::Approximations const & Ellipse::_getApproximations() const {
+    // Concurrent first calls may each compute the polygons, but they all
+    // compute the same ones, and only one result is kept.
+    std::shared_ptr<Approximations const> a =
+        std::atomic_load(&_approximations);
+    if (!a) {
+        a = std::make_shared<Approximations const>(*this);
+        std::atomic_store(&_approximations, a);
+    }
+    return *a;
+}
+
 Ellipse::Ellipse(UnitVector3d const & f1, UnitVector3d const & f2, Angle alpha) :
     _a(alpha.asRadians() - 0.5 * PI)
 {
@@ -187,6 +259,77 @@ bool Ellipse::contains(UnitVector3d const & v) const {
     }
 }
 
+void Ellipse::contains(double const * x,
+                       double const * y,
+                       double const * z,
+                       size_t n,
+                       uint64_t * result) const
+{
+    auto pointTest = [this](UnitVector3d const & v) { return contains(v); };
+#if defined(NO_SIMD) || !defined(__x86_64__)
+    detail::containsBatch(x, y, z, n, result, pointTest);
+#else
+    // This performs the same computation as the single-point test, with
+    // branches replaced by lane selection.
+    UnitVector3d const c = getCenter();
+    __m128d const cx = _mm_set1_pd(c.x());
+    __m128d const cy = _mm_set1_pd(c.y());
+    __m128d const cz = _mm_set1_pd(c.z());
+    __m128d m[3][3];
+    for (int r = 0; r < 3; ++r) {
+        for (int k = 0; k < 3; ++k) {
+            m[r][k] = _mm_set1_pd(_S(r, k));
+        }
+    }
+    __m128d const tana = _mm_set1_pd(_tana);
+    __m128d const tanb = _mm_set1_pd(_tanb);
+    __m128d const half = _mm_set1_pd(0.5);
+    __m128d const minusHalf = _mm_set1_pd(-0.5);
+    __m128d const one = _mm_set1_pd(1.0);
+    __m128d const minusOne = _mm_set1_pd(-1.0);
+    __m128d const zero = _mm_setzero_pd();
+    bool const large = _a.asRadians() > 0.0;
+    auto select = [](__m128d mask, __m128d a, __m128d b) {
+        return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+    };
+    detail::containsBatch(x, y, z, n, result,
+        [&](__m128d vx, __m128d vy, __m128d vz) {
+            __m128d vdotc = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vx, cx),
+                                                  _mm_mul_pd(vy, cy)),
+                                       _mm_mul_pd(vz, cz));
+            __m128d near = _mm_cmpgt_pd(vdotc, half);
+            __m128d far = _mm_cmplt_pd(vdotc, minusHalf);
+            __m128d ux = select(near, _mm_sub_pd(vx, cx),
+                                select(far, _mm_add_pd(vx, cx), vx));
+            __m128d uy = select(near, _mm_sub_pd(vy, cy),
+                                select(far, _mm_add_pd(vy, cy), vy));
+            __m128d uz = select(near, _mm_sub_pd(vz, cz),
+                                select(far, _mm_add_pd(vz, cz), vz));
+            __m128d scz = select(near, one, select(far, minusOne, zero));
+            __m128d sx = _mm_add_pd(_mm_add_pd(_mm_mul_pd(m[0][0], ux),
+                                               _mm_mul_pd(m[0][1], uy)),
+                                    _mm_mul_pd(m[0][2], uz));
+            __m128d sy = _mm_add_pd(_mm_add_pd(_mm_mul_pd(m[1][0], ux),
+                                               _mm_mul_pd(m[1][1], uy)),
+                                    _mm_mul_pd(m[1][2], uz));
+            __m128d sz = _mm_add_pd(_mm_add_pd(_mm_mul_pd(m[2][0], ux),
+                                               _mm_mul_pd(m[2][1], uy)),
+                                    _mm_mul_pd(m[2][2], uz));
+            __m128d ex = _mm_mul_pd(sx, tana);
+            __m128d ey = _mm_mul_pd(sy, tanb);
+            __m128d ez = _mm_add_pd(sz, scz);
+            __m128d d = _mm_sub_pd(_mm_add_pd(_mm_mul_pd(ex, ex),
+                                              _mm_mul_pd(ey, ey)),
+                                   _mm_mul_pd(ez, ez));
+            __m128d inside = large ?
+                _mm_or_pd(_mm_cmpge_pd(ez, zero), _mm_cmpge_pd(d, zero)) :
+                _mm_and_pd(_mm_cmpge_pd(ez, zero), _mm_cmple_pd(d, zero));
+            return _mm_movemask_pd(inside);
+        },
+        pointTest);
+#endif
+}
+
 Box Ellipse::getBoundingBox() const {
     // For now, simply return the bounding box of the ellipse bounding circle.
     //
@@ -244,14 +387,50 @@ Circle Ellipse::getBoundingCircle() const {
 }
 
 Relationship Ellipse::relate(Box const & b) const {
-    return getBoundingCircle().relate(b) & (DISJOINT | WITHIN);
+    Relationship r = getBoundingCircle().relate(b) & (DISJOINT | WITHIN);
+    if (r != Relationship()) {
+        return r;
+    }
+    // Boxes do not have great circle edges, so they cannot be related to
+    // ellipses via the transformation used for polygons. Instead, relate
+    // b to a polygon containing this ellipse.
+    ConvexPolygon const * p = _getApproximations().outer.get();
+    if (p) {
+        r |= p->relate(b) & (DISJOINT | WITHIN);
+    }
+    return r;
+}
+
+Relationship Ellipse::relate(Circle const & c) const {
+    if (isEmpty() || isFull() || c.isEmpty() || c.isFull()) {
+        return relate(Ellipse(c));
+    }
+    Relationship r = getBoundingCircle().relate(c) & (DISJOINT | WITHIN);
+    if (r != Relationship()) {
+        return r;
+    }
+    // Relate c to polygons containing and contained in this ellipse. If
+    // there are none, relate this ellipse to polygons approximating c.
+    Approximations const & a = _getApproximations();
+    if (!a.outer || !a.inner) {
+        return relate(Ellipse(c));
+    }
+    r = a.outer->relate(c) & (DISJOINT | WITHIN);
+    r |= a.inner->relate(c) & CONTAINS;
+    return r;
+}
+
+Relationship Ellipse::relate(ConvexPolygon const & p) const {
+    // Ellipse-ConvexPolygon relations are implemented by ConvexPolygon.
+    return invert(p.relate(*this));
 }
 
-// For now, implement ellipse-circle and ellipse-ellipse relation
-// computation by approximating ellipses via their bounding circles.
+// Ellipse-ellipse relations are computed by approximating the second ellipse
+// with polygons (see `approximatingPolygon`) and relating those to this
+// ellipse.
 //
-// It should be possible to improve on this using the following algorithm to
-// compute ellipse-ellipse intersection points.
+// An exact algorithm could be obtained by computing the intersection points
+// of the two ellipse boundaries, as follows.
 //
 // Ellipses that are neither empty nor full have quadratic forms with
 // symmetric matrix representations P, Q of full rank. Consider the matrix
@@ -324,16 +503,39 @@ Relationship Ellipse::relate(Box const & b) const {
 //   accurate computation? Is there some usefully exploitable relationship
 //   between them and the degenerate quadratic forms they engender?
 
-Relationship Ellipse::relate(Circle const & c) const {
-    return getBoundingCircle().relate(c) & (DISJOINT | WITHIN);
-}
-
-Relationship Ellipse::relate(ConvexPolygon const & p) const {
-    return getBoundingCircle().relate(p) & (DISJOINT | WITHIN);
-}
-
 Relationship Ellipse::relate(Ellipse const & e) const {
-    return getBoundingCircle().relate(e.getBoundingCircle()) & DISJOINT;
+    if (isEmpty()) {
+        if (e.isEmpty()) {
+            return CONTAINS | DISJOINT | WITHIN;
+        }
+        return DISJOINT | WITHIN;
+    } else if (e.isEmpty()) {
+        return CONTAINS | DISJOINT;
+    }
+    if (isFull()) {
+        if (e.isFull()) {
+            return CONTAINS | WITHIN;
+        }
+        return CONTAINS;
+    } else if (e.isFull()) {
+        return WITHIN;
+    }
+    Relationship r =
+        getBoundingCircle().relate(e.getBoundingCircle()) & DISJOINT;
+    if (r != Relationship()) {
+        return r;
+    }
+    // If this ellipse contains or is disjoint from a polygon containing e,
+    // then it contains or is disjoint from e. If it is within a polygon
+    // contained in e, then it is within e.
+    Approximations const & a = e._getApproximations();
+    if (a.outer) {
+        r |= invert(a.outer->relate(*this)) & (CONTAINS | DISJOINT);
+    }
+    if (a.inner) {
+        r |= invert(a.inner->relate(*this)) & WITHIN;
+    }
+    return r;
 }
 
 std::vector<uint8_t> Ellipse::encode() const {
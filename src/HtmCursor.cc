@@ -0,0 +1,134 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains the HtmCursor implementation.
+
+#include "lsst/sphgeom/HtmCursor.h"
+
+#include <stdexcept>
+
+#include "lsst/sphgeom/orientation.h"
+
+#include "HtmPixelizationImpl.h"
+
+
+namespace lsst {
+namespace sphgeom {
+
+HtmCursor::HtmCursor(int level) :
+    _depth{-1},
+    _level{level},
+    _numExpansions{0}
+{
+    if (level < 0 || level > HtmPixelization::MAX_LEVEL) {
+        throw std::invalid_argument("Invalid HTM subdivision level");
+    }
+}
+
+uint64_t HtmCursor::index(UnitVector3d const & v) {
+    _setRoot(rootTriangle(v));
+    // The child triangle containing v is chosen exactly as in
+    // HtmPixelization::index, but using the cached midpoints of the
+    // triangles on the path. Midpoints are only computed for triangles
+    // that were not on the path of the previous call.
+    for (int d = 0; d < _level; ++d) {
+        Node & n = _path[d];
+        _expand(n);
+        int child;
+        if (orientation(v, n.m[0], n.m[2]) >= 0) {
+            child = 0;
+        } else if (orientation(v, n.m[1], n.m[0]) >= 0) {
+            child = 1;
+        } else if (orientation(v, n.m[2], n.m[1]) >= 0) {
+            child = 2;
+        } else {
+            child = 3;
+        }
+        if (d == _depth || _path[d + 1].index != n.index * 4 + child) {
+            _descend(d, child);
+        }
+    }
+    return _path[_level].index;
+}
+
+void HtmCursor::vertices(uint64_t i, UnitVector3d * verts) {
+    int l = HtmPixelization::level(i);
+    if (l < 0 || l > HtmPixelization::MAX_LEVEL) {
+        throw std::invalid_argument("Invalid HTM index");
+    }
+    _setRoot((i >> 2 * l) & 7);
+    // Find the deepest triangle on the path that is an ancestor of i (or
+    // i itself), and descend from there.
+    int d = l < _depth ? l : _depth;
+    while (_path[d].index != i >> 2 * (l - d)) {
+        --d;
+    }
+    for (; d < l; ++d) {
+        _descend(d, static_cast<int>(i >> 2 * (l - d - 1)) & 3);
+    }
+    Node const & n = _path[l];
+    verts[0] = n.v[0];
+    verts[1] = n.v[1];
+    verts[2] = n.v[2];
+}
+
+void HtmCursor::_setRoot(uint64_t r) {
+    if (_depth >= 0 && _path[0].index == r + 8) {
+        return;
+    }
+    Node & n = _path[0];
+    n.index = r + 8;
+    n.expanded = false;
+    n.v[0] = rootVertex(r, 0);
+    n.v[1] = rootVertex(r, 1);
+    n.v[2] = rootVertex(r, 2);
+    _depth = 0;
+}
+
+void HtmCursor::_expand(Node & n) {
+    if (!n.expanded) {
+        n.m[0] = UnitVector3d(n.v[0] + n.v[1]);
+        n.m[1] = UnitVector3d(n.v[1] + n.v[2]);
+        n.m[2] = UnitVector3d(n.v[2] + n.v[0]);
+        n.expanded = true;
+        ++_numExpansions;
+    }
+}
+
+void HtmCursor::_descend(int depth, int child) {
+    Node & p = _path[depth];
+    Node & c = _path[depth + 1];
+    _expand(p);
+    // The child vertices are assigned as in HtmPixelization::triangle.
+    switch (child) {
+        case 0: c.v[0] = p.v[0]; c.v[1] = p.m[0]; c.v[2] = p.m[2]; break;
+        case 1: c.v[0] = p.v[1]; c.v[1] = p.m[1]; c.v[2] = p.m[0]; break;
+        case 2: c.v[0] = p.v[2]; c.v[1] = p.m[2]; c.v[2] = p.m[1]; break;
+        case 3: c.v[0] = p.m[1]; c.v[1] = p.m[2]; c.v[2] = p.m[0]; break;
+    }
+    c.index = p.index * 4 + static_cast<uint64_t>(child);
+    c.expanded = false;
+    _depth = depth + 1;
+}
+
+}} // namespace lsst::sphgeom
@@ -25,9 +25,15 @@
 
 #include "lsst/sphgeom/HtmPixelization.h"
 
+#if !defined(NO_SIMD) && defined(__x86_64__)
+    #include <x86intrin.h>
+#endif
+#include <utility>
+
 #include "lsst/sphgeom/curve.h"
 #include "lsst/sphgeom/orientation.h"
 
+#include "HtmPixelizationImpl.h"
 #include "PixelFinder.h"
 
 
@@ -36,21 +42,211 @@ namespace sphgeom {
 
 namespace {
 
-// `rootVertex` returns the i-th (0-3) root vertex of HTM root triangle r (0-8).
-UnitVector3d const & rootVertex(int r, int i) {
-    static UnitVector3d const VERTICES[8][3] = {
-        { UnitVector3d::X(), -UnitVector3d::Z(),  UnitVector3d::Y()},
-        { UnitVector3d::Y(), -UnitVector3d::Z(), -UnitVector3d::X()},
-        {-UnitVector3d::X(), -UnitVector3d::Z(), -UnitVector3d::Y()},
-        {-UnitVector3d::Y(), -UnitVector3d::Z(),  UnitVector3d::X()},
-        { UnitVector3d::X(),  UnitVector3d::Z(), -UnitVector3d::Y()},
-        {-UnitVector3d::Y(),  UnitVector3d::Z(), -UnitVector3d::X()},
-        {-UnitVector3d::X(),  UnitVector3d::Z(),  UnitVector3d::Y()},
-        { UnitVector3d::Y(),  UnitVector3d::Z(),  UnitVector3d::X()}
-    };
-    return VERTICES[r][i];
+// `makeTriangle` computes the vertices of the HTM triangle with index i and
+// subdivision level l, which must be valid.
+void makeTriangle(uint64_t i, int l, UnitVector3d * verts) {
+    l *= 2;
+    uint64_t r = (i >> l) & 7;
+    UnitVector3d v0 = rootVertex(r, 0);
+    UnitVector3d v1 = rootVertex(r, 1);
+    UnitVector3d v2 = rootVertex(r, 2);
+    for (l -= 2; l >= 0; l -= 2) {
+        int child = (i >> l) & 3;
+        UnitVector3d m12 = UnitVector3d(v1 + v2);
+        UnitVector3d m20 = UnitVector3d(v2 + v0);
+        UnitVector3d m01 = UnitVector3d(v0 + v1);
+        switch (child) {
+            case 0: v1 = m01; v2 = m20; break;
+            case 1: v0 = v1; v1 = m12; v2 = m01; break;
+            case 2: v0 = v2; v1 = m20; v2 = m12; break;
+            case 3: v0 = m12; v1 = m20; v2 = m01; break;
+        }
+    }
+    verts[0] = v0;
+    verts[1] = v1;
+    verts[2] = v2;
+}
+
+#if !defined(NO_SIMD) && defined(__x86_64__)
+
+// `Vector3d2` holds the components of 2 vectors, one per SIMD lane.
+struct Vector3d2 {
+    __m128d x;
+    __m128d y;
+    __m128d z;
+};
+
+inline Vector3d2 load(UnitVector3d const & a, UnitVector3d const & b) {
+    return Vector3d2{_mm_set_pd(b.x(), a.x()),
+                     _mm_set_pd(b.y(), a.y()),
+                     _mm_set_pd(b.z(), a.z())};
+}
+
+inline UnitVector3d extract(Vector3d2 const & v, int lane) {
+    double x[2], y[2], z[2];
+    _mm_storeu_pd(x, v.x);
+    _mm_storeu_pd(y, v.y);
+    _mm_storeu_pd(z, v.z);
+    return UnitVector3d::fromNormalized(x[lane], y[lane], z[lane]);
+}
+
+inline __m128d select(__m128d mask, __m128d a, __m128d b) {
+    return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));
+}
+
+inline Vector3d2 select(__m128d mask, Vector3d2 const & a, Vector3d2 const & b) {
+    return Vector3d2{select(mask, a.x, b.x),
+                     select(mask, a.y, b.y),
+                     select(mask, a.z, b.z)};
+}
+
+// `normalizedSum` returns the normalized sums a + b for both lanes. The
+// arithmetic mirrors Vector3d::normalize exactly, so the results are bit
+// for bit identical to those of UnitVector3d(a + b).
+Vector3d2 normalizedSum(Vector3d2 const & a, Vector3d2 const & b) {
+    static __m128d const m0m0 = _mm_set1_pd(-0.0);
+    __m128d x = _mm_add_pd(a.x, b.x);
+    __m128d y = _mm_add_pd(a.y, b.y);
+    __m128d z = _mm_add_pd(a.z, b.z);
+    __m128d ax = _mm_andnot_pd(m0m0, x);
+    __m128d ay = _mm_andnot_pd(m0m0, y);
+    __m128d az = _mm_andnot_pd(m0m0, z);
+    __m128d maxabs = _mm_max_pd(ax, _mm_max_pd(ay, az));
+    // Dividing the component with the largest absolute value by maxabs
+    // yields ±1 exactly, as in the scalar code.
+    x = _mm_div_pd(x, maxabs);
+    y = _mm_div_pd(y, maxabs);
+    z = _mm_div_pd(z, maxabs);
+    __m128d xx = _mm_mul_pd(x, x);
+    __m128d yy = _mm_mul_pd(y, y);
+    __m128d zz = _mm_mul_pd(z, z);
+    // Sum the squares of the two components with the smallest absolute
+    // values. When absolute values tie, either choice gives the same sum.
+    __m128d xmax = _mm_and_pd(_mm_cmpge_pd(ax, ay), _mm_cmpge_pd(ax, az));
+    __m128d ymax = _mm_cmpge_pd(ay, az);
+    __m128d d = select(xmax, _mm_add_pd(yy, zz),
+                       select(ymax, _mm_add_pd(xx, zz), _mm_add_pd(xx, yy)));
+    __m128d norm = _mm_sqrt_pd(_mm_add_pd(_mm_set1_pd(1.0), d));
+    return Vector3d2{_mm_div_pd(x, norm),
+                     _mm_div_pd(y, norm),
+                     _mm_div_pd(z, norm)};
+}
+
+// `orientationSigns` evaluates the floating point filters of orientation()
+// for both lanes. On return, bit j of `pos` (`neg`) is set if the
+// orientation of the vectors in lane j is known to be positive (negative).
+// If neither bit is set, the orientation must be computed with orientation().
+void orientationSigns(Vector3d2 const & a,
+                      Vector3d2 const & b,
+                      Vector3d2 const & c,
+                      int & pos,
+                      int & neg)
+{
+    // See orientation() for the derivation of these constants.
+    static double const relativeError = 5.6e-16;
+    static double const maxAbsoluteError = 1.7e-15;
+    static double const minAbsoluteError = 4.0e-307;
+    static __m128d const m0m0 = _mm_set1_pd(-0.0);
+
+    __m128d bycz = _mm_mul_pd(b.y, c.z);
+    __m128d bzcy = _mm_mul_pd(b.z, c.y);
+    __m128d bzcx = _mm_mul_pd(b.z, c.x);
+    __m128d bxcz = _mm_mul_pd(b.x, c.z);
+    __m128d bxcy = _mm_mul_pd(b.x, c.y);
+    __m128d bycx = _mm_mul_pd(b.y, c.x);
+    __m128d det = _mm_add_pd(
+        _mm_add_pd(_mm_mul_pd(a.x, _mm_sub_pd(bycz, bzcy)),
+                   _mm_mul_pd(a.y, _mm_sub_pd(bzcx, bxcz))),
+        _mm_mul_pd(a.z, _mm_sub_pd(bxcy, bycx)));
+    __m128d err = _mm_set1_pd(maxAbsoluteError);
+    pos = _mm_movemask_pd(_mm_cmpgt_pd(det, err));
+    neg = _mm_movemask_pd(_mm_cmplt_pd(det, _mm_xor_pd(err, m0m0)));
+    if ((pos | neg) == 3) {
+        return;
+    }
+    __m128d permanent = _mm_add_pd(
+        _mm_add_pd(
+            _mm_mul_pd(_mm_andnot_pd(m0m0, a.x),
+                       _mm_add_pd(_mm_andnot_pd(m0m0, bycz),
+                                  _mm_andnot_pd(m0m0, bzcy))),
+            _mm_mul_pd(_mm_andnot_pd(m0m0, a.y),
+                       _mm_add_pd(_mm_andnot_pd(m0m0, bzcx),
+                                  _mm_andnot_pd(m0m0, bxcz)))),
+        _mm_mul_pd(_mm_andnot_pd(m0m0, a.z),
+                   _mm_add_pd(_mm_andnot_pd(m0m0, bxcy),
+                              _mm_andnot_pd(m0m0, bycx))));
+    err = _mm_add_pd(_mm_mul_pd(_mm_set1_pd(relativeError), permanent),
+                     _mm_set1_pd(minAbsoluteError));
+    pos = _mm_movemask_pd(_mm_cmpgt_pd(det, err));
+    neg = _mm_movemask_pd(_mm_cmplt_pd(det, _mm_xor_pd(err, m0m0)));
+}
+
+// `isNonNegative` returns true if orientation(a, b, c) ≥ 0 for the vectors
+// in the given lane, falling back on orientation() when the floating point
+// filters in orientationSigns() were inconclusive.
+inline bool isNonNegative(int pos, int neg, int lane,
+                          Vector3d2 const & a,
+                          Vector3d2 const & b,
+                          Vector3d2 const & c)
+{
+    int bit = 1 << lane;
+    if (((pos | neg) & bit) != 0) {
+        return (pos & bit) != 0;
+    }
+    return orientation(extract(a, lane), extract(b, lane), extract(c, lane)) >= 0;
+}
+
+inline __m128d laneMask(bool lane0, bool lane1) {
+    return _mm_castsi128_pd(_mm_set_epi64x(-static_cast<int64_t>(lane1),
+                                           -static_cast<int64_t>(lane0)));
+}
+
+// `indexPair` computes the HTM indexes of the 2 points in p at once. It
+// performs the same computations as HtmPixelization::index, but descends
+// the triangle trees containing both points in lock-step.
+void indexPair(Vector3d2 const & p, uint64_t * indexes, int level) {
+    uint64_t r[2] = {rootTriangle(extract(p, 0)), rootTriangle(extract(p, 1))};
+    Vector3d2 v0 = load(rootVertex(r[0], 0), rootVertex(r[1], 0));
+    Vector3d2 v1 = load(rootVertex(r[0], 1), rootVertex(r[1], 1));
+    Vector3d2 v2 = load(rootVertex(r[0], 2), rootVertex(r[1], 2));
+    uint64_t i[2] = {r[0] + 8, r[1] + 8};
+    for (int l = 0; l < level; ++l) {
+        Vector3d2 m01 = normalizedSum(v0, v1);
+        Vector3d2 m20 = normalizedSum(v2, v0);
+        Vector3d2 m12 = normalizedSum(v1, v2);
+        int pos[3], neg[3];
+        orientationSigns(p, m01, m20, pos[0], neg[0]);
+        orientationSigns(p, m12, m01, pos[1], neg[1]);
+        orientationSigns(p, m20, m12, pos[2], neg[2]);
+        int child[2];
+        for (int j = 0; j < 2; ++j) {
+            if (isNonNegative(pos[0], neg[0], j, p, m01, m20)) {
+                child[j] = 0;
+            } else if (isNonNegative(pos[1], neg[1], j, p, m12, m01)) {
+                child[j] = 1;
+            } else if (isNonNegative(pos[2], neg[2], j, p, m20, m12)) {
+                child[j] = 2;
+            } else {
+                child[j] = 3;
+            }
+            i[j] = (i[j] << 2) + static_cast<uint64_t>(child[j]);
+        }
+        __m128d c0 = laneMask(child[0] == 0, child[1] == 0);
+        __m128d c1 = laneMask(child[0] == 1, child[1] == 1);
+        __m128d c2 = laneMask(child[0] == 2, child[1] == 2);
+        Vector3d2 w0 = select(c0, v0, select(c1, v1, select(c2, v2, m12)));
+        Vector3d2 w1 = select(c0, m01, select(c1, m12, m20));
+        Vector3d2 w2 = select(c0, m20, select(c1, m01, select(c2, m12, m01)));
+        v0 = w0;
+        v1 = w1;
+        v2 = w2;
+    }
+    indexes[0] = i[0];
+    indexes[1] = i[1];
 }
 
+#endif
+
 // `HtmPixelFinder` locates trixels that intersect a region.
 template <typename RegionType, bool InteriorOnly>
 class HtmPixelFinder: public detail::PixelFinder<
@@ -68,7 +264,7 @@ public:
         Base(ranges, region, level, maxRanges)
     {}
 
-    void operator()() {
+    void visitRoots() {
         UnitVector3d trixel[3];
         // Loop over HTM root triangles.
         for (uint64_t r = 0; r < 8; ++r) {
@@ -125,24 +321,9 @@ ConvexPolygon HtmPixelization::triangle(uint64_t i) {
     if (l < 0 || l > MAX_LEVEL) {
         throw std::invalid_argument("Invalid HTM index");
     }
-    l *= 2;
-    uint64_t r = (i >> l) & 7;
-    UnitVector3d v0 = rootVertex(r, 0);
-    UnitVector3d v1 = rootVertex(r, 1);
-    UnitVector3d v2 = rootVertex(r, 2);
-    for (l -= 2; l >= 0; l -= 2) {
-        int child = (i >> l) & 3;
-        UnitVector3d m12 = UnitVector3d(v1 + v2);
-        UnitVector3d m20 = UnitVector3d(v2 + v0);
-        UnitVector3d m01 = UnitVector3d(v0 + v1);
-        switch (child) {
-            case 0: v1 = m01; v2 = m20; break;
-            case 1: v0 = v1; v1 = m12; v2 = m01; break;
-            case 2: v0 = v2; v1 = m20; v2 = m12; break;
-            case 3: v0 = m12; v1 = m20; v2 = m01; break;
-        }
-    }
-    return ConvexPolygon(v0, v1, v2);
+    UnitVector3d verts[3];
+    makeTriangle(i, l, verts);
+    return ConvexPolygon(verts[0], verts[1], verts[2]);
 }
 
 std::string HtmPixelization::asString(uint64_t i) {
@@ -161,34 +342,37 @@ std::string HtmPixelization::asString(uint64_t i) {
     return std::string(p, sizeof(s) - static_cast<size_t>(p - s));
 }
 
-HtmPixelization::HtmPixelization(int level) : _level(level) {
+HtmPixelization::HtmPixelization(int level,
+                                 std::shared_ptr<PixelCache> cache) :
+    _level(level),
+    _cache(std::move(cache))
+{
     if (level < 0 || level > MAX_LEVEL) {
         throw std::invalid_argument("Invalid HTM subdivision level");
     }
 }
 
+std::unique_ptr<Region> HtmPixelization::pixel(uint64_t i) const {
+    if (!_cache) {
+        return std::unique_ptr<Region>(new ConvexPolygon(triangle(i)));
+    }
+    int l = level(i);
+    if (l < 0 || l > MAX_LEVEL) {
+        throw std::invalid_argument("Invalid HTM index");
+    }
+    UnitVector3d verts[PixelCache::MAX_VERTICES];
+    _cache->get(PixelCache::Scheme::HTM, l, i, verts,
+                [i, l](UnitVector3d * v) {
+                    makeTriangle(i, l, v);
+                    return size_t{3};
+                });
+    return std::unique_ptr<Region>(
+        new ConvexPolygon(verts[0], verts[1], verts[2]));
+}
+
 uint64_t HtmPixelization::index(UnitVector3d const & v) const {
     // Find the root triangle containing v.
-    uint64_t r;
-    if (v.z() < 0.0) {
-        // v is in the southern hemisphere (root triangle 0, 1, 2, or 3).
-        if (v.y() > 0.0) {
-            r = (v.x() > 0.0) ? 0 : 1;
-        } else if (v.y() == 0.0) {
-            r = (v.x() >= 0.0) ? 0 : 2;
-        } else {
-            r = (v.x() < 0.0) ? 2 : 3;
-        }
-    } else {
-        // v is in the northern hemisphere (root triangle 4, 5, 6, or 7).
-        if (v.y() > 0.0) {
-            r = (v.x() > 0.0) ? 7 : 6;
-        } else if (v.y() == 0.0) {
-            r = (v.x() >= 0.0) ? 7 : 5;
-        } else {
-            r = (v.x() < 0.0) ? 5 : 4;
-        }
-    }
+    uint64_t r = rootTriangle(v);
     UnitVector3d v0 = rootVertex(r, 0);
     UnitVector3d v1 = rootVertex(r, 1);
     UnitVector3d v2 = rootVertex(r, 2);
@@ -216,12 +400,65 @@ uint64_t HtmPixelization::index(UnitVector3d const & v) const {
     return i;
 }
 
-RangeSet HtmPixelization::_envelope(Region const & r, size_t maxRanges) const {
-    return detail::findPixels<HtmPixelFinder, false>(r, maxRanges, _level);
+void HtmPixelization::_index(UnitVector3d const * v,
+                             uint64_t * indexes,
+                             size_t n) const
+{
+    size_t i = 0;
+#if !defined(NO_SIMD) && defined(__x86_64__)
+    for (; i + 2 <= n; i += 2) {
+        indexPair(load(v[i], v[i + 1]), indexes + i, _level);
+    }
+#endif
+    for (; i < n; ++i) {
+        indexes[i] = index(v[i]);
+    }
 }
 
-RangeSet HtmPixelization::_interior(Region const & r, size_t maxRanges) const {
-    return detail::findPixels<HtmPixelFinder, true>(r, maxRanges, _level);
+void HtmPixelization::_index(double const * x,
+                             double const * y,
+                             double const * z,
+                             uint64_t * indexes,
+                             size_t n) const
+{
+    size_t i = 0;
+#if !defined(NO_SIMD) && defined(__x86_64__)
+    for (; i + 2 <= n; i += 2) {
+        Vector3d2 p = {_mm_loadu_pd(x + i),
+                       _mm_loadu_pd(y + i),
+                       _mm_loadu_pd(z + i)};
+        indexPair(p, indexes + i, _level);
+    }
+#endif
+    for (; i < n; ++i) {
+        indexes[i] = index(UnitVector3d::fromNormalized(x[i], y[i], z[i]));
+    }
+}
+
+RangeSet HtmPixelization::_envelope(Region const & r,
+                                    size_t maxRanges,
+                                    TraversalOptions const & options) const
+{
+    return detail::findPixels<HtmPixelFinder, false>(
+        r, maxRanges, _level, options);
+}
+
+RangeSet HtmPixelization::_interior(Region const & r,
+                                    size_t maxRanges,
+                                    TraversalOptions const & options) const
+{
+    return detail::findPixels<HtmPixelFinder, true>(
+        r, maxRanges, _level, options);
+}
+
+void HtmPixelization::_streamEnvelope(
+    Region const & r,
+    std::function<void(uint64_t, uint64_t)> const & sink,
+    TraversalOptions const & options) const
+{
+    detail::RangeStream stream(sink);
+    detail::findPixels<HtmPixelFinder, false>(
+        r, 0, _level, options, &stream);
 }
 
 }} // namespace lsst::sphgeom
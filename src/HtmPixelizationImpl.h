@@ -0,0 +1,78 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_SPHGEOM_HTMPIXELIZATIONIMPL_H_
+#define LSST_SPHGEOM_HTMPIXELIZATIONIMPL_H_
+
+/// \file
+/// \brief This file contains functions used by HTM pixelization
+///        implementations.
+
+#include <cstdint>
+
+#include "lsst/sphgeom/UnitVector3d.h"
+
+
+namespace lsst {
+namespace sphgeom {
+namespace {
+
+// `rootVertex` returns the i-th (0-3) root vertex of HTM root triangle r (0-8).
+UnitVector3d const & rootVertex(int r, int i) {
+    static UnitVector3d const VERTICES[8][3] = {
+        { UnitVector3d::X(), -UnitVector3d::Z(),  UnitVector3d::Y()},
+        { UnitVector3d::Y(), -UnitVector3d::Z(), -UnitVector3d::X()},
+        {-UnitVector3d::X(), -UnitVector3d::Z(), -UnitVector3d::Y()},
+        {-UnitVector3d::Y(), -UnitVector3d::Z(),  UnitVector3d::X()},
+        { UnitVector3d::X(),  UnitVector3d::Z(), -UnitVector3d::Y()},
+        {-UnitVector3d::Y(),  UnitVector3d::Z(), -UnitVector3d::X()},
+        {-UnitVector3d::X(),  UnitVector3d::Z(),  UnitVector3d::Y()},
+        { UnitVector3d::Y(),  UnitVector3d::Z(),  UnitVector3d::X()}
+    };
+    return VERTICES[r][i];
+}
+
+// `rootTriangle` returns the index (0-7) of the HTM root triangle
+// containing v.
+uint64_t rootTriangle(UnitVector3d const & v) {
+    if (v.z() < 0.0) {
+        // v is in the southern hemisphere (root triangle 0, 1, 2, or 3).
+        if (v.y() > 0.0) {
+            return (v.x() > 0.0) ? 0 : 1;
+        } else if (v.y() == 0.0) {
+            return (v.x() >= 0.0) ? 0 : 2;
+        }
+        return (v.x() < 0.0) ? 2 : 3;
+    }
+    // v is in the northern hemisphere (root triangle 4, 5, 6, or 7).
+    if (v.y() > 0.0) {
+        return (v.x() > 0.0) ? 7 : 6;
+    } else if (v.y() == 0.0) {
+        return (v.x() >= 0.0) ? 7 : 5;
+    }
+    return (v.x() < 0.0) ? 5 : 4;
+}
+
+} // unnamed namespace
+}} // namespace lsst::sphgeom
+
+#endif // LSST_SPHGEOM_HTMPIXELIZATIONIMPL_H_
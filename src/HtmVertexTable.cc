@@ -0,0 +1,183 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains the HtmVertexTable implementation.
+
+#include "lsst/sphgeom/HtmVertexTable.h"
+
+#include <stdexcept>
+
+#include "lsst/sphgeom/HtmPixelization.h"
+#include "lsst/sphgeom/orientation.h"
+
+#include "HtmPixelizationImpl.h"
+
+
+namespace lsst {
+namespace sphgeom {
+
+namespace {
+
+// `subtreeSize` returns the number of triangles with level less than
+// `depth` in the subtree rooted at a triangle with the given level.
+inline size_t subtreeSize(int level, int depth) {
+    return ((static_cast<size_t>(1) << 2 * (depth - level)) - 1) / 3;
+}
+
+// `descend` replaces v0, v1 and v2 with the vertices of the given child of
+// the triangle they define, where m01, m12 and m20 are its edge midpoints.
+// The vertex assignment matches HtmPixelization::triangle.
+inline void descend(int child,
+                    UnitVector3d const & m01,
+                    UnitVector3d const & m12,
+                    UnitVector3d const & m20,
+                    UnitVector3d & v0,
+                    UnitVector3d & v1,
+                    UnitVector3d & v2)
+{
+    switch (child) {
+        case 0: v1 = m01; v2 = m20; break;
+        case 1: v0 = v1; v1 = m12; v2 = m01; break;
+        case 2: v0 = v2; v1 = m20; v2 = m12; break;
+        case 3: v0 = m12; v1 = m20; v2 = m01; break;
+    }
+}
+
+} // unnamed namespace
+
+
+HtmVertexTable::HtmVertexTable(int depth) : _depth{depth} {
+    if (depth < 0 || depth > MAX_DEPTH) {
+        throw std::invalid_argument("Invalid HTM vertex table depth");
+    }
+}
+
+uint64_t HtmVertexTable::index(UnitVector3d const & v, int level) const {
+    if (level < 0 || level > HtmPixelization::MAX_LEVEL) {
+        throw std::invalid_argument("Invalid HTM subdivision level");
+    }
+    std::call_once(_built, [this]() { _build(); });
+    uint64_t r = rootTriangle(v);
+    UnitVector3d v0 = rootVertex(r, 0);
+    UnitVector3d v1 = rootVertex(r, 1);
+    UnitVector3d v2 = rootVertex(r, 2);
+    uint64_t i = r + 8;
+    size_t pos = r * subtreeSize(0, _depth);
+    // The child containing v is chosen exactly as in
+    // HtmPixelization::index, with the midpoints of triangles above the
+    // table depth looked up rather than computed.
+    for (int l = 0; l < level; ++l) {
+        UnitVector3d m01, m12, m20;
+        if (l < _depth) {
+            Midpoints const & m = _midpoints[pos];
+            m01 = m.m[0];
+            m12 = m.m[1];
+            m20 = m.m[2];
+        } else {
+            m01 = UnitVector3d(v0 + v1);
+            m20 = UnitVector3d(v2 + v0);
+        }
+        int child = 0;
+        if (orientation(v, m01, m20) < 0) {
+            if (l >= _depth) {
+                m12 = UnitVector3d(v1 + v2);
+            }
+            if (orientation(v, m12, m01) >= 0) {
+                child = 1;
+            } else if (orientation(v, m20, m12) >= 0) {
+                child = 2;
+            } else {
+                child = 3;
+            }
+        }
+        i = (i << 2) + static_cast<uint64_t>(child);
+        if (l < _depth) {
+            pos += 1 + child * subtreeSize(l + 1, _depth);
+        }
+        descend(child, m01, m12, m20, v0, v1, v2);
+    }
+    return i;
+}
+
+void HtmVertexTable::vertices(uint64_t i, UnitVector3d * verts) const {
+    int level = HtmPixelization::level(i);
+    if (level < 0 || level > HtmPixelization::MAX_LEVEL) {
+        throw std::invalid_argument("Invalid HTM index");
+    }
+    std::call_once(_built, [this]() { _build(); });
+    uint64_t r = (i >> 2 * level) & 7;
+    UnitVector3d v0 = rootVertex(r, 0);
+    UnitVector3d v1 = rootVertex(r, 1);
+    UnitVector3d v2 = rootVertex(r, 2);
+    size_t pos = r * subtreeSize(0, _depth);
+    for (int l = 0; l < level; ++l) {
+        int child = static_cast<int>(i >> 2 * (level - l - 1)) & 3;
+        if (l < _depth) {
+            Midpoints const & m = _midpoints[pos];
+            descend(child, m.m[0], m.m[1], m.m[2], v0, v1, v2);
+            pos += 1 + child * subtreeSize(l + 1, _depth);
+        } else {
+            UnitVector3d m01 = UnitVector3d(v0 + v1);
+            UnitVector3d m12 = UnitVector3d(v1 + v2);
+            UnitVector3d m20 = UnitVector3d(v2 + v0);
+            descend(child, m01, m12, m20, v0, v1, v2);
+        }
+    }
+    verts[0] = v0;
+    verts[1] = v1;
+    verts[2] = v2;
+}
+
+void HtmVertexTable::_build() const {
+    if (_depth == 0) {
+        return;
+    }
+    _midpoints.reserve(8 * subtreeSize(0, _depth));
+    for (int r = 0; r < 8; ++r) {
+        _build(0, rootVertex(r, 0), rootVertex(r, 1), rootVertex(r, 2));
+    }
+}
+
+void HtmVertexTable::_build(int level,
+                            UnitVector3d const & v0,
+                            UnitVector3d const & v1,
+                            UnitVector3d const & v2) const
+{
+    // The midpoints are computed with the same expressions as in
+    // HtmPixelization, so that results are bit for bit identical.
+    Midpoints m;
+    m.m[0] = UnitVector3d(v0 + v1);
+    m.m[1] = UnitVector3d(v1 + v2);
+    m.m[2] = UnitVector3d(v2 + v0);
+    _midpoints.push_back(m);
+    if (level + 1 == _depth) {
+        return;
+    }
+    for (int child = 0; child < 4; ++child) {
+        UnitVector3d c0 = v0, c1 = v1, c2 = v2;
+        descend(child, m.m[0], m.m[1], m.m[2], c0, c1, c2);
+        _build(level + 1, c0, c1, c2);
+    }
+}
+
+}} // namespace lsst::sphgeom
@@ -26,6 +26,7 @@
 #include "lsst/sphgeom/Mq3cPixelization.h"
 
 #include <stdexcept>
+#include <utility>
 
 #include "lsst/sphgeom/ConvexPolygon.h"
 #include "lsst/sphgeom/curve.h"
@@ -211,7 +212,7 @@ public:
         Base(ranges, region, level, maxRanges)
     {}
 
-    void operator()() {
+    void visitRoots() {
         UnitVector3d pixel[4];
         // Loop over cube faces
         for (uint64_t f = 10; f < 16; ++f) {
@@ -230,6 +231,27 @@ public:
     }
 };
 
+#if !defined(NO_SIMD) && defined(__x86_64__)
+
+// `indexPair` computes the modified-Q3C indexes of the 2 unit vectors with
+// components given by the lanes of x, y and z.
+void indexPair(int level, __m128d x, __m128d y, __m128d z,
+               uint64_t * indexes)
+{
+    int face[2];
+    __m128d u, v;
+    faceCoordinates(x, y, z, FACE_NUM, FACE_COMP, FACE_CONST, face, u, v);
+    uint64_t m[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(m),
+                     faceToMorton(level, atanApprox(u), atanApprox(v)));
+    for (int j = 0; j < 2; ++j) {
+        indexes[j] = (static_cast<uint64_t>(face[j] + 10) << (2 * level)) |
+                     mortonToHilbert(m[j], level);
+    }
+}
+
+#endif
+
 } // unnamed namespace
 
 
@@ -289,7 +311,11 @@ std::string Mq3cPixelization::asString(uint64_t i) {
     return std::string(p, sizeof(s) - static_cast<size_t>(p - s));
 }
 
-Mq3cPixelization::Mq3cPixelization(int level) : _level{level} {
+Mq3cPixelization::Mq3cPixelization(int level,
+                                   std::shared_ptr<PixelCache> cache) :
+    _level{level},
+    _cache{std::move(cache)}
+{
     if (level < 0 || level > MAX_LEVEL) {
         throw std::invalid_argument(
             "Modified-Q3C subdivision level not in [0, 30]");
@@ -302,7 +328,16 @@ std::unique_ptr<Region> Mq3cPixelization::pixel(uint64_t i) const {
         throw std::invalid_argument("Invalid modified-Q3C index");
     }
     UnitVector3d verts[4];
-    makeQuad(i, _level, verts);
+    if (_cache) {
+        int level = _level;
+        _cache->get(PixelCache::Scheme::MQ3C, level, i, verts,
+                    [i, level](UnitVector3d * v) {
+                        makeQuad(i, level, v);
+                        return size_t{4};
+                    });
+    } else {
+        makeQuad(i, _level, verts);
+    }
     return std::unique_ptr<Region>(
         new ConvexPolygon(verts[0], verts[1], verts[2], verts[3]));
 }
@@ -335,12 +370,70 @@ std::unique_ptr<Region> Mq3cPixelization::pixel(uint64_t i) const {
     }
 #endif
 
-RangeSet Mq3cPixelization::_envelope(Region const & r, size_t maxRanges) const {
-    return detail::findPixels<Mq3cPixelFinder, false>(r, maxRanges, _level);
+void Mq3cPixelization::_index(UnitVector3d const * v,
+                              uint64_t * indexes,
+                              size_t n) const
+{
+    size_t i = 0;
+#if !defined(NO_SIMD) && defined(__x86_64__)
+    for (; i + 2 <= n; i += 2) {
+        indexPair(_level,
+                  _mm_set_pd(v[i + 1].x(), v[i].x()),
+                  _mm_set_pd(v[i + 1].y(), v[i].y()),
+                  _mm_set_pd(v[i + 1].z(), v[i].z()),
+                  indexes + i);
+    }
+#endif
+    for (; i < n; ++i) {
+        indexes[i] = index(v[i]);
+    }
+}
+
+void Mq3cPixelization::_index(double const * x,
+                              double const * y,
+                              double const * z,
+                              uint64_t * indexes,
+                              size_t n) const
+{
+    size_t i = 0;
+#if !defined(NO_SIMD) && defined(__x86_64__)
+    for (; i + 2 <= n; i += 2) {
+        indexPair(_level,
+                  _mm_loadu_pd(x + i),
+                  _mm_loadu_pd(y + i),
+                  _mm_loadu_pd(z + i),
+                  indexes + i);
+    }
+#endif
+    for (; i < n; ++i) {
+        indexes[i] = index(UnitVector3d::fromNormalized(x[i], y[i], z[i]));
+    }
 }
 
-RangeSet Mq3cPixelization::_interior(Region const & r, size_t maxRanges) const {
-    return detail::findPixels<Mq3cPixelFinder, true>(r, maxRanges, _level);
+RangeSet Mq3cPixelization::_envelope(Region const & r,
+                                     size_t maxRanges,
+                                     TraversalOptions const & options) const
+{
+    return detail::findPixels<Mq3cPixelFinder, false>(
+        r, maxRanges, _level, options);
+}
+
+RangeSet Mq3cPixelization::_interior(Region const & r,
+                                     size_t maxRanges,
+                                     TraversalOptions const & options) const
+{
+    return detail::findPixels<Mq3cPixelFinder, true>(
+        r, maxRanges, _level, options);
+}
+
+void Mq3cPixelization::_streamEnvelope(
+    Region const & r,
+    std::function<void(uint64_t, uint64_t)> const & sink,
+    TraversalOptions const & options) const
+{
+    detail::RangeStream stream(sink);
+    detail::findPixels<Mq3cPixelFinder, false>(
+        r, 0, _level, options, &stream);
 }
 
 }} // namespace lsst::sphgeom
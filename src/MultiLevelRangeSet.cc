@@ -0,0 +1,273 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains the MultiLevelRangeSet class implementation.
+
+#include "lsst/sphgeom/MultiLevelRangeSet.h"
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+#include <tuple>
+
+
+namespace lsst {
+namespace sphgeom {
+
+namespace {
+
+void checkLevel(int level) {
+    if (level < 0 || level > MultiLevelRangeSet::MAX_LEVEL) {
+        throw std::invalid_argument("Invalid pixelization level");
+    }
+}
+
+// `coarsen` returns the set of pixels at some level that intersect the
+// pixels in s, which are at a level k levels finer.
+RangeSet coarsen(RangeSet const & s, int k) {
+    RangeSet result;
+    for (auto const & r: s) {
+        // Subtract one from the end point so that end points of 0 (2^64)
+        // are handled correctly.
+        result.insert(std::get<0>(r) >> 2 * k,
+                      ((std::get<1>(r) - 1) >> 2 * k) + 1);
+    }
+    return result;
+}
+
+} // unnamed namespace
+
+
+constexpr int MultiLevelRangeSet::MAX_LEVEL;
+
+MultiLevelRangeSet::MultiLevelRangeSet(RangeSet const & s, int level) {
+    checkLevel(level);
+    _levels.resize(level + 1);
+    // Decompose each range [lo, last] of pixel indexes (the end point is
+    // inclusive to avoid overflow) into pixels at the coarsest possible
+    // levels. Starting at the given level, the pixels at the ends of the
+    // range that do not cover a whole pixel at the next coarser level are
+    // stored, and the remainder of the range is processed at the next
+    // coarser level.
+    //
+    // Since the ranges in s are disjoint and not adjacent, no pixel can be
+    // covered by more than one of them, and the result is the unique
+    // multi-level representation of s. Also, the pixels stored at each
+    // level are generated in ascending order, so inserting them is cheap.
+    for (auto const & r: s) {
+        uint64_t lo = std::get<0>(r);
+        uint64_t last = std::get<1>(r) - 1;
+        for (int k = 0; true; ++k) {
+            RangeSet & cells = _levels[level - k];
+            // Find the first and last pixels at level k that are the
+            // first and last children of a pixel at level k + 1.
+            uint64_t const mask = (static_cast<uint64_t>(4) << 2 * k) - 1;
+            uint64_t first = lo;
+            uint64_t end = last;
+            bool whole = (k < level);
+            if ((lo & mask) != 0) {
+                whole = whole && (lo | mask) < last;
+                first = (lo | mask) + 1;
+            }
+            if ((last & mask) != mask) {
+                whole = whole && (last & ~mask) > lo;
+                end = (last & ~mask) - 1;
+            }
+            if (!whole || first > end) {
+                // The range does not cover a whole pixel at level k + 1.
+                cells.insert(lo >> 2 * k, (last >> 2 * k) + 1);
+                break;
+            }
+            if (first != lo) {
+                cells.insert(lo >> 2 * k, first >> 2 * k);
+            }
+            if (end != last) {
+                cells.insert((end + 1) >> 2 * k, (last >> 2 * k) + 1);
+            }
+            lo = first;
+            last = end;
+        }
+    }
+    while (!_levels.empty() && _levels.back().empty()) {
+        _levels.pop_back();
+    }
+}
+
+RangeSet const & MultiLevelRangeSet::getCells(int level) const {
+    static RangeSet const EMPTY;
+    checkLevel(level);
+    if (level > getMaxLevel()) {
+        return EMPTY;
+    }
+    return _levels[level];
+}
+
+size_t MultiLevelRangeSet::size() const {
+    size_t n = 0;
+    for (RangeSet const & s: _levels) {
+        n += s.size();
+    }
+    return n;
+}
+
+RangeSet MultiLevelRangeSet::toRangeSet(int level) const {
+    checkLevel(level);
+    if (level >= getMaxLevel()) {
+        return _flatten(level);
+    }
+    std::vector<RangeSet> sets;
+    sets.reserve(_levels.size());
+    for (int l = 0; l <= getMaxLevel(); ++l) {
+        if (l <= level) {
+            sets.push_back(_levels[l].scaled(
+                static_cast<uint64_t>(1) << 2 * (level - l)));
+        } else {
+            sets.push_back(coarsen(_levels[l], l - level));
+        }
+    }
+    return RangeSet::joinAll(sets);
+}
+
+bool MultiLevelRangeSet::contains(uint64_t index, int level) const {
+    checkLevel(level);
+    // Since four sibling pixels are always stored as their parent, a pixel
+    // is fully covered if and only if it or one of its ancestors is stored.
+    for (int l = std::min(level, getMaxLevel()); l >= 0; --l) {
+        if (_levels[l].contains(index >> 2 * (level - l))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MultiLevelRangeSet::intersects(uint64_t index, int level) const {
+    if (contains(index, level)) {
+        return true;
+    }
+    // Check whether any descendant of the pixel is stored.
+    for (int l = level + 1; l <= getMaxLevel(); ++l) {
+        int const shift = 2 * (l - level);
+        if (_levels[l].intersects(index << shift, (index + 1) << shift)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool MultiLevelRangeSet::intersects(MultiLevelRangeSet const & s) const {
+    int const level = std::max(std::max(getMaxLevel(), s.getMaxLevel()), 0);
+    return _flatten(level).intersects(s._flatten(level));
+}
+
+bool MultiLevelRangeSet::contains(MultiLevelRangeSet const & s) const {
+    int const level = std::max(std::max(getMaxLevel(), s.getMaxLevel()), 0);
+    return _flatten(level).contains(s._flatten(level));
+}
+
+// Set operations are performed on the single-level representations of
+// the operands at the finest level of either one. These have at most as
+// many ranges as the operands have pixels, so this takes time linear in
+// the size of the operands.
+
+MultiLevelRangeSet MultiLevelRangeSet::intersection(
+    MultiLevelRangeSet const & s) const
+{
+    int const level = std::max(std::max(getMaxLevel(), s.getMaxLevel()), 0);
+    return MultiLevelRangeSet(_flatten(level) & s._flatten(level), level);
+}
+
+MultiLevelRangeSet MultiLevelRangeSet::join(
+    MultiLevelRangeSet const & s) const
+{
+    int const level = std::max(std::max(getMaxLevel(), s.getMaxLevel()), 0);
+    return MultiLevelRangeSet(_flatten(level) | s._flatten(level), level);
+}
+
+MultiLevelRangeSet MultiLevelRangeSet::difference(
+    MultiLevelRangeSet const & s) const
+{
+    int const level = std::max(std::max(getMaxLevel(), s.getMaxLevel()), 0);
+    return MultiLevelRangeSet(_flatten(level) - s._flatten(level), level);
+}
+
+MultiLevelRangeSet MultiLevelRangeSet::symmetricDifference(
+    MultiLevelRangeSet const & s) const
+{
+    int const level = std::max(std::max(getMaxLevel(), s.getMaxLevel()), 0);
+    return MultiLevelRangeSet(_flatten(level) ^ s._flatten(level), level);
+}
+
+bool MultiLevelRangeSet::isValid() const {
+    if (!_levels.empty() && _levels.back().empty()) {
+        return false;
+    }
+    for (RangeSet const & s: _levels) {
+        if (!s.isValid()) {
+            return false;
+        }
+    }
+    // The pixels stored at different levels must be disjoint, and the
+    // representation must be the unique one.
+    int const level = std::max(getMaxLevel(), 0);
+    for (int i = 0; i <= getMaxLevel(); ++i) {
+        RangeSet a = _levels[i].scaled(
+            static_cast<uint64_t>(1) << 2 * (level - i));
+        for (int j = 0; j < i; ++j) {
+            RangeSet b = _levels[j].scaled(
+                static_cast<uint64_t>(1) << 2 * (level - j));
+            if (a.intersects(b)) {
+                return false;
+            }
+        }
+    }
+    return MultiLevelRangeSet(_flatten(level), level) == *this;
+}
+
+RangeSet MultiLevelRangeSet::_flatten(int level) const {
+    std::vector<RangeSet> sets;
+    sets.reserve(_levels.size());
+    for (int l = 0; l <= getMaxLevel(); ++l) {
+        sets.push_back(_levels[l].scaled(
+            static_cast<uint64_t>(1) << 2 * (level - l)));
+    }
+    return RangeSet::joinAll(sets);
+}
+
+std::ostream & operator<<(std::ostream & os, MultiLevelRangeSet const & s) {
+    os << "{\"MultiLevelRangeSet\": {";
+    bool first = true;
+    for (int l = 0; l <= s.getMaxLevel(); ++l) {
+        if (s.getCells(l).empty()) {
+            continue;
+        }
+        if (!first) {
+            os << ", ";
+        }
+        first = false;
+        os << '"' << l << "\": " << s.getCells(l);
+    }
+    os << "}}";
+    return os;
+}
+
+}} // namespace lsst::sphgeom
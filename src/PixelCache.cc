@@ -0,0 +1,113 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains the PixelCache implementation.
+
+#include "lsst/sphgeom/PixelCache.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace lsst {
+namespace sphgeom {
+
+PixelCache::PixelCache(size_t capacity) {
+    if (capacity == 0) {
+        throw std::invalid_argument("PixelCache capacity must be positive");
+    }
+    _entries.resize(capacity);
+    _slots.reserve(capacity);
+    _stats.capacity = capacity;
+}
+
+size_t PixelCache::find(Scheme scheme, int level, uint64_t index,
+                        UnitVector3d * vertices)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto i = _slots.find(_key(scheme, level, index));
+    if (i == _slots.end()) {
+        ++_stats.misses;
+        return 0;
+    }
+    ++_stats.hits;
+    Entry & e = _entries[i->second];
+    e.referenced = true;
+    std::copy(e.vertices, e.vertices + e.numVertices, vertices);
+    return e.numVertices;
+}
+
+void PixelCache::insert(Scheme scheme, int level, uint64_t index,
+                        UnitVector3d const * vertices, size_t n)
+{
+    if (n == 0 || n > MAX_VERTICES) {
+        throw std::invalid_argument("Invalid number of pixel vertices");
+    }
+    Key key = _key(scheme, level, index);
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto i = _slots.find(key);
+    size_t slot;
+    if (i != _slots.end()) {
+        // Another thread inserted the same pixel after our lookup missed.
+        slot = i->second;
+    } else {
+        if (_stats.size < _entries.size()) {
+            slot = _stats.size++;
+        } else {
+            // Sweep the clock hand over the entries, giving each recently
+            // referenced entry a second chance, until an entry that has not
+            // been referenced since the previous sweep is found. This
+            // terminates after at most one full revolution.
+            while (_entries[_hand].referenced) {
+                _entries[_hand].referenced = false;
+                _hand = (_hand + 1) % _entries.size();
+            }
+            slot = _hand;
+            _hand = (_hand + 1) % _entries.size();
+            _slots.erase(_entries[slot].key);
+            ++_stats.evictions;
+        }
+        _slots.emplace(key, slot);
+    }
+    Entry & e = _entries[slot];
+    e.key = key;
+    e.numVertices = static_cast<uint8_t>(n);
+    e.referenced = false;
+    std::copy(vertices, vertices + n, e.vertices);
+}
+
+PixelCache::Statistics PixelCache::getStatistics() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _stats;
+}
+
+void PixelCache::clear() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _slots.clear();
+    _hand = 0;
+    size_t capacity = _stats.capacity;
+    _stats = Statistics();
+    _stats.capacity = capacity;
+}
+
+}} // namespace lsst::sphgeom
@@ -26,6 +26,16 @@
 /// \file
 /// \brief This file provides a base class for pixel finders.
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "lsst/sphgeom/Pixelization.h"
 #include "lsst/sphgeom/RangeSet.h"
 
 #include "ConvexPolygonImpl.h"
@@ -35,13 +45,131 @@ namespace lsst {
 namespace sphgeom {
 namespace detail {
 
+// `simplify` rounds the ranges in `s` to multiples of 2^shift.
+//
+// When looking for intersecting pixels, ranges are simplified by expanding
+// them outwards, causing nearly adjacent small ranges to merge.
+//
+// When looking for interior pixels, ranges are simplified by shrinking them
+// inwards, causing small ranges to disappear.
+template <bool InteriorOnly>
+void simplify(RangeSet & s, int shift) {
+    if (InteriorOnly) {
+        s.complement();
+    }
+    s.simplify(shift);
+    if (InteriorOnly) {
+        s.complement();
+    }
+}
+
+
+// `RangeStream` coalesces ranges that are inserted in ascending order, and
+// passes the resulting maximal ranges to a sink.
+class RangeStream {
+public:
+    explicit RangeStream(std::function<void(uint64_t, uint64_t)> const & sink) :
+        _sink{&sink},
+        _first{0},
+        _last{0},
+        _empty{true}
+    {}
+
+    void insert(uint64_t first, uint64_t last) {
+        if (!_empty && first == _last) {
+            _last = last;
+            return;
+        }
+        flush();
+        _first = first;
+        _last = last;
+        _empty = false;
+    }
+
+    // `flush` emits the range being accumulated, if there is one.
+    void flush() {
+        if (!_empty) {
+            _empty = true;
+            (*_sink)(_first, _last);
+        }
+    }
+
+private:
+    std::function<void(uint64_t, uint64_t)> const * _sink;
+    uint64_t _first;
+    uint64_t _last;
+    bool _empty;
+};
+
+
+// `TraversalControl` enforces the limits on a (possibly multi-threaded)
+// pixel tree traversal. Pixel finders claim node visits from it in batches,
+// so that the deadline and cancellation flag are only checked once per
+// batch rather than once per node.
+class TraversalControl {
+public:
+    static constexpr uint64_t BATCH_SIZE = 256;
+
+    explicit TraversalControl(TraversalOptions const & options) :
+        _deadline{options.deadline},
+        _cancelled{options.cancelled},
+        _maxNodes{options.maxNodes == 0 ? options.maxNodes - 1 :
+                                          options.maxNodes},
+        _limited{options.cancelled != nullptr || options.maxNodes != 0 ||
+                 options.deadline !=
+                     std::chrono::steady_clock::time_point::max()},
+        _claimed{0},
+        _stopped{false}
+    {}
+
+    // `isLimited` returns false if the traversal can never stop early.
+    bool isLimited() const { return _limited; }
+
+    // `isStopped` returns true if the traversal has been stopped early.
+    bool isStopped() const { return _stopped.load(std::memory_order_relaxed); }
+
+    // `claim` returns the number of node visits granted to the caller, at
+    // most BATCH_SIZE. A return value of 0 means that the traversal must stop.
+    uint64_t claim() {
+        if (isStopped()) {
+            return 0;
+        }
+        if ((_cancelled != nullptr &&
+             _cancelled->load(std::memory_order_relaxed)) ||
+            std::chrono::steady_clock::now() >= _deadline) {
+            _stop();
+            return 0;
+        }
+        uint64_t c = _claimed.fetch_add(BATCH_SIZE, std::memory_order_relaxed);
+        if (c >= _maxNodes) {
+            _stop();
+            return 0;
+        }
+        uint64_t n = _maxNodes - c;
+        return n < BATCH_SIZE ? n : BATCH_SIZE;
+    }
+
+private:
+    std::chrono::steady_clock::time_point const _deadline;
+    std::atomic<bool> const * const _cancelled;
+    uint64_t const _maxNodes;
+    bool const _limited;
+    std::atomic<uint64_t> _claimed;
+    std::atomic<bool> _stopped;
+
+    void _stop() { _stopped.store(true, std::memory_order_relaxed); }
+};
+
+
 // `PixelFinder` is a CRTP base class that locates pixels intersecting a
 // region. It assumes a hierarchical pixelization, and that pixels are
 // convex spherical polygons with a fixed number of vertices.
 //
-// The algorithm used is top-down tree traversal, implemented via recursion
-// for simplicity. Subclasses must provide a method named `subdivide` with
-// the following signature:
+// The algorithm used is top-down, depth-first tree traversal. Rather than
+// recursing, pixels that remain to be processed are kept on an explicit
+// stack, which is preallocated to the maximum depth of the traversal.
+// Subclasses must provide a method named `subdivide` with the following
+// signature:
 //
 //      void subdivide(UnitVector3d const * pixel,
 //                     uint64_t index,
@@ -49,9 +177,25 @@ namespace detail {
 //
 // that subdivides a pixel into its children and then invokes visit() on
 // each child. Children should be visited in ascending index order to keep
-// RangeSet inserts efficient. The subclass is also responsible for
-// implementing a top-level method that invokes visit() on each root pixel,
-// or on some set of candidate pixels.
+// RangeSet inserts efficient. Subclasses must also provide a method named
+// `visitRoots` that invokes visit() on each root pixel, or on some set of
+// candidate pixels. Calling visit() merely schedules a pixel for processing,
+// which happens in the order that the pixels would be visited by a
+// recursive traversal.
+//
+// A traversal can be stopped early by a TraversalControl (see setControl()).
+// The pixels remaining on the stack are then added to the output when
+// looking for intersecting pixels, and discarded when looking for interior
+// pixels. Either way, the output remains correct, if coarse.
+//
+// Pixels are found in ascending index order, so instead of accumulating
+// them in a RangeSet, a finder can pass them on to a RangeStream as they
+// are found (see stream()). In that case the range count limit is ignored.
+//
+// For multi-threaded traversals, the tree is first expanded breadth-first by
+// a single finder that defers subdivision of pixels at a given level (see
+// defer()). The deferred pixels are then handed out to finders running on
+// other threads (see resume()), and their results are merged.
 //
 // The `RegionType` parameter avoids the need for virtual function calls to
 // determine the spatial relationship between pixels and the input region. The
@@ -67,6 +211,13 @@ template <
 >
 class PixelFinder {
 public:
+    // `Node` stores a pixel that remains to be processed.
+    struct Node {
+        UnitVector3d pixel[NumVertices];
+        uint64_t index;
+        int level;
+    };
+
     PixelFinder(RangeSet & ranges,
                 RegionType const & region,
                 int level,
@@ -75,21 +226,137 @@ public:
         _region{&region},
         _level{level},
         _desiredLevel{level},
-        _maxRanges{maxRanges == 0 ? maxRanges - 1 : maxRanges}
-    {}
+        _maxRanges{maxRanges == 0 ? maxRanges - 1 : maxRanges},
+        _deferred{nullptr},
+        _deferLevel{-1},
+        _stream{nullptr},
+        _control{nullptr},
+        _credits{~static_cast<uint64_t>(0)},
+        _nodesVisited{0},
+        _stopped{false}
+    {
+        // There are at most 8 root pixels, and processing a pixel replaces
+        // it with at most 4 children, so the stack depth is bounded by
+        // 8 + 3*level.
+        _stack.reserve(8 + 3 * static_cast<size_t>(std::max(level, 0)));
+    }
+
+    // `operator()` searches the pixel tree, starting from the root pixels.
+    void operator()() {
+        _push([this]() { static_cast<Derived *>(this)->visitRoots(); });
+        _run();
+    }
 
     void visit(UnitVector3d const * pixel,
                uint64_t index,
                int level)
     {
-        if (level > _level) {
+        _stack.push_back(Node());
+        Node & n = _stack.back();
+        std::copy(pixel, pixel + NumVertices, n.pixel);
+        n.index = index;
+        n.level = level;
+    }
+
+    int getLevel() const { return _level; }
+
+    uint64_t getNodesVisited() const { return _nodesVisited; }
+
+    // `limitLevel` lowers the subdivision level to at most `level`.
+    void limitLevel(int level) { _level = std::min(_level, level); }
+
+    // `stream` causes pixels to be inserted into `stream` rather than into
+    // the output RangeSet.
+    void stream(RangeStream & stream) { _stream = &stream; }
+
+    // `setControl` causes the traversal to obey the limits of `control`.
+    void setControl(TraversalControl * control) {
+        _control = control;
+        _credits = 0;
+    }
+
+    // `defer` causes pixels at the given level that would otherwise be
+    // subdivided to be appended to `nodes`.
+    void defer(std::vector<Node> & nodes, int level) {
+        _deferred = &nodes;
+        _deferLevel = level;
+    }
+
+    // `resume` continues the traversal from a deferred pixel.
+    void resume(Node const & n) {
+        if (n.level < _level && !_stopped) {
+            _push([this, &n]() {
+                static_cast<Derived *>(this)->subdivide(
+                    n.pixel, n.index, n.level);
+            });
+            _run();
+        } else if (!InteriorOnly) {
+            // Either the traversal has been stopped, or the subdivision level
+            // was reduced after n was deferred. Since n intersects the search
+            // region, so does its ancestor at the current subdivision level.
+            int level = std::min(n.level, _level);
+            _insert(n.index >> (2 * (n.level - level)), level);
+        }
+    }
+
+private:
+    RangeSet * _ranges;
+    RegionType const * _region;
+    int _level;
+    int const _desiredLevel;
+    size_t const _maxRanges;
+    std::vector<Node> _stack;
+    std::vector<Node> * _deferred;
+    int _deferLevel;
+    RangeStream * _stream;
+    TraversalControl * _control;
+    uint64_t _credits;
+    uint64_t _nodesVisited;
+    bool _stopped;
+
+    // `_push` calls f, which is expected to visit pixels in ascending index
+    // order, and then reverses the order of the newly visited pixels on the
+    // stack so that they are popped off in ascending index order.
+    template <typename F>
+    void _push(F f) {
+        size_t mark = _stack.size();
+        f();
+        std::reverse(_stack.begin() + mark, _stack.end());
+    }
+
+    void _run() {
+        while (!_stack.empty()) {
+            Node n = _stack.back();
+            _stack.pop_back();
+            _process(n);
+        }
+    }
+
+    void _process(Node const & n) {
+        if (n.level > _level) {
             // Nothing to do - the subdivision level has been reduced
             // or a pixel that completely contains the search region
             // has been found.
             return;
         }
+        if (_credits == 0) {
+            _credits = _control->claim();
+            _stopped = (_credits == 0);
+        }
+        if (_stopped) {
+            // The traversal has been stopped early. Pixels that have not
+            // been examined may intersect the search region, but cannot
+            // be assumed to be within it.
+            if (!InteriorOnly) {
+                _insert(n.index, n.level);
+            }
+            return;
+        }
+        --_credits;
+        ++_nodesVisited;
         // Determine the relationship between the pixel and the search region.
-        Relationship r = detail::relate(pixel, pixel + NumVertices, *_region);
+        Relationship r = detail::relate(n.pixel, n.pixel + NumVertices,
+                                        *_region);
         if ((r & DISJOINT) != 0) {
             // The pixel is disjoint from the search region.
             return;
@@ -97,48 +364,163 @@ public:
         if ((r & WITHIN) != 0) {
             // The tree traversal has reached a pixel that is entirely within
             // the search region.
-            _insert(index, level);
+            _insert(n.index, n.level);
             return;
-        } else if (level == _level) {
+        } else if (n.level == _level) {
             // The tree traversal has reached a leaf.
             if (!InteriorOnly) {
-                _insert(index, level);
+                _insert(n.index, n.level);
             }
             return;
         }
-        static_cast<Derived *>(this)->subdivide(pixel, index, level);
+        if (n.level == _deferLevel) {
+            _deferred->push_back(n);
+            return;
+        }
+        _push([this, &n]() {
+            static_cast<Derived *>(this)->subdivide(n.pixel, n.index, n.level);
+        });
     }
 
-private:
-    RangeSet * _ranges;
-    RegionType const * _region;
-    int _level;
-    int const _desiredLevel;
-    size_t const _maxRanges;
-
     void _insert(uint64_t index, int level) {
         int shift = 2 * (_desiredLevel - level);
+        if (_stream != nullptr) {
+            _stream->insert(index << shift, (index + 1) << shift);
+            return;
+        }
         _ranges->insert(index << shift, (index + 1) << shift);
         while (_ranges->size() > _maxRanges) {
-            // Reduce the subdivision level.
-            --_level;
+            // Reduce the subdivision level. It never drops below the level
+            // of the root pixels, since _process would then skip root pixels
+            // that have not been examined yet, even though the coarsened
+            // ranges need not cover them.
+            _level = std::max(_level - 1, 0);
             shift += 2;
-            // When looking for intersecting pixels, ranges are simplified
-            // by expanding them outwards, causing nearly adjacent small ranges
-            // to merge.
-            //
-            // When looking for interior pixels, ranges are simplified by
-            // shrinking them inwards, causing small ranges to disappear.
-            if (InteriorOnly) {
-                _ranges->complement();
+            simplify<InteriorOnly>(*_ranges, shift);
+        }
+    }
+};
+
+
+// `runFinder` runs a pixel finder of the given type over a region of the
+// corresponding type, possibly using multiple threads. If `stream` is not
+// null, pixels are passed to it rather than returned, and the traversal is
+// single-threaded.
+template <typename FinderType, bool InteriorOnly, typename RegionType>
+RangeSet runFinder(RegionType const & region,
+                   size_t maxRanges,
+                   int level,
+                   TraversalOptions const & options,
+                   RangeStream * stream)
+{
+    using Node = typename FinderType::Node;
+    RangeSet s;
+    TraversalControl control(options);
+    FinderType find(s, region, level, maxRanges);
+    if (control.isLimited()) {
+        find.setControl(&control);
+    }
+    unsigned int numThreads = options.numThreads;
+    if (numThreads == 0) {
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    std::vector<Node> nodes;
+    if (stream != nullptr) {
+        find.stream(*stream);
+        find();
+        stream->flush();
+    } else if (numThreads == 1 || level == 0) {
+        find();
+    } else {
+        // Expand the pixel tree breadth-first until there are enough
+        // subtrees to keep all threads busy, even if they are unbalanced.
+        std::vector<Node> parents;
+        find.defer(nodes, 0);
+        find();
+        for (int l = 1;
+             l < find.getLevel() && !nodes.empty() &&
+                 nodes.size() < 8 * numThreads;
+             ++l)
+        {
+            parents.clear();
+            parents.swap(nodes);
+            find.defer(nodes, l);
+            for (Node const & n: parents) {
+                find.resume(n);
+            }
+        }
+    }
+    uint64_t nodesVisited = find.getNodesVisited();
+    if (!nodes.empty()) {
+        // Search the deferred subtrees in parallel. Each thread has its own
+        // finder and output, and repeatedly claims the next unsearched
+        // subtree.
+        numThreads = static_cast<unsigned int>(
+            std::min<size_t>(numThreads, nodes.size()));
+        int const startLevel = find.getLevel();
+        std::vector<RangeSet> sets(numThreads);
+        std::vector<int> levels(numThreads, startLevel);
+        std::vector<uint64_t> visited(numThreads, 0);
+        std::vector<std::exception_ptr> errors(numThreads);
+        std::atomic<size_t> next(0);
+        auto work = [&](unsigned int t) {
+            try {
+                FinderType f(sets[t], region, level, maxRanges);
+                f.limitLevel(startLevel);
+                if (control.isLimited()) {
+                    f.setControl(&control);
+                }
+                for (size_t i = next++; i < nodes.size(); i = next++) {
+                    f.resume(nodes[i]);
+                }
+                levels[t] = f.getLevel();
+                visited[t] = f.getNodesVisited();
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        };
+        std::vector<std::thread> threads;
+        threads.reserve(numThreads - 1);
+        for (unsigned int t = 1; t < numThreads; ++t) {
+            try {
+                threads.emplace_back(work, t);
+            } catch (std::system_error const &) {
+                // Fall back to fewer threads - any subtrees left unclaimed
+                // are searched by the calling thread.
+                break;
+            }
+        }
+        work(0);
+        for (std::thread & t: threads) {
+            t.join();
+        }
+        for (std::exception_ptr const & e: errors) {
+            if (e) {
+                std::rethrow_exception(e);
             }
-            _ranges->simplify(shift);
-            if (InteriorOnly) {
-                _ranges->complement();
+        }
+        // Merge the per-thread results, and then coarsen the union until it
+        // satisfies the range count limit.
+        int minLevel = startLevel;
+        for (unsigned int t = 0; t < numThreads; ++t) {
+            s |= sets[t];
+            minLevel = std::min(minLevel, levels[t]);
+            nodesVisited += visited[t];
+        }
+        if (maxRanges != 0) {
+            int shift = 2 * (level - minLevel);
+            while (s.size() > maxRanges) {
+                shift += 2;
+                simplify<InteriorOnly>(s, shift);
             }
         }
     }
-};
+    if (options.stats != nullptr) {
+        options.stats->nodesVisited = nodesVisited;
+        options.stats->truncated = control.isStopped();
+    }
+    return s;
+}
 
 
 // `findPixels` implements pixel-finding for an arbitrary Region, given a
@@ -147,27 +529,31 @@ template <
     template <typename, bool> class Finder,
     bool InteriorOnly
 >
-RangeSet findPixels(Region const & r, size_t maxRanges, int level) {
-    RangeSet s;
+RangeSet findPixels(Region const & r,
+                    size_t maxRanges,
+                    int level,
+                    TraversalOptions const & options,
+                    RangeStream * stream = nullptr)
+{
     Circle const * c = nullptr;
     Ellipse const * e = nullptr;
     Box const * b = nullptr;
     if ((c = dynamic_cast<Circle const *>(&r))) {
-        Finder<Circle, InteriorOnly> find(s, *c, level, maxRanges);
-        find();
+        return runFinder<Finder<Circle, InteriorOnly>, InteriorOnly>(
+            *c, maxRanges, level, options, stream);
     } else if ((e = dynamic_cast<Ellipse const *>(&r))) {
-        Finder<Circle, InteriorOnly> find(
-            s, e->getBoundingCircle(), level, maxRanges);
-        find();
+        // Ellipses are converted to a form that makes relating them to
+        // pixels cheap (and far tighter than using a bounding circle).
+        EllipseCone cone(*e);
+        return runFinder<Finder<EllipseCone, InteriorOnly>, InteriorOnly>(
+            cone, maxRanges, level, options, stream);
     } else if ((b = dynamic_cast<Box const *>(&r))) {
-        Finder<Box, InteriorOnly> find(s, *b, level, maxRanges);
-        find();
-    } else {
-        Finder<ConvexPolygon, InteriorOnly> find(
-            s, dynamic_cast<ConvexPolygon const &>(r), level, maxRanges);
-        find();
+        return runFinder<Finder<Box, InteriorOnly>, InteriorOnly>(
+            *b, maxRanges, level, options, stream);
     }
-    return s;
+    return runFinder<Finder<ConvexPolygon, InteriorOnly>, InteriorOnly>(
+        dynamic_cast<ConvexPolygon const &>(r), maxRanges, level, options,
+        stream);
 }
 
 }}} // namespace lsst::sphgeom::detail
@@ -0,0 +1,68 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains the Pixelization class implementation.
+
+#include "lsst/sphgeom/Pixelization.h"
+
+#include <tuple>
+
+#include "lsst/sphgeom/UnitVector3d.h"
+
+
+namespace lsst {
+namespace sphgeom {
+
+void Pixelization::_index(UnitVector3d const * v,
+                          uint64_t * indexes,
+                          size_t n) const
+{
+    for (size_t i = 0; i < n; ++i) {
+        indexes[i] = index(v[i]);
+    }
+}
+
+void Pixelization::_index(double const * x,
+                          double const * y,
+                          double const * z,
+                          uint64_t * indexes,
+                          size_t n) const
+{
+    for (size_t i = 0; i < n; ++i) {
+        indexes[i] = index(UnitVector3d::fromNormalized(x[i], y[i], z[i]));
+    }
+}
+
+void Pixelization::_streamEnvelope(
+    Region const & r,
+    std::function<void(uint64_t, uint64_t)> const & sink,
+    TraversalOptions const & options) const
+{
+    TraversalOptions serial = options;
+    serial.numThreads = 1;
+    for (auto const & range: _envelope(r, 0, serial)) {
+        sink(std::get<0>(range), std::get<1>(range));
+    }
+}
+
+}} // namespace lsst::sphgeom
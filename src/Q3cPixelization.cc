@@ -26,6 +26,7 @@
 #include "lsst/sphgeom/Q3cPixelization.h"
 
 #include <stdexcept>
+#include <utility>
 
 #include "lsst/sphgeom/ConvexPolygon.h"
 #include "lsst/sphgeom/curve.h"
@@ -231,7 +232,7 @@ public:
         Base(ranges, region, level, maxRanges)
     {}
 
-    void operator()() {
+    void visitRoots() {
         UnitVector3d pixel[4];
         // Loop over cube faces
         for (uint64_t f = 0; f < 6; ++f) {
@@ -250,10 +251,34 @@ public:
     }
 };
 
+#if !defined(NO_SIMD) && defined(__x86_64__)
+
+// `indexPair` computes the Q3C indexes of the 2 unit vectors with
+// components given by the lanes of x, y and z.
+void indexPair(int level, __m128d x, __m128d y, __m128d z,
+               uint64_t * indexes)
+{
+    int face[2];
+    __m128d u, v;
+    faceCoordinates(x, y, z, FACE_NUM, FACE_COMP, FACE_CONST, face, u, v);
+    uint64_t m[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(m),
+                     faceToMorton(level, u, v));
+    for (int j = 0; j < 2; ++j) {
+        indexes[j] = (static_cast<uint64_t>(face[j]) << (2 * level)) | m[j];
+    }
+}
+
+#endif
+
 } // unnamed namespace
 
 
-Q3cPixelization::Q3cPixelization(int level) : _level{level} {
+Q3cPixelization::Q3cPixelization(int level,
+                                 std::shared_ptr<PixelCache> cache) :
+    _level{level},
+    _cache{std::move(cache)}
+{
     if (level < 0 || level > MAX_LEVEL) {
         throw std::invalid_argument("Q3C subdivision level not in [0, 30]");
     }
@@ -264,7 +289,7 @@ ConvexPolygon Q3cPixelization::quad(uint64_t i) const {
         throw std::invalid_argument("Invalid Q3C index");
     }
     UnitVector3d verts[4];
-    makeQuad(i, _level, verts);
+    _makeQuad(i, verts);
     return ConvexPolygon(verts[0], verts[1], verts[2], verts[3]);
 }
 
@@ -303,11 +328,24 @@ std::unique_ptr<Region> Q3cPixelization::pixel(uint64_t i) const {
         throw std::invalid_argument("Invalid Q3C index");
     }
     UnitVector3d verts[4];
-    makeQuad(i, _level, verts);
+    _makeQuad(i, verts);
     return std::unique_ptr<Region>(
         new ConvexPolygon(verts[0], verts[1], verts[2], verts[3]));
 }
 
+void Q3cPixelization::_makeQuad(uint64_t i, UnitVector3d * verts) const {
+    if (!_cache) {
+        makeQuad(i, _level, verts);
+        return;
+    }
+    int level = _level;
+    _cache->get(PixelCache::Scheme::Q3C, level, i, verts,
+                [i, level](UnitVector3d * v) {
+                    makeQuad(i, level, v);
+                    return size_t{4};
+                });
+}
+
 #if defined(NO_SIMD) || !defined(__x86_64__)
     uint64_t Q3cPixelization::index(UnitVector3d const & p) const {
         int face = faceNumber(p, FACE_NUM);
@@ -333,12 +371,70 @@ std::unique_ptr<Region> Q3cPixelization::pixel(uint64_t i) const {
     }
 #endif
 
-RangeSet Q3cPixelization::_envelope(Region const & r, size_t maxRanges) const {
-    return detail::findPixels<Q3cPixelFinder, false>(r, maxRanges, _level);
+void Q3cPixelization::_index(UnitVector3d const * v,
+                             uint64_t * indexes,
+                             size_t n) const
+{
+    size_t i = 0;
+#if !defined(NO_SIMD) && defined(__x86_64__)
+    for (; i + 2 <= n; i += 2) {
+        indexPair(_level,
+                  _mm_set_pd(v[i + 1].x(), v[i].x()),
+                  _mm_set_pd(v[i + 1].y(), v[i].y()),
+                  _mm_set_pd(v[i + 1].z(), v[i].z()),
+                  indexes + i);
+    }
+#endif
+    for (; i < n; ++i) {
+        indexes[i] = index(v[i]);
+    }
+}
+
+void Q3cPixelization::_index(double const * x,
+                             double const * y,
+                             double const * z,
+                             uint64_t * indexes,
+                             size_t n) const
+{
+    size_t i = 0;
+#if !defined(NO_SIMD) && defined(__x86_64__)
+    for (; i + 2 <= n; i += 2) {
+        indexPair(_level,
+                  _mm_loadu_pd(x + i),
+                  _mm_loadu_pd(y + i),
+                  _mm_loadu_pd(z + i),
+                  indexes + i);
+    }
+#endif
+    for (; i < n; ++i) {
+        indexes[i] = index(UnitVector3d::fromNormalized(x[i], y[i], z[i]));
+    }
+}
+
+RangeSet Q3cPixelization::_envelope(Region const & r,
+                                    size_t maxRanges,
+                                    TraversalOptions const & options) const
+{
+    return detail::findPixels<Q3cPixelFinder, false>(
+        r, maxRanges, _level, options);
 }
 
-RangeSet Q3cPixelization::_interior(Region const & r, size_t maxRanges) const {
-    return detail::findPixels<Q3cPixelFinder, true>(r, maxRanges, _level);
+RangeSet Q3cPixelization::_interior(Region const & r,
+                                    size_t maxRanges,
+                                    TraversalOptions const & options) const
+{
+    return detail::findPixels<Q3cPixelFinder, true>(
+        r, maxRanges, _level, options);
+}
+
+void Q3cPixelization::_streamEnvelope(
+    Region const & r,
+    std::function<void(uint64_t, uint64_t)> const & sink,
+    TraversalOptions const & options) const
+{
+    detail::RangeStream stream(sink);
+    detail::findPixels<Q3cPixelFinder, false>(
+        r, 0, _level, options, &stream);
 }
 
 }} // namespace lsst::sphgeom
@@ -354,6 +354,88 @@ double const FACE_SCALE[31] = {
         return _mm_or_pd(signbits, uv);
     }
 
+    // `faceCoordinates` computes the face numbers and face coordinates of
+    // 2 unit vectors at once. The components of the vectors are given by
+    // the lanes of x, y and z. On return, the u and v face coordinates of
+    // the vector with face number face[j] are stored in lane j of u and v.
+    // The arithmetic is identical to that performed by faceNumber() and the
+    // single point index() implementations.
+    void faceCoordinates(__m128d x, __m128d y, __m128d z,
+                         uint8_t const (&faceNumbers)[64],
+                         uint8_t const (&faceComponents)[6][4],
+                         double const (&faceConstants)[6][4],
+                         int (&face)[2], __m128d & u, __m128d & v)
+    {
+        __m128d const m0m0 = _mm_set1_pd(-0.0);
+        __m128d my = _mm_xor_pd(y, m0m0);
+        __m128d mz = _mm_xor_pd(z, m0m0);
+        int m5 = _mm_movemask_pd(_mm_cmpgt_pd(x, y));
+        int m4 = _mm_movemask_pd(_mm_cmpgt_pd(x, my));
+        int m3 = _mm_movemask_pd(_mm_cmpgt_pd(x, z));
+        int m2 = _mm_movemask_pd(_mm_cmpgt_pd(x, mz));
+        int m1 = _mm_movemask_pd(_mm_cmpgt_pd(y, z));
+        int m0 = _mm_movemask_pd(_mm_cmpgt_pd(y, mz));
+        double p[3][2];
+        _mm_storeu_pd(p[0], x);
+        _mm_storeu_pd(p[1], y);
+        _mm_storeu_pd(p[2], z);
+        // Assemble the LUT indexes of both vectors from the comparison
+        // result bit masks; bit j of each mask corresponds to lane j.
+        int index0 = ((m5 & 1) << 5) | ((m4 & 1) << 4) | ((m3 & 1) << 3) |
+                     ((m2 & 1) << 2) | ((m1 & 1) << 1) | (m0 & 1);
+        int index1 = ((m5 & 2) << 4) | ((m4 & 2) << 3) | ((m3 & 2) << 2) |
+                     ((m2 & 2) << 1) | (m1 & 2) | ((m0 & 2) >> 1);
+        face[0] = faceNumbers[index0];
+        face[1] = faceNumbers[index1];
+        int f0 = face[0];
+        int f1 = face[1];
+        __m128d w = _mm_andnot_pd(
+            m0m0,
+            _mm_set_pd(p[faceComponents[f1][2]][1],
+                       p[faceComponents[f0][2]][0]));
+        u = _mm_mul_pd(
+            _mm_div_pd(_mm_set_pd(p[faceComponents[f1][0]][1],
+                                  p[faceComponents[f0][0]][0]), w),
+            _mm_set_pd(faceConstants[f1][0], faceConstants[f0][0]));
+        v = _mm_mul_pd(
+            _mm_div_pd(_mm_set_pd(p[faceComponents[f1][1]][1],
+                                  p[faceComponents[f0][1]][0]), w),
+            _mm_set_pd(faceConstants[f1][1], faceConstants[f0][1]));
+    }
+
+    // `spreadBits` moves bit i of each 64 bit lane of x (where i < 32)
+    // to bit 2i, clearing all odd bits. See mortonIndex().
+    __m128i spreadBits(__m128i x) {
+        x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi64(x, 16)),
+                          _mm_set1_epi32(0x0000ffff));
+        x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi64(x, 8)),
+                          _mm_set1_epi32(0x00ff00ff));
+        x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi64(x, 4)),
+                          _mm_set1_epi32(0x0f0f0f0f));
+        x = _mm_and_si128(_mm_or_si128(x, _mm_slli_epi64(x, 2)),
+                          _mm_set1_epi32(0x33333333));
+        return _mm_and_si128(_mm_or_si128(x, _mm_slli_epi64(x, 1)),
+                             _mm_set1_epi32(0x55555555));
+    }
+
+    // `faceToMorton` converts the face coordinates of 2 points to grid
+    // coordinates at the given subdivision level, as in faceToGrid(), and
+    // returns the corresponding Morton indexes in the 64 bit lanes of the
+    // result.
+    __m128i faceToMorton(int level, __m128d u, __m128d v) {
+        __m128d const gridScale = _mm_set1_pd(GRID_SCALE[level]);
+        __m128d const stMax = _mm_set1_pd(ST_MAX[level]);
+        __m128d s = _mm_add_pd(_mm_mul_pd(u, gridScale), gridScale);
+        __m128d t = _mm_add_pd(_mm_mul_pd(v, gridScale), gridScale);
+        s = _mm_min_pd(_mm_max_pd(s, _mm_setzero_pd()), stMax);
+        t = _mm_min_pd(_mm_max_pd(t, _mm_setzero_pd()), stMax);
+        __m128i ss = _mm_unpacklo_epi32(_mm_cvttpd_epi32(s),
+                                        _mm_setzero_si128());
+        __m128i tt = _mm_unpacklo_epi32(_mm_cvttpd_epi32(t),
+                                        _mm_setzero_si128());
+        return _mm_or_si128(spreadBits(ss), _mm_slli_epi64(spreadBits(tt), 1));
+    }
+
 #endif
 
 } // unnamed namespace
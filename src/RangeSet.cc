@@ -26,7 +26,15 @@
 #include "lsst/sphgeom/RangeSet.h"
 
 #include <algorithm>
+#include <memory>
 #include <ostream>
+#include <stdexcept>
+#include <thread>
+
+#include "lsst/sphgeom/RangeSetView.h"
+#include "lsst/sphgeom/codec.h"
+
+#include "parallel.h"
 
 
 namespace lsst {
@@ -88,9 +96,155 @@ struct RangeIter {
     uint64_t * ptr = nullptr;
 };
 
+// `skipDown` returns a pointer p into the sorted array [first, last) such
+// that the values in [p, last) are all greater than u, and those in
+// [first, p) are not. It gallops down from last, so that it takes O(log k)
+// time, where k = last - p.
+uint64_t const * skipDown(uint64_t const * first,
+                          uint64_t const * last,
+                          uint64_t u)
+{
+    uint64_t const * hi = last;
+    size_t step = 1;
+    while (step <= static_cast<size_t>(hi - first) && hi[-step] > u) {
+        hi -= step;
+        step *= 2;
+    }
+    uint64_t const * lo =
+        (step <= static_cast<size_t>(hi - first)) ? hi - step : first;
+    return std::upper_bound(lo, hi, u);
+}
+
+// `radixSort` sorts the n > 0 integers in `values` using an LSD radix sort
+// with 8 bit digits and numThreads threads. The buffers a and b must each
+// have room for n integers. The return value points to the sorted
+// integers, and is equal to one of values, a or b.
+uint64_t const * radixSort(uint64_t const * values,
+                           size_t n,
+                           uint64_t * a,
+                           uint64_t * b,
+                           unsigned int numThreads)
+{
+    static size_t const DIGITS = 8;
+    static size_t const RADIX = 256;
+    size_t const T = numThreads;
+    auto chunkBegin = [n, T](size_t t) {
+        return n / T * t + std::min(t, n % T);
+    };
+    // Each thread computes histograms of all digits for a contiguous chunk
+    // of the input in a single pass.
+    std::vector<size_t> hist(T * DIGITS * RADIX, 0);
+    runInParallel(numThreads, [&](unsigned int t) {
+        size_t * h = &hist[t * DIGITS * RADIX];
+        for (size_t i = chunkBegin(t), e = chunkBegin(t + 1); i < e; ++i) {
+            uint64_t const v = values[i];
+            for (size_t d = 0; d < DIGITS; ++d) {
+                ++h[d * RADIX + ((v >> (8 * d)) & 0xff)];
+            }
+        }
+    });
+    std::vector<size_t> offsets(T * RADIX);
+    uint64_t const * src = values;
+    uint64_t * dst = a;
+    for (size_t d = 0; d < DIGITS; ++d) {
+        int const shift = static_cast<int>(8 * d);
+        // Skip digits that are the same for all values. For pixel indexes,
+        // which are usually much smaller than 2^64, this avoids several
+        // passes over the data.
+        size_t total[RADIX] = {};
+        for (size_t t = 0; t < T; ++t) {
+            for (size_t r = 0; r < RADIX; ++r) {
+                total[r] += hist[(t * DIGITS + d) * RADIX + r];
+            }
+        }
+        if (std::find(total, total + RADIX, n) != total + RADIX) {
+            continue;
+        }
+        // Compute the output position of the first value with each digit
+        // in each chunk. The per-chunk histograms from the first pass are
+        // only valid if the chunks still hold the same values.
+        if (src != values && T > 1) {
+            runInParallel(numThreads, [&](unsigned int t) {
+                size_t * h = &offsets[t * RADIX];
+                size_t const e = chunkBegin(t + 1);
+                std::fill(h, h + RADIX, 0);
+                for (size_t i = chunkBegin(t); i < e; ++i) {
+                    ++h[(src[i] >> shift) & 0xff];
+                }
+            });
+        } else {
+            for (size_t t = 0; t < T; ++t) {
+                std::copy(&hist[(t * DIGITS + d) * RADIX],
+                          &hist[(t * DIGITS + d + 1) * RADIX],
+                          &offsets[t * RADIX]);
+            }
+        }
+        size_t sum = 0;
+        for (size_t r = 0; r < RADIX; ++r) {
+            for (size_t t = 0; t < T; ++t) {
+                size_t c = offsets[t * RADIX + r];
+                offsets[t * RADIX + r] = sum;
+                sum += c;
+            }
+        }
+        // Scatter values to their output positions. Since chunks are
+        // processed in order, the sort is stable.
+        runInParallel(numThreads, [&](unsigned int t) {
+            size_t * o = &offsets[t * RADIX];
+            for (size_t i = chunkBegin(t), e = chunkBegin(t + 1); i < e; ++i) {
+                uint64_t const v = src[i];
+                dst[o[(v >> shift) & 0xff]++] = v;
+            }
+        });
+        src = dst;
+        dst = (dst == a) ? b : a;
+    }
+    return src;
+}
+
 } // unnamed namespace
 
 
+constexpr uint8_t RangeSet::TYPE_CODE;
+constexpr size_t RangeSet::BLOCK_SIZE;
+constexpr unsigned RangeSet::AND;
+constexpr unsigned RangeSet::OR;
+constexpr unsigned RangeSet::AND_NOT;
+constexpr unsigned RangeSet::NOT_AND;
+constexpr unsigned RangeSet::XOR;
+constexpr size_t RangeSet::Storage::INLINE_CAPACITY;
+
+void RangeSet::Storage::_grow(size_t n) {
+    // Grow geometrically, so that appending values runs in amortized
+    // constant time.
+    size_t c = std::max(n, 2 * capacity());
+    uint64_t * data = new uint64_t[c];
+    uint64_t * end = std::copy(_begin, _end, data);
+    _release();
+    _begin = data;
+    _end = end;
+    _capEnd = data + c;
+}
+
+void RangeSet::Storage::_growAndAppend(uint64_t u) {
+    _grow(size() + 1);
+    *_end++ = u;
+}
+
+uint64_t * RangeSet::Storage::insert(uint64_t * pos,
+                                     uint64_t const * first,
+                                     uint64_t const * last)
+{
+    ptrdiff_t i = pos - _begin;
+    ptrdiff_t n = last - first;
+    reserve(size() + n);
+    pos = _begin + i;
+    std::copy_backward(pos, _end, _end + n);
+    std::copy(first, last, pos);
+    _end += n;
+    return pos;
+}
+
 RangeSet::RangeSet(std::initializer_list<uint64_t> list) :
     RangeSet(list.begin(), list.end())
 {}
@@ -238,6 +392,213 @@ RangeSet RangeSet::symmetricDifference(RangeSet const & s) const {
     return result;
 }
 
+RangeSet RangeSet::fromValues(uint64_t const * values,
+                              size_t n,
+                              unsigned int numThreads)
+{
+    // Inputs smaller than this are sorted with std::sort, and each thread
+    // used by the radix sort handles at least this many values.
+    static size_t const MIN_RADIX_SORT_SIZE = 1 << 16;
+    RangeSet result;
+    if (n == 0) {
+        return result;
+    }
+    std::unique_ptr<uint64_t[]> buffer;
+    uint64_t const * sorted = values;
+    if (!std::is_sorted(values, values + n)) {
+        if (n < MIN_RADIX_SORT_SIZE) {
+            buffer.reset(new uint64_t[n]);
+            std::copy(values, values + n, buffer.get());
+            std::sort(buffer.get(), buffer.get() + n);
+            sorted = buffer.get();
+        } else {
+            if (numThreads == 0) {
+                numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+            }
+            numThreads = static_cast<unsigned int>(std::max<size_t>(
+                1, std::min<size_t>(numThreads, n / MIN_RADIX_SORT_SIZE)));
+            buffer.reset(new uint64_t[2 * n]);
+            sorted = radixSort(values, n, buffer.get(), buffer.get() + n,
+                               numThreads);
+        }
+    }
+    // Count the runs of consecutive integers. Each contributes a beginning
+    // and end point, except that a run beginning at 0 or ending at
+    // 2^64 - 1 shares them with the leading or trailing bookend.
+    size_t runs = 1;
+    for (size_t i = 1; i < n; ++i) {
+        runs += (sorted[i] - sorted[i - 1] > 1);
+    }
+    bool const first = (sorted[0] == 0);
+    bool const last = (sorted[n - 1] == ~static_cast<uint64_t>(0));
+    result._ranges.resize(2 * runs + 2 - first - last);
+    uint64_t * out = result._ranges.data();
+    *out++ = 0;
+    if (!first) {
+        *out++ = sorted[0];
+    }
+    for (size_t i = 1; i < n; ++i) {
+        if (sorted[i] - sorted[i - 1] > 1) {
+            *out++ = sorted[i - 1] + 1;
+            *out++ = sorted[i];
+        }
+    }
+    if (!last) {
+        *out++ = sorted[n - 1] + 1;
+    }
+    *out = 0;
+    result._offset = !first;
+    return result;
+}
+
+void RangeSet::intersection(RangeSet const & s, RangeSet & out) const {
+    if (this == &s) {
+        out = s;
+    } else if (&out == &s) {
+        out._merge(s, *this, AND);
+    } else {
+        out._merge(*this, s, AND);
+    }
+}
+
+void RangeSet::join(RangeSet const & s, RangeSet & out) const {
+    if (this == &s) {
+        out = s;
+    } else if (&out == &s) {
+        out._merge(s, *this, OR);
+    } else {
+        out._merge(*this, s, OR);
+    }
+}
+
+void RangeSet::difference(RangeSet const & s, RangeSet & out) const {
+    if (this == &s) {
+        out.clear();
+    } else if (&out == &s) {
+        out._merge(s, *this, NOT_AND);
+    } else {
+        out._merge(*this, s, AND_NOT);
+    }
+}
+
+void RangeSet::symmetricDifference(RangeSet const & s, RangeSet & out) const {
+    if (this == &s) {
+        out.clear();
+    } else if (&out == &s) {
+        out._merge(s, *this, XOR);
+    } else {
+        out._merge(*this, s, XOR);
+    }
+}
+
+RangeSet RangeSet::coveredByAtLeast(RangeSet const * sets,
+                                    size_t n,
+                                    size_t m)
+{
+    RangeSet result;
+    if (m == 0) {
+        result.fill();
+        return result;
+    }
+    if (m > n) {
+        return result;
+    }
+    // Sweep through the beginning and end points of the ranges from all
+    // n sets in ascending order, using a min-heap of per-set cursors.
+    // Passing through a point toggles the corresponding set's state, and
+    // count tracks the number of sets containing the current position of
+    // the sweep. The values between the bookends of a set are non-zero and
+    // strictly increasing, so trailing bookends need no special handling
+    // here: a cursor is simply retired when it reaches one.
+    struct Cursor {
+        uint64_t value;
+        uint64_t const * p;
+        uint64_t const * end;
+        bool inside;
+    };
+    std::vector<Cursor> heap;
+    heap.reserve(n);
+    size_t count = 0;
+    // The number of sets with remaining points that do not contain the
+    // current position. If count + outside < m, the sweep can stop early.
+    size_t outside = 0;
+    size_t total = 0;
+    for (size_t i = 0; i < n; ++i) {
+        bool inside = !sets[i]._offset;
+        uint64_t const * p = sets[i]._ranges.begin() + 1;
+        uint64_t const * end = sets[i]._ranges.end() - 1;
+        count += inside;
+        if (p != end) {
+            heap.push_back(Cursor{*p, p, end, inside});
+            outside += !inside;
+            total += static_cast<size_t>(end - p);
+        }
+    }
+    // `siftDown` restores the heap property (smallest value first) for the
+    // subtree rooted at position i, assuming it holds for both children.
+    auto siftDown = [&heap](size_t i) {
+        size_t const size = heap.size();
+        Cursor c = heap[i];
+        while (true) {
+            size_t child = 2 * i + 1;
+            if (child >= size) {
+                break;
+            }
+            if (child + 1 < size &&
+                heap[child + 1].value < heap[child].value) {
+                ++child;
+            }
+            if (c.value <= heap[child].value) {
+                break;
+            }
+            heap[i] = heap[child];
+            i = child;
+        }
+        heap[i] = c;
+    };
+    for (size_t i = heap.size() / 2; i > 0; --i) {
+        siftDown(i - 1);
+    }
+    bool state = (count >= m);
+    result._offset = !state;
+    // The output cannot have more points than all inputs combined.
+    result._ranges.reserve(total + 2);
+    result._ranges = {0};
+    while (!heap.empty() && (state || count + outside >= m)) {
+        uint64_t const v = heap.front().value;
+        // Advance all cursors positioned at v.
+        do {
+            Cursor & c = heap.front();
+            if (c.inside) {
+                --count;
+                ++outside;
+            } else {
+                ++count;
+                --outside;
+            }
+            c.inside = !c.inside;
+            if (++c.p != c.end) {
+                c.value = *c.p;
+            } else {
+                outside -= !c.inside;
+                c = heap.back();
+                heap.pop_back();
+                if (heap.empty()) {
+                    break;
+                }
+            }
+            siftDown(0);
+        } while (heap.front().value == v);
+        // Output v if the output state changes.
+        if ((count >= m) != state) {
+            result._ranges.push_back(v);
+            state = !state;
+        }
+    }
+    result._ranges.push_back(0);
+    return result;
+}
+
 bool RangeSet::intersects(uint64_t first, uint64_t last) const {
     if (empty()) {
         return false;
@@ -284,6 +645,104 @@ bool RangeSet::contains(RangeSet const & s) const {
     return !_intersects(_beginc(), _endc(), s._begin(), s._end());
 }
 
+void RangeSet::contains(uint64_t const * values,
+                        size_t n,
+                        uint64_t * result) const
+{
+    // An integer u is in this set iff the number of range end points less
+    // than or equal to u (excluding the bookends) is even for sets not
+    // containing 0, and odd for sets containing 0. The count is obtained
+    // with a branch-free binary search, which always takes the same number
+    // of steps for a given set. This allows LANES searches to proceed in
+    // lockstep, so that the CPU can overlap their memory accesses, rather
+    // than waiting on the load from each step of one search before
+    // starting the next.
+    static size_t const LANES = 8;
+    uint64_t const * const points = _ranges.begin() + 1;
+    size_t const m = _ranges.size() - 2;
+    uint64_t const flip = _offset ? 0 : 1;
+    for (size_t i = 0; i < n; i += 64) {
+        size_t const k = std::min<size_t>(64, n - i);
+        uint64_t const * v = values + i;
+        uint64_t bits = 0;
+        if (m == 0) {
+            bits = flip ? ~static_cast<uint64_t>(0) : 0;
+        } else {
+            size_t j = 0;
+            for (; j + LANES <= k; j += LANES) {
+                uint64_t const * base[LANES];
+                for (size_t l = 0; l < LANES; ++l) {
+                    base[l] = points;
+                }
+                for (size_t len = m; len > 1; len -= len / 2) {
+                    size_t const half = len / 2;
+                    for (size_t l = 0; l < LANES; ++l) {
+                        base[l] += (base[l][half] <= v[j + l]) ? half : 0;
+                    }
+                }
+                for (size_t l = 0; l < LANES; ++l) {
+                    uint64_t c = static_cast<uint64_t>(base[l] - points) +
+                                 (*base[l] <= v[j + l]);
+                    bits |= ((c & 1) ^ flip) << (j + l);
+                }
+            }
+            for (; j < k; ++j) {
+                uint64_t const * base = points;
+                for (size_t len = m; len > 1; len -= len / 2) {
+                    size_t const half = len / 2;
+                    base += (base[half] <= v[j]) ? half : 0;
+                }
+                uint64_t c = static_cast<uint64_t>(base - points) +
+                             (*base <= v[j]);
+                bits |= ((c & 1) ^ flip) << j;
+            }
+        }
+        if (k < 64) {
+            bits &= (static_cast<uint64_t>(1) << k) - 1;
+        }
+        result[i / 64] = bits;
+    }
+}
+
+void RangeSet::containsSorted(uint64_t const * values,
+                              size_t n,
+                              uint64_t * result) const
+{
+    // Merge the values with the range end points of this set. The merge
+    // gallops through the end points, so that it takes O(log k) time to
+    // skip over k of them. This makes it efficient for both dense and
+    // sparse values.
+    uint64_t const * const points = _ranges.begin() + 1;
+    uint64_t const * const end = _ranges.end() - 1;
+    uint64_t const flip = _offset ? 0 : 1;
+    uint64_t const * p = points;
+    uint64_t previous = 0;
+    for (size_t i = 0; i < n; i += 64) {
+        size_t const k = std::min<size_t>(64, n - i);
+        uint64_t bits = 0;
+        for (size_t j = 0; j < k; ++j) {
+            uint64_t const u = values[i + j];
+            if (u < previous) {
+                throw std::invalid_argument("Values are not sorted");
+            }
+            previous = u;
+            if (p != end && *p <= u) {
+                // Find the first end point greater than u.
+                size_t step = 1;
+                while (step < static_cast<size_t>(end - p) && p[step] <= u) {
+                    p += step;
+                    step *= 2;
+                }
+                uint64_t const * hi =
+                    (step < static_cast<size_t>(end - p)) ? p + step : end;
+                p = std::upper_bound(p + 1, hi, u);
+            }
+            bits |= ((static_cast<uint64_t>(p - points) & 1) ^ flip) << j;
+        }
+        result[i / 64] = bits;
+    }
+}
+
 bool RangeSet::isWithin(uint64_t first, uint64_t last) const {
     if (empty() || first == last) {
         return true;
@@ -374,6 +833,122 @@ RangeSet & RangeSet::scale(uint64_t i) {
     return *this;
 }
 
+std::vector<uint8_t> RangeSet::encode() const {
+    // The range end points are the values between the bookends.
+    uint64_t const * p = _ranges.begin() + 1;
+    size_t const m = _ranges.size() - 2;
+    std::vector<uint8_t> index;
+    std::vector<uint8_t> points;
+    index.reserve(16 * (m / BLOCK_SIZE));
+    points.reserve(m + m / 2);
+    uint64_t previous = 0;
+    for (size_t i = 0; i < m; ++i) {
+        if (i != 0 && i % BLOCK_SIZE == 0) {
+            encodeU64(previous, index);
+            encodeU64(points.size(), index);
+        }
+        encodeVarint(p[i] - previous - 1, points);
+        previous = p[i];
+    }
+    std::vector<uint8_t> buffer;
+    buffer.reserve(12 + index.size() + points.size());
+    buffer.push_back(TYPE_CODE);
+    buffer.push_back(_offset ? 0 : 1);
+    encodeVarint(m, buffer);
+    buffer.insert(buffer.end(), index.begin(), index.end());
+    buffer.insert(buffer.end(), points.begin(), points.end());
+    return buffer;
+}
+
+RangeSet RangeSet::decode(uint8_t const * buffer, size_t n) {
+    return RangeSetView(buffer, n).decode();
+}
+
+void RangeSet::_merge(RangeSet const & sa, RangeSet const & sb, unsigned op) {
+    // Sweep through the beginning and end points of the ranges from sets
+    // A = sa and B = sb, as in symmetricDifference, but in descending
+    // order. The output state for input states a and b is bit 2a + b of
+    // the truth table op.
+    //
+    // There are at most m = ma + mb output points, where ma and mb are the
+    // numbers of points in A and B. After growing the storage of this set
+    // to hold m points between the bookends, the output is written from
+    // the end of the storage towards the beginning, and then moved to the
+    // beginning. If this set is A, the output never overwrites a point of
+    // A that has not been consumed yet, because the number of points
+    // written is at most the number consumed from both A and B.
+    //
+    // Growing the storage is the only operation that can throw, and it
+    // happens before anything is modified, so the strong exception safety
+    // guarantee is provided.
+    size_t const ma = sa._ranges.size() - 2;
+    size_t const mb = sb._ranges.size() - 2;
+    unsigned const azero = !sa._offset;
+    unsigned const bzero = !sb._offset;
+    _ranges.resize(ma + mb + 2);
+    uint64_t * const data = _ranges.data();
+    uint64_t const * const a = sa._ranges.data() + 1;
+    uint64_t const * const b = sb._ranges.data() + 1;
+    uint64_t const * ap = a + ma;
+    uint64_t const * bp = b + mb;
+    uint64_t * const out = data + 1 + ma + mb;
+    uint64_t * w = out;
+    // The input states above the largest points.
+    unsigned astate = azero ^ (ma & 1);
+    unsigned bstate = bzero ^ (mb & 1);
+    unsigned state = (op >> (2 * astate + bstate)) & 1;
+    unsigned const zero = (op >> (2 * azero + bzero)) & 1;
+    while (ap != a || bp != b) {
+        // If toggling the state of one input would not change the output
+        // state, its points above the largest remaining point of the other
+        // input can be skipped. This makes intersecting a large set with a
+        // small one, for example, take time logarithmic in the size of the
+        // large set.
+        if (ap != a && (bp == b || ap[-1] > bp[-1]) &&
+            ((op >> (2 * astate + bstate)) & 1) ==
+            ((op >> (2 * (astate ^ 1) + bstate)) & 1)) {
+            uint64_t const * p = skipDown(a, ap, bp == b ? 0 : bp[-1]);
+            astate ^= (ap - p) & 1;
+            ap = p;
+            continue;
+        }
+        if (bp != b && (ap == a || bp[-1] > ap[-1]) &&
+            ((op >> (2 * astate + bstate)) & 1) ==
+            ((op >> (2 * astate + (bstate ^ 1))) & 1)) {
+            uint64_t const * p = skipDown(b, bp, ap == a ? 0 : ap[-1]);
+            bstate ^= (bp - p) & 1;
+            bp = p;
+            continue;
+        }
+        uint64_t v;
+        if (bp == b || (ap != a && ap[-1] > bp[-1])) {
+            v = ap[-1];
+        } else {
+            v = bp[-1];
+        }
+        if (ap != a && ap[-1] == v) {
+            --ap;
+            astate ^= 1;
+        }
+        if (bp != b && bp[-1] == v) {
+            --bp;
+            bstate ^= 1;
+        }
+        unsigned st = (op >> (2 * astate + bstate)) & 1;
+        if (st != state) {
+            *--w = v;
+            state = st;
+        }
+    }
+    size_t const n = static_cast<size_t>(out - w);
+    if (w != data + 1) {
+        std::copy(w, out, data + 1);
+    }
+    data[n + 1] = 0;
+    _ranges.resize(n + 2);
+    _offset = (zero == 0);
+}
+
 bool RangeSet::isValid() const {
     // Bookends are mandatory.
     if (_ranges.size() < 2) {
@@ -476,7 +1051,7 @@ void RangeSet::_insert(uint64_t first, uint64_t last) {
 
 /// `_intersectOne` stores the intersection of the single range pointed
 /// to by `a` and the ranges pointed to by `b` in `v`.
-void RangeSet::_intersectOne(std::vector<uint64_t> & v,
+void RangeSet::_intersectOne(Storage & v,
                              uint64_t const * a,
                              uint64_t const * b,
                              uint64_t const * bend)
@@ -513,7 +1088,7 @@ void RangeSet::_intersectOne(std::vector<uint64_t> & v,
 
 /// `_intersect` stores the intersection of the ranges pointed to by `a`
 /// and the ranges pointed to by `b` in `v`.
-void RangeSet::_intersect(std::vector<uint64_t> & v,
+void RangeSet::_intersect(Storage & v,
                           uint64_t const * a,
                           uint64_t const * aend,
                           uint64_t const * b,
@@ -0,0 +1,351 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains the RangeSetView implementation.
+
+#include "lsst/sphgeom/RangeSetView.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "lsst/sphgeom/codec.h"
+
+
+namespace lsst {
+namespace sphgeom {
+
+namespace {
+
+void throwInvalidEncoding() {
+    throw std::runtime_error("Byte-string is not an encoded RangeSet");
+}
+
+// `PointStream` iterates over the range end points of a RangeSet, that is,
+// the values in its internal vector other than the leading and trailing
+// zero bookends. Like RangeSetView::Stream, it tracks whether the integers
+// between the last end point consumed and the next one are in the set.
+class PointStream {
+public:
+    PointStream(uint64_t const * begin, uint64_t const * end, bool inside) :
+        _p{begin}, _end{end}, _inside{inside} {}
+
+    bool inside() const { return _inside; }
+    bool hasNext() const { return _p != _end; }
+    uint64_t next() const { return *_p; }
+
+    void advance() {
+        ++_p;
+        _inside = !_inside;
+    }
+
+    // `skipThrough` consumes all end points less than or equal to u.
+    void skipThrough(uint64_t u) {
+        if (_p == _end || *_p > u) {
+            return;
+        }
+        // Gallop forward to bracket the first end point greater than u,
+        // then binary search for it. This takes O(log k) time, where k is
+        // the number of end points skipped.
+        uint64_t const * lo = _p;
+        size_t step = 1;
+        while (step < static_cast<size_t>(_end - lo) && lo[step] <= u) {
+            lo += step;
+            step *= 2;
+        }
+        uint64_t const * hi =
+            (step < static_cast<size_t>(_end - lo)) ? lo + step : _end;
+        uint64_t const * p = std::upper_bound(lo + 1, hi, u);
+        _inside ^= ((p - _p) & 1) != 0;
+        _p = p;
+    }
+
+private:
+    uint64_t const * _p;
+    uint64_t const * _end;
+    bool _inside;
+};
+
+// `intersects` checks whether the sets with end points streamed by
+// a and b intersect.
+template <typename A, typename B>
+bool intersects(A & a, B & b) {
+    // Both streams are positioned at the same value. If a is not inside
+    // its set, nothing can intersect it until its next end point, so b can
+    // skip ahead to that point, and vice versa.
+    while (true) {
+        if (a.inside()) {
+            if (b.inside()) {
+                return true;
+            }
+            if (!b.hasNext()) {
+                return false;
+            }
+            uint64_t v = b.next();
+            b.advance();
+            a.skipThrough(v);
+        } else {
+            if (!a.hasNext()) {
+                return false;
+            }
+            uint64_t v = a.next();
+            a.advance();
+            b.skipThrough(v);
+        }
+    }
+}
+
+// `intersect` appends the end points of the intersection of the sets with
+// end points streamed by a and b to `points`, and returns true if the
+// intersection contains 0.
+template <typename A, typename B, typename Points>
+bool intersect(A & a, B & b, Points & points) {
+    bool const containsZero = a.inside() && b.inside();
+    bool state = containsZero;
+    while (true) {
+        uint64_t v;
+        if (!a.inside()) {
+            if (!a.hasNext()) {
+                break;
+            }
+            v = a.next();
+            a.advance();
+            b.skipThrough(v);
+        } else if (!b.inside()) {
+            if (!b.hasNext()) {
+                break;
+            }
+            v = b.next();
+            b.advance();
+            a.skipThrough(v);
+        } else {
+            if (a.hasNext()) {
+                v = b.hasNext() ? std::min(a.next(), b.next()) : a.next();
+            } else if (b.hasNext()) {
+                v = b.next();
+            } else {
+                break;
+            }
+            a.skipThrough(v);
+            b.skipThrough(v);
+        }
+        bool s = a.inside() && b.inside();
+        if (s != state) {
+            points.push_back(v);
+            state = s;
+        }
+    }
+    return containsZero;
+}
+
+} // unnamed namespace
+
+
+// `RangeSetView::Stream` iterates over the range end points of a viewed set,
+// decoding them on the fly.
+class RangeSetView::Stream {
+public:
+    // If `complement` is true, the stream is over the complement of the
+    // viewed set, which has the same end points.
+    Stream(RangeSetView const & view, bool complement) :
+        _view{&view},
+        _p{view._points},
+        _i{0},
+        _next{0},
+        _inside{view._containsZero != complement}
+    {
+        if (hasNext()) {
+            _decode();
+        }
+    }
+
+    bool inside() const { return _inside; }
+    bool hasNext() const { return _i < _view->_numPoints; }
+    uint64_t next() const { return _next; }
+
+    void advance() {
+        _inside = !_inside;
+        if (++_i < _view->_numPoints) {
+            _decode();
+        }
+    }
+
+    // `skipThrough` consumes all end points less than or equal to u.
+    void skipThrough(uint64_t u) {
+        if (!hasNext() || _next > u) {
+            return;
+        }
+        // If u lies beyond the block containing the next end point, use
+        // the index to jump to the block containing u. Most skips are
+        // short, so check the next index entry before searching them all.
+        size_t j = static_cast<size_t>(_i / RangeSet::BLOCK_SIZE) + 1;
+        if (j < _view->_numBlocks &&
+            decodeU64(_view->_index + 16 * (j - 1)) <= u) {
+            j = _view->_findBlock(u);
+        } else {
+            j = 0;
+        }
+        uint64_t i = static_cast<uint64_t>(j) * RangeSet::BLOCK_SIZE;
+        if (i > _i) {
+            uint8_t const * entry = _view->_index + 16 * (j - 1);
+            uint64_t offset = decodeU64(entry + 8);
+            if (offset >= static_cast<uint64_t>(_view->_end - _view->_points)) {
+                throwInvalidEncoding();
+            }
+            _inside ^= ((i - _i) & 1) != 0;
+            _i = i;
+            _p = _view->_points + offset;
+            _next = decodeU64(entry);
+            _decode();
+        }
+        while (_next <= u) {
+            advance();
+            if (!hasNext()) {
+                break;
+            }
+        }
+    }
+
+private:
+    // `_decode` decodes the next end point, given the previous one.
+    void _decode() {
+        uint64_t delta;
+        if (!decodeVarint(_p, _view->_end, delta) || delta >= ~_next) {
+            throwInvalidEncoding();
+        }
+        _next += delta + 1;
+    }
+
+    RangeSetView const * _view;
+    uint8_t const * _p;
+    uint64_t _i;
+    uint64_t _next;
+    bool _inside;
+};
+
+
+RangeSetView::RangeSetView(uint8_t const * buffer, size_t n) {
+    if (buffer == nullptr || n < 3 || buffer[0] != RangeSet::TYPE_CODE ||
+        buffer[1] > 1) {
+        throwInvalidEncoding();
+    }
+    uint8_t const * p = buffer + 2;
+    _end = buffer + n;
+    _containsZero = (buffer[1] == 1);
+    // Every end point occupies at least one byte, and every index entry
+    // 16 bytes. Checking this up front guarantees that the index can be
+    // read without further bounds checks.
+    if (!decodeVarint(p, _end, _numPoints) ||
+        _numPoints > static_cast<uint64_t>(_end - p)) {
+        throwInvalidEncoding();
+    }
+    _numBlocks = static_cast<size_t>(
+        (_numPoints + RangeSet::BLOCK_SIZE - 1) / RangeSet::BLOCK_SIZE);
+    size_t indexSize = _numBlocks == 0 ? 0 : 16 * (_numBlocks - 1);
+    if (indexSize > static_cast<size_t>(_end - p) ||
+        _numPoints > static_cast<uint64_t>(_end - p - indexSize)) {
+        throwInvalidEncoding();
+    }
+    _index = p;
+    _points = p + indexSize;
+}
+
+bool RangeSetView::intersects(RangeSet const & s) const {
+    Stream a(*this, false);
+    PointStream b(s._ranges.begin() + 1, s._ranges.end() - 1, !s._offset);
+    return sphgeom::intersects(a, b);
+}
+
+bool RangeSetView::intersects(RangeSetView const & s) const {
+    Stream a(*this, false);
+    Stream b(s, false);
+    return sphgeom::intersects(a, b);
+}
+
+bool RangeSetView::contains(uint64_t u) const {
+    Stream a(*this, false);
+    a.skipThrough(u);
+    return a.inside();
+}
+
+bool RangeSetView::contains(RangeSet const & s) const {
+    // A ⊇ B iff ¬A ∩ B = ∅
+    Stream a(*this, true);
+    PointStream b(s._ranges.begin() + 1, s._ranges.end() - 1, !s._offset);
+    return !sphgeom::intersects(a, b);
+}
+
+bool RangeSetView::contains(RangeSetView const & s) const {
+    Stream a(*this, true);
+    Stream b(s, false);
+    return !sphgeom::intersects(a, b);
+}
+
+RangeSet RangeSetView::intersection(RangeSet const & s) const {
+    Stream a(*this, false);
+    PointStream b(s._ranges.begin() + 1, s._ranges.end() - 1, !s._offset);
+    RangeSet result;
+    result._ranges = {0};
+    result._offset = !intersect(a, b, result._ranges);
+    result._ranges.push_back(0);
+    return result;
+}
+
+RangeSet RangeSetView::intersection(RangeSetView const & s) const {
+    Stream a(*this, false);
+    Stream b(s, false);
+    RangeSet result;
+    result._ranges = {0};
+    result._offset = !intersect(a, b, result._ranges);
+    result._ranges.push_back(0);
+    return result;
+}
+
+RangeSet RangeSetView::decode() const {
+    RangeSet result;
+    result._ranges.reserve(static_cast<size_t>(_numPoints) + 2);
+    result._ranges = {0};
+    for (Stream a(*this, false); a.hasNext(); a.advance()) {
+        result._ranges.push_back(a.next());
+    }
+    result._ranges.push_back(0);
+    result._offset = !_containsZero;
+    return result;
+}
+
+size_t RangeSetView::_findBlock(uint64_t u) const {
+    // Find the last block j > 0 whose index entry stores an end point
+    // less than or equal to u, or return 0 if there is none.
+    size_t lo = 0;
+    size_t hi = _numBlocks;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (decodeU64(_index + 16 * (mid - 1)) <= u) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+}} // namespace lsst::sphgeom
@@ -32,10 +32,23 @@
 #include "lsst/sphgeom/ConvexPolygon.h"
 #include "lsst/sphgeom/Ellipse.h"
 
+#include "ContainsImpl.h"
+
 
 namespace lsst {
 namespace sphgeom {
 
+void Region::contains(double const * x,
+                      double const * y,
+                      double const * z,
+                      size_t n,
+                      uint64_t * result) const
+{
+    detail::containsBatch(x, y, z, n, result, [this](UnitVector3d const & v) {
+        return contains(v);
+    });
+}
+
 std::unique_ptr<Region> Region::decode(uint8_t const * buffer, size_t n) {
     if (buffer == nullptr || n == 0) {
         throw std::runtime_error("Byte-string is not an encoded Region");
@@ -26,6 +26,8 @@
 #include "lsst/sphgeom/orientation.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cmath>
 
 #include "lsst/sphgeom/BigInteger.h"
 
@@ -70,9 +72,199 @@ void computeProduct(BigFloat & p, double d0, double d1, double d2) {
     p.exponent = e0 + e1 + e2 - 3 * 53;
 }
 
+// The functions below implement the floating point expansion arithmetic
+// described in:
+//
+//     Adaptive Precision Floating-Point Arithmetic
+//     and Fast Robust Geometric Predicates,
+//     Jonathan Richard Shewchuk,
+//     Discrete & Computational Geometry 18(3):305–363, October 1997.
+//
+// An expansion is a sum of non-overlapping doubles, stored in order of
+// increasing magnitude. All operations are exact in the absence of underflow
+// and overflow, and the sign of an expansion is the sign of its last
+// (largest magnitude) component.
+
+// `fastTwoSum` computes x + y = a + b exactly, assuming |a| ≥ |b|.
+inline void fastTwoSum(double a, double b, double & x, double & y) {
+    x = a + b;
+    double bv = x - a;
+    y = b - bv;
+}
+
+// `twoSum` computes x + y = a + b exactly.
+inline void twoSum(double a, double b, double & x, double & y) {
+    x = a + b;
+    double bv = x - a;
+    double av = x - bv;
+    y = (a - av) + (b - bv);
+}
+
+// `twoDiff` computes x + y = a - b exactly.
+inline void twoDiff(double a, double b, double & x, double & y) {
+    x = a - b;
+    double bv = a - x;
+    double av = x + bv;
+    y = (a - av) + (bv - b);
+}
+
+// `split` splits a into two 26 bit halves, hi and lo, with a = hi + lo.
+inline void split(double a, double & hi, double & lo) {
+    static double const SPLITTER = 134217729.0; // 2^27 + 1
+    double c = SPLITTER * a;
+    hi = c - (c - a);
+    lo = a - hi;
+}
+
+// `twoProduct` computes x + y = a * b exactly, given the halves of b.
+inline void twoProduct(double a, double b, double bhi, double blo,
+                       double & x, double & y)
+{
+    double ahi, alo;
+    x = a * b;
+    split(a, ahi, alo);
+    double err = x - ahi * bhi;
+    err -= alo * bhi;
+    err -= ahi * blo;
+    y = alo * blo - err;
+}
+
+inline void twoProduct(double a, double b, double & x, double & y) {
+    double bhi, blo;
+    split(b, bhi, blo);
+    twoProduct(a, b, bhi, blo, x, y);
+}
+
+// `twoTwoDiff` computes the 4 component expansion e = a*b - c*d exactly.
+inline void twoTwoDiff(double a, double b, double c, double d, double * e) {
+    double x1, x0, y1, y0, i, j, k;
+    twoProduct(a, b, x1, x0);
+    twoProduct(c, d, y1, y0);
+    twoDiff(x0, y0, i, e[0]);
+    twoSum(x1, i, j, k);
+    twoDiff(k, y1, i, e[1]);
+    twoSum(j, i, e[3], e[2]);
+}
+
+// `scaleExpansion` sets h to the expansion e * b, eliminating zero
+// components, and returns the number of components in h. The output
+// array must have room for 2 * n components.
+int scaleExpansion(int n, double const * e, double b, double * h) {
+    double bhi, blo, q, hh, p1, p0, sum;
+    split(b, bhi, blo);
+    twoProduct(e[0], b, bhi, blo, q, hh);
+    int k = 0;
+    if (hh != 0.0) {
+        h[k++] = hh;
+    }
+    for (int i = 1; i < n; ++i) {
+        twoProduct(e[i], b, bhi, blo, p1, p0);
+        twoSum(q, p0, sum, hh);
+        if (hh != 0.0) {
+            h[k++] = hh;
+        }
+        fastTwoSum(p1, sum, q, hh);
+        if (hh != 0.0) {
+            h[k++] = hh;
+        }
+    }
+    if (q != 0.0 || k == 0) {
+        h[k++] = q;
+    }
+    return k;
+}
+
+// `sumExpansions` sets h to the sum of the expansions e and f, eliminating
+// zero components, and returns the number of components in h. The output
+// array must have room for m + n components.
+int sumExpansions(int m, double const * e, int n, double const * f,
+                  double * h)
+{
+    int i = 0;
+    int j = 0;
+    int k = 0;
+    double q, qnew, hh;
+    // Merge the components of e and f in order of increasing magnitude.
+    auto next = [&]() -> double {
+        if (j == n || (i < m && std::fabs(e[i]) < std::fabs(f[j]))) {
+            return e[i++];
+        }
+        return f[j++];
+    };
+    q = next();
+    while (i < m || j < n) {
+        twoSum(q, next(), qnew, hh);
+        q = qnew;
+        if (hh != 0.0) {
+            h[k++] = hh;
+        }
+    }
+    if (q != 0.0 || k == 0) {
+        h[k++] = q;
+    }
+    return k;
+}
+
+// Vector components below this threshold (about 2^-249) may cause underflow
+// in the expansion arithmetic used by orientation().
+double const MIN_EXPANSION_COMPONENT = 1.0e-75;
+
+bool hasTinyComponent(Vector3d const & v) {
+    for (int i = 0; i < 3; ++i) {
+        double x = std::fabs(v(i));
+        if (x != 0.0 && x < MIN_EXPANSION_COMPONENT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Counters for the stages of orientation().
+struct Counters {
+    std::atomic<bool> enabled;
+    std::atomic<uint64_t> fixedBound;
+    std::atomic<uint64_t> permanentBound;
+    std::atomic<uint64_t> degenerate;
+    std::atomic<uint64_t> exactMinors;
+    std::atomic<uint64_t> expansion;
+    std::atomic<uint64_t> arbitraryPrecision;
+};
+
+Counters COUNTERS = {};
+
+inline void increment(std::atomic<uint64_t> & counter) {
+    if (COUNTERS.enabled.load(std::memory_order_relaxed)) {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
 } // unnamed namespace
 
 
+void setOrientationCounting(bool enabled) {
+    COUNTERS.enabled.store(enabled);
+}
+
+OrientationCounts getOrientationCounts() {
+    OrientationCounts counts;
+    counts.fixedBound = COUNTERS.fixedBound.load();
+    counts.permanentBound = COUNTERS.permanentBound.load();
+    counts.degenerate = COUNTERS.degenerate.load();
+    counts.exactMinors = COUNTERS.exactMinors.load();
+    counts.expansion = COUNTERS.expansion.load();
+    counts.arbitraryPrecision = COUNTERS.arbitraryPrecision.load();
+    return counts;
+}
+
+void resetOrientationCounts() {
+    COUNTERS.fixedBound.store(0);
+    COUNTERS.permanentBound.store(0);
+    COUNTERS.degenerate.store(0);
+    COUNTERS.exactMinors.store(0);
+    COUNTERS.expansion.store(0);
+    COUNTERS.arbitraryPrecision.store(0);
+}
+
 int orientationExact(Vector3d const & a,
                      Vector3d const & b,
                      Vector3d const & c)
@@ -172,26 +364,82 @@ int orientation(UnitVector3d const & a,
                          a.y() * (bzcx - bxcz) +
                          a.z() * (bxcy - bycx);
     if (determinant > maxAbsoluteError) {
+        increment(COUNTERS.fixedBound);
         return 1;
     } else if (determinant < -maxAbsoluteError) {
+        increment(COUNTERS.fixedBound);
         return -1;
     }
     // Expend some more effort on what is hopefully a tighter error bound
-    // before falling back on arbitrary precision arithmetic.
+    // before falling back on exact arithmetic.
     double permanent = std::fabs(a.x()) * (std::fabs(bycz) + std::fabs(bzcy)) +
                        std::fabs(a.y()) * (std::fabs(bzcx) + std::fabs(bxcz)) +
                        std::fabs(a.z()) * (std::fabs(bxcy) + std::fabs(bycx));
     double maxError = relativeError * permanent + minAbsoluteError;
     if (determinant > maxError) {
+        increment(COUNTERS.permanentBound);
         return 1;
     } else if (determinant < -maxError) {
+        increment(COUNTERS.permanentBound);
         return -1;
     }
     // Avoid the slow path when any two inputs are identical or antipodal.
     if (a == b || b == c || a == c || a == -b || b == -c || a == -c) {
+        increment(COUNTERS.degenerate);
         return 0;
     }
-    return orientationExact(a, b, c);
+    if (hasTinyComponent(a) || hasTinyComponent(b) || hasTinyComponent(c)) {
+        increment(COUNTERS.arbitraryPrecision);
+        return orientationExact(a, b, c);
+    }
+    // Compute the components of b × c exactly, as 4 component expansions.
+    // When b and c are close together, as is the case for the vertices of
+    // small pixels, the floating point cross product suffers from
+    // cancellation, and the permanent is a poor estimate of the error in
+    // the determinant.
+    double minors[3][4];
+    twoTwoDiff(b.y(), c.z(), b.z(), c.y(), minors[0]);
+    twoTwoDiff(b.z(), c.x(), b.x(), c.z(), minors[1]);
+    twoTwoDiff(b.x(), c.y(), b.y(), c.x(), minors[2]);
+    // Approximate each minor by the sum of its components, and compute the
+    // determinant from the approximations. Each approximation has absolute
+    // error at most 3ε times the sum of the absolute values of the minor
+    // components, and the 3 multiplications and 2 additions add a relative
+    // error of at most about 3ε, where ε = 2^-53. This constant is a little
+    // more than 7ε.
+    static double const minorRelativeError = 8.0e-16;
+    double approx[3];
+    double bound = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        approx[i] = ((minors[i][0] + minors[i][1]) + minors[i][2]) +
+                    minors[i][3];
+        bound += std::fabs(a(i)) * (std::fabs(minors[i][0]) +
+                                    std::fabs(minors[i][1]) +
+                                    std::fabs(minors[i][2]) +
+                                    std::fabs(minors[i][3]));
+    }
+    determinant = a.x() * approx[0] + a.y() * approx[1] + a.z() * approx[2];
+    maxError = minorRelativeError * bound + minAbsoluteError;
+    if (determinant > maxError) {
+        increment(COUNTERS.exactMinors);
+        return 1;
+    } else if (determinant < -maxError) {
+        increment(COUNTERS.exactMinors);
+        return -1;
+    }
+    // Compute the determinant exactly, as a floating point expansion.
+    double terms[3][8];
+    int lengths[3];
+    for (int i = 0; i < 3; ++i) {
+        lengths[i] = scaleExpansion(4, minors[i], a(i), terms[i]);
+    }
+    double partial[16];
+    double sum[24];
+    int n = sumExpansions(lengths[0], terms[0], lengths[1], terms[1],
+                          partial);
+    n = sumExpansions(n, partial, lengths[2], terms[2], sum);
+    increment(COUNTERS.expansion);
+    return (sum[n - 1] > 0.0) - (sum[n - 1] < 0.0);
 }
 
 
@@ -222,21 +470,44 @@ namespace {
         return 0;
     }
 
+    // `_orientationXYZExact` computes the sign of a*b - c*d exactly, using
+    // expansion arithmetic when that cannot underflow.
+    inline int _orientationXYZExact(double a, double b, double c, double d,
+                                    UnitVector3d const & axis,
+                                    UnitVector3d const & v0,
+                                    UnitVector3d const & v1)
+    {
+        if (hasTinyComponent(v0) || hasTinyComponent(v1)) {
+            return orientationExact(axis, v0, v1);
+        }
+        double e[4];
+        twoTwoDiff(a, b, c, d, e);
+        for (int i = 3; i >= 0; --i) {
+            if (e[i] != 0.0) {
+                return e[i] > 0.0 ? 1 : -1;
+            }
+        }
+        return 0;
+    }
+
 }
 
 int orientationX(UnitVector3d const & b, UnitVector3d const & c) {
     int o = _orientationXYZ(b.y() * c.z(), b.z() * c.y());
-    return (o != 0) ? o : orientationExact(UnitVector3d::X(), b, c);
+    return (o != 0) ? o : _orientationXYZExact(
+        b.y(), c.z(), b.z(), c.y(), UnitVector3d::X(), b, c);
 }
 
 int orientationY(UnitVector3d const & b, UnitVector3d const & c) {
     int o = _orientationXYZ(b.z() * c.x(), b.x() * c.z());
-    return (o != 0) ? o : orientationExact(UnitVector3d::Y(), b, c);
+    return (o != 0) ? o : _orientationXYZExact(
+        b.z(), c.x(), b.x(), c.z(), UnitVector3d::Y(), b, c);
 }
 
 int orientationZ(UnitVector3d const & b, UnitVector3d const & c) {
     int o = _orientationXYZ(b.x() * c.y(), b.y() * c.x());
-    return (o != 0) ? o : orientationExact(UnitVector3d::Z(), b, c);
+    return (o != 0) ? o : _orientationXYZExact(
+        b.x(), c.y(), b.y(), c.x(), UnitVector3d::Z(), b, c);
 }
 
 }} // namespace lsst::sphgeom
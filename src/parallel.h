@@ -0,0 +1,81 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_SPHGEOM_PARALLEL_H_
+#define LSST_SPHGEOM_PARALLEL_H_
+
+/// \file
+/// \brief This file contains helpers for running work on multiple threads.
+
+#include <exception>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+
+namespace lsst {
+namespace sphgeom {
+namespace {
+
+// `runInParallel` calls f(t) for t = 0, 1, ..., numThreads - 1, where each
+// call happens on a different thread. If a thread cannot be started, the
+// corresponding call is made by the calling thread instead. All threads are
+// joined before returning. If any call throws, the exception thrown by the
+// call with the smallest t is rethrown once all calls have finished.
+template <typename F>
+void runInParallel(unsigned int numThreads, F f) {
+    std::vector<std::exception_ptr> errors(numThreads);
+    auto work = [&f, &errors](unsigned int t) {
+        try {
+            f(t);
+        } catch (...) {
+            errors[t] = std::current_exception();
+        }
+    };
+    std::vector<std::thread> threads;
+    std::vector<unsigned int> unstarted;
+    threads.reserve(numThreads - 1);
+    for (unsigned int t = 1; t < numThreads; ++t) {
+        try {
+            threads.emplace_back(work, t);
+        } catch (std::system_error const &) {
+            unstarted.push_back(t);
+        }
+    }
+    work(0);
+    for (unsigned int t: unstarted) {
+        work(t);
+    }
+    for (std::thread & t: threads) {
+        t.join();
+    }
+    for (std::exception_ptr const & e: errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+}
+
+} // unnamed namespace
+}} // namespace lsst::sphgeom
+
+#endif // LSST_SPHGEOM_PARALLEL_H_
@@ -0,0 +1,78 @@
+/*
+ * LSST Data Management System
+ * Copyright 2014-2015 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+#ifndef LSST_SPHGEOM_CONTAINSTESTUTILS_H_
+#define LSST_SPHGEOM_CONTAINSTESTUTILS_H_
+
+/// \file
+/// \brief This file contains utility code for testing batched
+///        point-in-region tests.
+
+#include <cstdint>
+#include <vector>
+
+#include "lsst/sphgeom/LonLat.h"
+#include "lsst/sphgeom/Region.h"
+#include "lsst/sphgeom/UnitVector3d.h"
+
+
+namespace lsst {
+namespace sphgeom {
+
+// `checkBatchContains` checks that the batch form of Region::contains agrees
+// with the single-point form for a grid of points covering the sphere, along
+// with the given extra points (e.g. points on the region boundary).
+inline void checkBatchContains(Region const & r,
+                               std::vector<UnitVector3d> const & extra) {
+    std::vector<UnitVector3d> points(extra);
+    for (double lat = -90.0; lat <= 90.0; lat += 5.0) {
+        for (double lon = 0.0; lon < 360.0; lon += 5.0) {
+            points.push_back(UnitVector3d(LonLat::fromDegrees(lon, lat)));
+        }
+    }
+    // Check every batch size up to the number of points, so that all
+    // possible alignments of the trailing partial result word are covered.
+    for (size_t n = 0; n <= points.size(); n += (n < 130 ? 1 : 97)) {
+        std::vector<double> x, y, z;
+        for (size_t i = 0; i < n; ++i) {
+            x.push_back(points[i].x());
+            y.push_back(points[i].y());
+            z.push_back(points[i].z());
+        }
+        std::vector<uint64_t> result((n + 63) / 64 + 1,
+                                     ~static_cast<uint64_t>(0));
+        r.contains(x.data(), y.data(), z.data(), n, result.data());
+        for (size_t i = 0; i < n; ++i) {
+            bool bit = ((result[i / 64] >> (i % 64)) & 1) != 0;
+            CHECK(bit == r.contains(points[i]));
+        }
+        if (n % 64 != 0) {
+            CHECK((result[n / 64] >> (n % 64)) == 0);
+        }
+        // The word past the end of the output must not be touched.
+        CHECK(result.back() == ~static_cast<uint64_t>(0));
+    }
+}
+
+}} // namespace lsst::sphgeom
+
+#endif // LSST_SPHGEOM_CONTAINSTESTUTILS_H_
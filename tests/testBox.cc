@@ -30,6 +30,7 @@
 #include "lsst/sphgeom/Circle.h"
 
 #include "test.h"
+#include "containsTestUtils.h"
 #include "relationshipTestUtils.h"
 
 
@@ -404,3 +405,17 @@ TEST_CASE(Codec) {
     CHECK(dynamic_cast<Box *>(r.get()) != nullptr);
     CHECK(*dynamic_cast<Box *>(r.get()) == b);
 }
+
+TEST_CASE(BatchContains) {
+    std::vector<UnitVector3d> boundary = {
+        UnitVector3d(LonLat::fromDegrees(10.0, 20.0)),
+        UnitVector3d(LonLat::fromDegrees(30.0, 40.0)),
+        UnitVector3d(LonLat::fromDegrees(10.0, 40.0)),
+        UnitVector3d::Z(),
+        -UnitVector3d::Z()
+    };
+    checkBatchContains(Box::fromDegrees(10.0, 20.0, 30.0, 40.0), boundary);
+    checkBatchContains(Box::fromDegrees(350.0, -90.0, 10.0, 5.0), boundary);
+    checkBatchContains(Box::full(), boundary);
+    checkBatchContains(Box(), boundary);
+}
@@ -0,0 +1,230 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains tests for the ChunkPartitioner class.
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "lsst/sphgeom/ChunkPartitioner.h"
+
+#include "test.h"
+
+
+using namespace lsst::sphgeom;
+
+namespace {
+
+// `Row` is a row passed to a partitioner sink.
+struct Row {
+    int32_t subChunkId;
+    bool overlap;
+    std::string payload;
+
+    bool operator==(Row const & r) const {
+        return subChunkId == r.subChunkId && overlap == r.overlap &&
+               payload == r.payload;
+    }
+};
+
+// `Output` collects the rows passed to a partitioner sink, keyed by
+// chunk ID.
+typedef std::map<int32_t, std::vector<Row>> Output;
+
+ChunkPartitioner::Sink makeSink(Output & output) {
+    return [&output](ChunkBuffer const & b) {
+        for (size_t i = 0; i < b.rows.size(); ++i) {
+            Row r = {b.rows[i].subChunkId, b.rows[i].overlap, b.getPayload(i)};
+            output[b.chunkId].push_back(r);
+        }
+    };
+}
+
+void makeRows(size_t n,
+              std::vector<LonLat> & positions,
+              std::vector<std::string> & payloads)
+{
+    std::mt19937_64 rng(1);
+    std::uniform_real_distribution<double> lon(10.0, 14.0);
+    std::uniform_real_distribution<double> lat(-2.0, 2.0);
+    for (size_t i = 0; i < n; ++i) {
+        positions.push_back(LonLat::fromDegrees(lon(rng), lat(rng)));
+        payloads.push_back("row " + std::to_string(i));
+    }
+}
+
+} // unnamed namespace
+
+
+TEST_CASE(Construction) {
+    Chunker chunker(85, 12);
+    Output output;
+    CHECK_THROW(ChunkPartitioner(chunker, nullptr), std::invalid_argument);
+    ChunkPartitioner p(chunker, makeSink(output), 1000, 0);
+    CHECK(p.getChunker() == chunker);
+    CHECK(p.getMaxBufferedBytes() == 1000);
+    CHECK(p.getNumThreads() >= 1);
+}
+
+TEST_CASE(HomeRows) {
+    Chunker chunker(85, 12);
+    std::vector<LonLat> positions;
+    std::vector<std::string> payloads;
+    makeRows(5000, positions, payloads);
+    Output output;
+    ChunkPartitioner p(chunker, makeSink(output));
+    p.add(positions.data(), payloads.data(), positions.size());
+    CHECK(output.empty());
+    CHECK(p.getStatistics().bufferedBytes > 0);
+    p.flush();
+    CHECK(p.getStatistics().bufferedBytes == 0);
+    CHECK(p.getStatistics().numRows == 5000);
+    CHECK(p.getStatistics().numOverlapRows == 0);
+    // Every row appears exactly once, in its home sub-chunk, and rows
+    // appear in each chunk in the order they were added.
+    Output expected;
+    for (size_t i = 0; i < positions.size(); ++i) {
+        ChunkLocation loc = chunker.locate(positions[i]);
+        Row r = {loc.subChunkId, false, payloads[i]};
+        expected[loc.chunkId].push_back(r);
+    }
+    CHECK(output == expected);
+}
+
+TEST_CASE(OverlapRows) {
+    Chunker chunker(85, 12, Angle::fromDegrees(0.01));
+    std::vector<LonLat> positions;
+    std::vector<std::string> payloads;
+    makeRows(2000, positions, payloads);
+    Output output;
+    ChunkPartitioner p(chunker, makeSink(output));
+    p.add(positions.data(), payloads.data(), positions.size());
+    p.flush();
+    CHECK(p.getStatistics().numOverlapRows > 0);
+    std::map<std::string, size_t> index;
+    for (size_t i = 0; i < payloads.size(); ++i) {
+        index[payloads[i]] = i;
+    }
+    size_t numHome = 0;
+    size_t numOverlap = 0;
+    for (auto const & entry: output) {
+        for (Row const & r: entry.second) {
+            size_t i = index.at(r.payload);
+            ChunkLocation home = chunker.locate(positions[i]);
+            ChunkLocation loc(entry.first, r.subChunkId);
+            if (!r.overlap) {
+                CHECK(loc == home);
+                ++numHome;
+                continue;
+            }
+            ++numOverlap;
+            CHECK(loc != home);
+            // The row must be in the overlap bounds of the sub-chunk.
+            std::vector<ChunkLocation> locations =
+                chunker.getOverlapSubChunks(positions[i]);
+            CHECK(std::find(locations.begin(), locations.end(), loc) !=
+                  locations.end());
+        }
+    }
+    CHECK(numHome == positions.size());
+    CHECK(numOverlap == p.getStatistics().numOverlapRows);
+}
+
+TEST_CASE(BoundedMemory) {
+    Chunker chunker(85, 12, Angle::fromDegrees(0.01));
+    std::vector<LonLat> positions;
+    std::vector<std::string> payloads;
+    makeRows(20000, positions, payloads);
+    Output unbounded;
+    ChunkPartitioner p1(chunker, makeSink(unbounded));
+    p1.add(positions.data(), payloads.data(), positions.size());
+    p1.flush();
+    size_t const maxBufferedBytes = 16 * 1024;
+    Output bounded;
+    ChunkPartitioner p2(chunker, makeSink(bounded), maxBufferedBytes);
+    for (size_t i = 0; i < positions.size(); i += 100) {
+        p2.add(positions.data() + i, payloads.data() + i, 100);
+        CHECK(p2.getStatistics().bufferedBytes <= maxBufferedBytes);
+    }
+    p2.flush();
+    CHECK(p2.getStatistics().numFlushes > p1.getStatistics().numFlushes);
+    CHECK(bounded == unbounded);
+}
+
+TEST_CASE(Threads) {
+    Chunker chunker(85, 12, Angle::fromDegrees(0.01));
+    std::vector<LonLat> positions;
+    std::vector<std::string> payloads;
+    makeRows(20000, positions, payloads);
+    std::vector<int32_t> order1;
+    std::vector<int32_t> order4;
+    Output output1;
+    Output output4;
+    ChunkPartitioner::Sink sink1 = makeSink(output1);
+    ChunkPartitioner::Sink sink4 = makeSink(output4);
+    ChunkPartitioner p1(
+        chunker,
+        [&](ChunkBuffer const & b) { order1.push_back(b.chunkId); sink1(b); },
+        64 * 1024, 1);
+    ChunkPartitioner p4(
+        chunker,
+        [&](ChunkBuffer const & b) { order4.push_back(b.chunkId); sink4(b); },
+        64 * 1024, 4);
+    CHECK(p4.getNumThreads() == 4);
+    for (size_t i = 0; i < positions.size(); i += 5000) {
+        p1.add(positions.data() + i, payloads.data() + i, 5000);
+        p4.add(positions.data() + i, payloads.data() + i, 5000);
+    }
+    p1.flush();
+    p4.flush();
+    CHECK(output1 == output4);
+    CHECK(order1 == order4);
+}
+
+TEST_CASE(WorkerErrors) {
+    Chunker chunker(85, 12, Angle::fromDegrees(0.01));
+    std::vector<LonLat> positions;
+    std::vector<std::string> payloads;
+    makeRows(20000, positions, payloads);
+    Output output;
+    ChunkPartitioner p(chunker, makeSink(output), 64 * 1024, 4);
+    // Rows with NaN positions make the worker assigning them throw. Check
+    // that exceptions from the calling thread and from other threads both
+    // reach the caller, and that no rows from the batch are kept.
+    for (size_t i: {size_t(0), positions.size() / 2, positions.size() - 1}) {
+        LonLat saved = positions[i];
+        positions[i] = LonLat(NormalizedAngle::nan(), Angle::nan());
+        CHECK_THROW(p.add(positions.data(), payloads.data(), positions.size()),
+                    std::invalid_argument);
+        CHECK(p.getStatistics().numRows == 0);
+        CHECK(p.getStatistics().bufferedBytes == 0);
+        positions[i] = saved;
+    }
+    p.add(positions.data(), payloads.data(), positions.size());
+    p.flush();
+    CHECK(p.getStatistics().numRows == positions.size());
+}
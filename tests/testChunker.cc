@@ -23,8 +23,15 @@
 /// \file
 /// \brief This file contains tests for the Chunker class.
 
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <stdexcept>
+
 #include "lsst/sphgeom/Box.h"
 #include "lsst/sphgeom/Chunker.h"
+#include "lsst/sphgeom/Circle.h"
 
 #include "test.h"
 
@@ -67,3 +74,265 @@ TEST_CASE(AllSubChunks) {
     std::vector<int32_t> subChunkIds = chunker.getAllSubChunks(9630);
     CHECK(subChunkIds == expectedSubChunkIds);
 }
+
+TEST_CASE(Locate) {
+    Chunker chunker(85, 12);
+    // Points in each of the sub-chunks intersecting the box in the
+    // Python Chunker tests.
+    CHECK(chunker.locate(LonLat::fromDegrees(273.65, 30.701)) ==
+          ChunkLocation(9630, 770));
+    CHECK(chunker.locate(LonLat::fromDegrees(273.71, 30.701)) ==
+          ChunkLocation(9631, 759));
+    CHECK(chunker.locate(LonLat::fromDegrees(273.65, 30.72)) ==
+          ChunkLocation(9797, 11));
+    std::mt19937_64 rng(42);
+    std::normal_distribution<double> normal;
+    std::vector<UnitVector3d> points;
+    for (int i = 0; i < 2000; ++i) {
+        points.push_back(UnitVector3d(normal(rng), normal(rng), normal(rng)));
+    }
+    // Add poles, and points on chunk and sub-chunk boundaries.
+    points.push_back(UnitVector3d::Z());
+    points.push_back(-UnitVector3d::Z());
+    points.push_back(UnitVector3d::X());
+    points.push_back(UnitVector3d(LonLat::fromDegrees(0.0, -0.5)));
+    points.push_back(UnitVector3d(LonLat::fromDegrees(359.9999999, 45.0)));
+    std::vector<ChunkLocation> locations(points.size());
+    chunker.locate(points.data(), locations.data(), points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        ChunkLocation loc = chunker.locate(points[i]);
+        CHECK(loc == locations[i]);
+        // The location must be one of the sub-chunks intersecting a tiny
+        // circle around the point.
+        Circle c(points[i], Angle(1.0e-9));
+        bool found = false;
+        for (SubChunks const & sc: chunker.getSubChunksIntersecting(c)) {
+            if (sc.chunkId == loc.chunkId &&
+                std::find(sc.subChunkIds.begin(), sc.subChunkIds.end(),
+                          loc.subChunkId) != sc.subChunkIds.end()) {
+                found = true;
+            }
+        }
+        CHECK(found);
+        std::vector<int32_t> all = chunker.getAllSubChunks(loc.chunkId);
+        CHECK(std::find(all.begin(), all.end(), loc.subChunkId) != all.end());
+    }
+    std::vector<LonLat> lonLats;
+    for (UnitVector3d const & v: points) {
+        lonLats.push_back(LonLat(v));
+    }
+    chunker.locate(lonLats.data(), locations.data(), lonLats.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        CHECK(locations[i] == chunker.locate(points[i]));
+    }
+    // NaN points cannot be located.
+    LonLat nan(NormalizedAngle::nan(), Angle::nan());
+    CHECK_THROW(chunker.locate(nan), std::invalid_argument);
+    lonLats.push_back(nan);
+    locations.resize(lonLats.size());
+    CHECK_THROW(chunker.locate(lonLats.data(), locations.data(),
+                               lonLats.size()),
+                std::invalid_argument);
+    CHECK_THROW(chunker.getOverlapChunks(nan), std::invalid_argument);
+    CHECK_THROW(chunker.getOverlapSubChunks(nan), std::invalid_argument);
+}
+
+TEST_CASE(Overlap) {
+    CHECK(Chunker(85, 12).getOverlap() == Angle(0.0));
+    CHECK(Chunker(85, 12) != Chunker(85, 12, Angle::fromDegrees(0.01)));
+    CHECK(Chunker(85, 12, Angle::fromDegrees(0.01)) ==
+          Chunker(85, 12, Angle::fromDegrees(0.01)));
+    CHECK_THROW(Chunker(85, 12, Angle(-1.0e-9)), std::runtime_error);
+    CHECK_THROW(Chunker(85, 12, Angle::fromDegrees(1.0)), std::runtime_error);
+    CHECK_THROW(Chunker(85, 12, Angle::nan()), std::runtime_error);
+    // Without an overlap radius, a point that is not on a chunk or
+    // sub-chunk boundary is only in the overlap bounds of its own chunk
+    // and sub-chunk.
+    Chunker chunker(85, 12);
+    LonLat p = LonLat::fromDegrees(273.65, 30.701);
+    CHECK(chunker.getOverlapChunks(p) == std::vector<int32_t>{9630});
+    CHECK(chunker.getOverlapSubChunks(p) ==
+          std::vector<ChunkLocation>{ChunkLocation(9630, 770)});
+}
+
+TEST_CASE(OverlapSubChunks) {
+    std::mt19937_64 rng(7);
+    std::normal_distribution<double> normal;
+    std::uniform_real_distribution<double> uniform;
+    for (Angle overlap: {Angle::fromDegrees(0.01), Angle::fromDegrees(0.1),
+                         Angle(PI / (85 * 12))}) {
+        Chunker chunker(85, 12, overlap);
+        CHECK(chunker.getOverlap() == overlap);
+        std::vector<UnitVector3d> points;
+        for (int i = 0; i < 2000; ++i) {
+            points.push_back(
+                UnitVector3d(normal(rng), normal(rng), normal(rng)));
+        }
+        // Add points near the poles.
+        for (int i = 0; i < 100; ++i) {
+            points.push_back(UnitVector3d(LonLat::fromDegrees(
+                360.0 * uniform(rng), 89.0 + uniform(rng))));
+            points.push_back(UnitVector3d(LonLat::fromDegrees(
+                360.0 * uniform(rng), -89.0 - uniform(rng))));
+        }
+        points.push_back(UnitVector3d::Z());
+        points.push_back(UnitVector3d::X());
+        std::vector<ChunkLocation> locations;
+        std::vector<size_t> offsets;
+        chunker.getOverlapSubChunks(points.data(), points.size(),
+                                    locations, offsets);
+        CHECK(offsets.size() == points.size() + 1);
+        CHECK(offsets.back() == locations.size());
+        for (size_t i = 0; i < points.size(); ++i) {
+            UnitVector3d const & q = points[i];
+            std::vector<ChunkLocation> subChunks =
+                chunker.getOverlapSubChunks(q);
+            CHECK(std::vector<ChunkLocation>(
+                      locations.begin() + offsets[i],
+                      locations.begin() + offsets[i + 1]) == subChunks);
+            std::vector<int32_t> chunkIds = chunker.getOverlapChunks(q);
+            CHECK(std::is_sorted(chunkIds.begin(), chunkIds.end()));
+            // Every sub-chunk lies in one of the chunks, without duplicates.
+            for (size_t j = 0; j < subChunks.size(); ++j) {
+                ChunkLocation const & loc = subChunks[j];
+                CHECK(j == 0 || subChunks[j - 1] != loc);
+                CHECK(std::binary_search(chunkIds.begin(), chunkIds.end(),
+                                         loc.chunkId));
+                std::vector<int32_t> all = chunker.getAllSubChunks(
+                    loc.chunkId);
+                CHECK(std::find(all.begin(), all.end(), loc.subChunkId) !=
+                      all.end());
+            }
+            // The overlap bounds contain all points within the overlap
+            // radius of a sub-chunk. So the location of any point p near q
+            // must be one of the overlap sub-chunks of q.
+            UnitVector3d n = UnitVector3d::orthogonalTo(
+                q, Vector3d(normal(rng), normal(rng), normal(rng)));
+            Angle theta = 0.999 * uniform(rng) * overlap;
+            UnitVector3d p(cos(theta) * q + sin(theta) * n);
+            ChunkLocation loc = chunker.locate(p);
+            CHECK(std::find(subChunks.begin(), subChunks.end(), loc) !=
+                  subChunks.end());
+            CHECK(std::binary_search(chunkIds.begin(), chunkIds.end(),
+                                     loc.chunkId));
+        }
+    }
+}
+
+TEST_CASE(SubChunkRangesAppend) {
+    SubChunkRanges s;
+    CHECK(s.chunkId == -1);
+    CHECK(s.getNumSubChunks() == 0);
+    s.append(1, 3);
+    s.append(3, 4);
+    s.append(10, 12);
+    CHECK(s.ranges.size() == 2);
+    CHECK(s.getNumSubChunks() == 5);
+    CHECK(s.getSubChunkIds() == (std::vector<int32_t>{1, 2, 3, 10, 11}));
+}
+
+TEST_CASE(SubChunkRangesIntersecting) {
+    Chunker chunker(85, 12);
+    std::mt19937_64 rng(3);
+    std::normal_distribution<double> normal;
+    std::uniform_real_distribution<double> uniform;
+    std::vector<std::unique_ptr<Region>> regions;
+    for (int i = 0; i < 200; ++i) {
+        UnitVector3d v(normal(rng), normal(rng), normal(rng));
+        double radius = std::pow(10.0, -4.0 + 4.0 * uniform(rng));
+        regions.emplace_back(new Circle(v, Angle(radius)));
+    }
+    regions.emplace_back(new Box(Box::full()));
+    regions.emplace_back(new Circle(UnitVector3d::Z(), Angle(0.3)));
+    regions.emplace_back(new Box(Box::fromDegrees(350.0, -10.0, 10.0, 10.0)));
+    for (auto const & r: regions) {
+        std::vector<SubChunks> subChunks =
+            chunker.getSubChunksIntersecting(*r);
+        std::vector<SubChunkRanges> ranges =
+            chunker.getSubChunkRangesIntersecting(*r);
+        CHECK(subChunks.size() == ranges.size());
+        for (size_t i = 0; i < subChunks.size() && i < ranges.size(); ++i) {
+            CHECK(ranges[i].chunkId == subChunks[i].chunkId);
+            CHECK(ranges[i].getSubChunkIds() == subChunks[i].subChunkIds);
+            CHECK(!ranges[i].ranges.empty());
+            for (size_t j = 0; j < ranges[i].ranges.size(); ++j) {
+                CHECK(ranges[i].ranges[j].first < ranges[i].ranges[j].second);
+                CHECK(j == 0 || ranges[i].ranges[j - 1].second <
+                                ranges[i].ranges[j].first);
+            }
+        }
+    }
+    // Every sub-chunk of every chunk intersects the full sky, and the
+    // sub-chunks of a sub-stripe within a chunk are a single range.
+    std::vector<SubChunkRanges> all =
+        chunker.getSubChunkRangesIntersecting(Box::full());
+    std::vector<int32_t> chunkIds = chunker.getAllChunks();
+    CHECK(all.size() == chunkIds.size());
+    for (size_t i = 0; i < all.size() && i < chunkIds.size(); ++i) {
+        CHECK(all[i].chunkId == chunkIds[i]);
+        CHECK(all[i].getSubChunkIds() == chunker.getAllSubChunks(chunkIds[i]));
+        CHECK(all[i].ranges.size() <= 12);
+    }
+}
+
+TEST_CASE(GlobalSubChunkIds) {
+    Chunker chunker(85, 12);
+    for (int32_t chunkId: {0, 9630, 9797, 14449}) {
+        for (int32_t subChunkId: chunker.getAllSubChunks(chunkId)) {
+            uint64_t id = chunker.getGlobalSubChunkId(chunkId, subChunkId);
+            CHECK(chunker.getChunkLocation(id) ==
+                  ChunkLocation(chunkId, subChunkId));
+        }
+    }
+    CHECK(chunker.getGlobalSubChunkId(1, 0) >
+          chunker.getGlobalSubChunkId(0, 12 * 69 - 1));
+}
+
+TEST_CASE(SetsIntersecting) {
+    Chunker chunker(85, 12);
+    Box box = Box::fromDegrees(273.6, 30.7, 273.7180105379097,
+                               30.722546655347717);
+    CHECK(chunker.getChunkSetIntersecting(box) ==
+          RangeSet({9630, 9631, 9797}));
+    CHECK(chunker.getSubChunkSetIntersecting(box) ==
+          RangeSet({chunker.getGlobalSubChunkId(9630, 770),
+                    chunker.getGlobalSubChunkId(9631, 759),
+                    chunker.getGlobalSubChunkId(9797, 11)}));
+    std::vector<Box> boxes = {
+        Box::fromDegrees(350.0, -10.0, 10.0, 10.0),
+        Box::fromDegrees(0.0, 80.0, 360.0, 90.0),
+        Box::fromDegrees(100.0, -30.0, 130.0, -20.0),
+        Box::full()
+    };
+    std::vector<RangeSet> sets;
+    for (Box const & b: boxes) {
+        std::vector<int32_t> chunkIds = chunker.getChunksIntersecting(b);
+        RangeSet chunks = chunker.getChunkSetIntersecting(b);
+        CHECK(chunks.cardinality() == chunkIds.size());
+        for (int32_t chunkId: chunkIds) {
+            CHECK(chunks.contains(static_cast<uint64_t>(chunkId)));
+        }
+        std::vector<SubChunks> subChunks = chunker.getSubChunksIntersecting(b);
+        RangeSet s = chunker.getSubChunkSetIntersecting(b);
+        uint64_t n = 0;
+        for (SubChunks const & sc: subChunks) {
+            n += sc.subChunkIds.size();
+            for (int32_t subChunkId: sc.subChunkIds) {
+                CHECK(s.contains(
+                    chunker.getGlobalSubChunkId(sc.chunkId, subChunkId)));
+            }
+        }
+        CHECK(s.cardinality() == n);
+        sets.push_back(s);
+    }
+    // The sub-chunk sets of the boxes can be combined with set operations.
+    CHECK((sets[0] & sets[3]) == sets[0]);
+    CHECK((sets[0] & sets[1]).empty());
+    CHECK((sets[0] | sets[1] | sets[2]).cardinality() ==
+          sets[0].cardinality() + sets[1].cardinality() +
+          sets[2].cardinality());
+    // The sub-chunks of a chunk in a sub-stripe have consecutive global
+    // IDs, so the whole sky needs at most one range per chunk and
+    // sub-stripe.
+    CHECK(sets[3].size() <= 12 * chunker.getAllChunks().size());
+}
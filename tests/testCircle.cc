@@ -31,6 +31,7 @@
 #include "lsst/sphgeom/Circle.h"
 
 #include "test.h"
+#include "containsTestUtils.h"
 #include "relationshipTestUtils.h"
 
 
@@ -372,3 +373,16 @@ TEST_CASE(Codec) {
     CHECK(dynamic_cast<Circle *>(r.get()) != nullptr);
     CHECK(*dynamic_cast<Circle *>(r.get()) == c);
 }
+
+TEST_CASE(BatchContains) {
+    UnitVector3d c(1.0, -2.0, 0.5);
+    UnitVector3d p(0.5, 1.0, 2.0);
+    std::vector<UnitVector3d> boundary = {c, -c, p, -p};
+    checkBatchContains(Circle(c, Angle::fromDegrees(30.0)), boundary);
+    checkBatchContains(Circle(c, Angle::fromDegrees(135.0)), boundary);
+    // This circle passes through p.
+    checkBatchContains(Circle(c, (p - c).getSquaredNorm()), boundary);
+    checkBatchContains(Circle::empty(), boundary);
+    checkBatchContains(Circle::full(), boundary);
+    checkBatchContains(Circle(c), boundary);
+}
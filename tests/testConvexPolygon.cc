@@ -23,14 +23,18 @@
 /// \file
 /// \brief This file contains tests for the ConvexPolygon class.
 
+#include <memory>
 #include <vector>
 
 #include "lsst/sphgeom/Box.h"
 #include "lsst/sphgeom/Box3d.h"
 #include "lsst/sphgeom/Circle.h"
 #include "lsst/sphgeom/ConvexPolygon.h"
+#include "lsst/sphgeom/LonLat.h"
+#include "lsst/sphgeom/orientation.h"
 
 #include "test.h"
+#include "containsTestUtils.h"
 
 
 using namespace lsst::sphgeom;
@@ -314,3 +318,80 @@ TEST_CASE(Disjoint) {
     ConvexPolygon poly2(points2);
     CHECK(poly1.relate(poly2) == DISJOINT);
 }
+
+TEST_CASE(BatchContains) {
+    std::vector<UnitVector3d> points = {
+        UnitVector3d(1.0, 0.1, 0.1),
+        UnitVector3d(0.1, 1.0, -0.1),
+        UnitVector3d(-0.2, 0.3, 1.0),
+        UnitVector3d(0.6, -0.3, 0.8)
+    };
+    std::vector<UnitVector3d> boundary(points);
+    for (size_t i = 0; i < points.size(); ++i) {
+        UnitVector3d const & a = points[i];
+        UnitVector3d const & b = points[(i + 1) % points.size()];
+        boundary.push_back(UnitVector3d(a + b));
+        boundary.push_back(-UnitVector3d(a + b));
+        boundary.push_back(UnitVector3d(a.cross(b)));
+    }
+    checkBatchContains(ConvexPolygon(points[0], points[1], points[2]),
+                       boundary);
+    checkBatchContains(ConvexPolygon::convexHull(points), boundary);
+}
+
+TEST_CASE(CachedEdgeNormals) {
+    std::vector<UnitVector3d> points = {
+        UnitVector3d(1.0, 0.1, 0.1),
+        UnitVector3d(0.1, 1.0, -0.1),
+        UnitVector3d(-0.2, 0.3, 1.0),
+        UnitVector3d(0.6, -0.3, 0.8)
+    };
+    ConvexPolygon hull = ConvexPolygon::convexHull(points);
+    std::unique_ptr<ConvexPolygon> decoded = ConvexPolygon::decode(
+        hull.encode());
+    ConvexPolygon triangle(points[0], points[1], points[2]);
+    for (ConvexPolygon const * p: {&hull, decoded.get(), &triangle}) {
+        std::vector<UnitVector3d> const & v = p->getVertices();
+        std::vector<Vector3d> const & n = p->getEdgeNormals();
+        REQUIRE(n.size() == v.size());
+        for (size_t i = 0; i < v.size(); ++i) {
+            CHECK(n[i] == v[i].cross(v[(i + 1) % v.size()]));
+        }
+        checkProperties(*p);
+        // Point containment must agree with the orientation predicate.
+        for (int i = -20; i <= 20; ++i) {
+            for (int j = 0; j < 40; ++j) {
+                UnitVector3d u(LonLat::fromDegrees(9.0 * j, 4.5 * i));
+                bool inside = true;
+                for (size_t k = 0; k < v.size(); ++k) {
+                    inside = inside &&
+                             orientation(u, v[k], v[(k + 1) % v.size()]) >= 0;
+                }
+                CHECK(p->contains(u) == inside);
+            }
+        }
+        // Relationships with small polygons must be consistent with
+        // point containment.
+        for (int i = -9; i <= 9; ++i) {
+            for (int j = 0; j < 20; ++j) {
+                UnitVector3d c(LonLat::fromDegrees(18.0 * j, 9.0 * i));
+                UnitVector3d v0(LonLat::fromDegrees(18.0 * j + 3.0,
+                                                    9.0 * i));
+                ConvexPolygon q = makeNgon(c, v0, 5);
+                Relationship r = p->relate(q);
+                CHECK(r == invert(q.relate(*p)));
+                for (UnitVector3d const & w: q.getVertices()) {
+                    if ((r & DISJOINT) != 0) {
+                        CHECK(!p->contains(w));
+                    }
+                    if ((r & CONTAINS) != 0) {
+                        CHECK(p->contains(w));
+                    }
+                }
+                if (p->contains(q.getCentroid())) {
+                    CHECK((r & DISJOINT) == 0);
+                }
+            }
+        }
+    }
+}
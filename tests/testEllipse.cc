@@ -28,9 +28,12 @@
 
 #include "lsst/sphgeom/Box.h"
 #include "lsst/sphgeom/Circle.h"
+#include "lsst/sphgeom/ConvexPolygon.h"
 #include "lsst/sphgeom/Ellipse.h"
+#include "lsst/sphgeom/LonLat.h"
 
 #include "test.h"
+#include "containsTestUtils.h"
 
 
 using namespace lsst::sphgeom;
@@ -114,10 +117,9 @@ TEST_CASE(EmptyEllipse) {
     CHECK(e == Ellipse::empty());
     CHECK(e.getAlpha() < Angle(0.0) && e.getBeta() < Angle(0.0));
     CHECK(e.complemented().isFull());
-    // Technically, an empty ellipse should contain itself, be within itself,
-    // and be disjoint from itself. However, the ellipse-ellipse relation
-    // test is currently very inexact.
-    CHECK(e.relate(e) == DISJOINT);
+    // An empty ellipse contains itself, is within itself, and is disjoint
+    // from itself.
+    CHECK(e.relate(e) == (CONTAINS | DISJOINT | WITHIN));
     // The bounding box and circle for an empty ellipse should be empty.
     CHECK(e.getBoundingBox().isEmpty());
     CHECK(e.getBoundingCircle().isEmpty());
@@ -136,11 +138,10 @@ TEST_CASE(FullEllipse) {
     CHECK(!(e != e));
     CHECK(e.getAlpha() >= Angle(PI) && e.getBeta() >= Angle(PI));
     CHECK(e.complemented().isEmpty());
-    // Technically, an empty ellipse should contain itself, be within itself,
-    // and intersect itself. However, the ellipse-ellipse relation
-    // test is currently very inexact.
-    CHECK(e.relate(e) == INTERSECTS);
-    CHECK(e.relate(Circle(UnitVector3d::X())) == INTERSECTS);
+    // A full ellipse contains itself, is within itself, and intersects
+    // itself.
+    CHECK(e.relate(e) == (CONTAINS | WITHIN));
+    CHECK(e.relate(Circle(UnitVector3d::X())) == CONTAINS);
     // Check constructor arguments that should produce full ellipses.
     CHECK(Ellipse(UnitVector3d::X(), Angle(PI)).isFull());
     CHECK(Ellipse(UnitVector3d::X(), UnitVector3d::Y(), Angle(PI)).isFull());
@@ -230,3 +231,116 @@ TEST_CASE(Codec) {
     CHECK(dynamic_cast<Ellipse *>(r.get()) != nullptr);
     CHECK(*dynamic_cast<Ellipse *>(r.get()) == e);
 }
+
+TEST_CASE(BatchContains) {
+    UnitVector3d f1(1.0, 0.5, -0.25);
+    UnitVector3d f2(0.75, 1.0, 0.25);
+    std::vector<UnitVector3d> boundary = {
+        f1, f2, -f1, -f2, UnitVector3d(f1 + f2), -UnitVector3d(f1 + f2)
+    };
+    for (double alpha: {0.0, 30.0, 60.0, 90.0, 120.0, 179.0}) {
+        Angle a = Angle::fromDegrees(alpha);
+        checkBatchContains(Ellipse(f1, f2, a), boundary);
+        checkBatchContains(Ellipse(f1, a), boundary);
+        checkBatchContains(Ellipse(f1, f2, a).complemented(), boundary);
+    }
+    checkBatchContains(Ellipse::empty(), boundary);
+    checkBatchContains(Ellipse::full(), boundary);
+}
+
+// `checkRelation` verifies that the relationship r between the ellipse e and
+// the polygon p is consistent with point containment tests.
+void checkRelation(Ellipse const & e, ConvexPolygon const & p, Relationship r) {
+    std::vector<UnitVector3d> ellipsePoints = getPointsOnEllipse(e, 64);
+    std::vector<UnitVector3d> polygonPoints(p.getVertices());
+    polygonPoints.push_back(p.getCentroid());
+    if ((r & DISJOINT) != 0) {
+        for (UnitVector3d const & v: polygonPoints) { CHECK(!e.contains(v)); }
+        for (UnitVector3d const & v: ellipsePoints) { CHECK(!p.contains(v)); }
+    }
+    if ((r & CONTAINS) != 0) {
+        for (UnitVector3d const & v: polygonPoints) { CHECK(e.contains(v)); }
+    }
+    if ((r & WITHIN) != 0) {
+        for (UnitVector3d const & v: ellipsePoints) { CHECK(p.contains(v)); }
+    }
+}
+
+TEST_CASE(PolygonRelations) {
+    UnitVector3d center(LonLat::fromDegrees(30.0, 20.0));
+    std::vector<Ellipse> ellipses = {
+        Ellipse(center, Angle::fromDegrees(5.0), Angle::fromDegrees(0.1),
+                Angle::fromDegrees(30.0)),
+        Ellipse(center, Angle::fromDegrees(2.0), Angle::fromDegrees(1.0),
+                Angle::fromDegrees(-60.0)),
+        Ellipse(center, Angle::fromDegrees(1.0e-4), Angle::fromDegrees(1.0e-6),
+                Angle::fromDegrees(10.0)),
+        Ellipse(center, Angle::fromDegrees(3.0), Angle::fromDegrees(0.5),
+                Angle::fromDegrees(0.0)).complemented(),
+        Ellipse(center, Angle::fromDegrees(89.99), Angle::fromDegrees(89.9),
+                Angle::fromDegrees(0.0)),
+        Ellipse(center, Angle::fromDegrees(4.0))
+    };
+    for (Ellipse const & e: ellipses) {
+        Angle const size = std::min(e.getAlpha(),
+                                    Angle(PI) - e.getAlpha());
+        for (int i = -8; i <= 8; ++i) {
+            for (int j = -8; j <= 8; ++j) {
+                UnitVector3d v = center.rotatedAround(
+                    UnitVector3d::northFrom(center), size * (0.25 * i));
+                v = v.rotatedAround(center, Angle(PI) * (0.125 * j));
+                UnitVector3d w = v.rotatedAround(
+                    UnitVector3d::orthogonalTo(v), size * 0.1);
+                std::vector<UnitVector3d> points;
+                for (int k = 0; k < 4; ++k) {
+                    points.push_back(w.rotatedAround(v, Angle(0.5 * PI * k)));
+                }
+                ConvexPolygon p(points);
+                Relationship r = e.relate(p);
+                CHECK(r == invert(p.relate(e)));
+                checkRelation(e, p, r);
+            }
+        }
+    }
+    // A thin ellipse is tightly related to polygons that intersect its
+    // bounding circle but not the ellipse itself.
+    Ellipse const & thin = ellipses[0];
+    UnitVector3d const minor = UnitVector3d(
+        thin.getTransformMatrix().getRow(1));
+    UnitVector3d const axis(minor.cross(center));
+    UnitVector3d const v = center.rotatedAround(axis, Angle::fromDegrees(1.0));
+    ConvexPolygon p(v.rotatedAround(center, Angle(0.0)),
+                    v.rotatedAround(center, Angle::fromDegrees(1.0)),
+                    v.rotatedAround(center, Angle::fromDegrees(2.0)));
+    CHECK((thin.getBoundingCircle().relate(p) & DISJOINT) == 0);
+    CHECK(thin.relate(p) == DISJOINT);
+    // A polygon within the ellipse.
+    ConvexPolygon q(center.rotatedAround(minor, Angle::fromDegrees(1.0)),
+                    center.rotatedAround(minor, Angle::fromDegrees(-1.0)),
+                    center.rotatedAround(axis, Angle::fromDegrees(0.05)));
+    CHECK(thin.relate(q) == CONTAINS);
+}
+
+TEST_CASE(EllipseRelations) {
+    UnitVector3d center(LonLat::fromDegrees(-45.0, 60.0));
+    Ellipse thin(center, Angle::fromDegrees(5.0), Angle::fromDegrees(0.1),
+                 Angle::fromDegrees(0.0));
+    Ellipse crossing(center, Angle::fromDegrees(5.0), Angle::fromDegrees(0.1),
+                     Angle::fromDegrees(90.0));
+    UnitVector3d offset = center.rotatedAround(
+        UnitVector3d::northFrom(center), Angle::fromDegrees(1.0));
+    Ellipse parallel(offset, Angle::fromDegrees(4.0), Angle::fromDegrees(0.1),
+                     Angle::fromDegrees(0.0));
+    Ellipse inside(center, Angle::fromDegrees(1.0), Angle::fromDegrees(0.05),
+                   Angle::fromDegrees(0.0));
+    CHECK(thin.relate(crossing) == INTERSECTS);
+    CHECK(thin.relate(parallel) == DISJOINT);
+    CHECK(parallel.relate(thin) == DISJOINT);
+    CHECK(thin.relate(inside) == CONTAINS);
+    CHECK(inside.relate(thin) == WITHIN);
+    CHECK(thin.relate(Circle(center, Angle::fromDegrees(0.05))) == CONTAINS);
+    CHECK(thin.relate(Circle(offset, Angle::fromDegrees(0.5))) == DISJOINT);
+    CHECK(thin.relate(Circle(center, Angle::fromDegrees(10.0))) == WITHIN);
+    CHECK(thin.relate(Circle(center, Angle(0.5 * PI))) == WITHIN);
+    CHECK(thin.relate(Box::fromDegrees(-50.0, 50.0, -40.0, 70.0)) == WITHIN);
+}
@@ -0,0 +1,129 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains tests for the HtmCursor class.
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "lsst/sphgeom/HtmCursor.h"
+#include "lsst/sphgeom/HtmPixelization.h"
+#include "lsst/sphgeom/LonLat.h"
+
+#include "test.h"
+
+using namespace lsst::sphgeom;
+
+namespace {
+
+std::vector<UnitVector3d> randomPoints(size_t n, double lon, double lat,
+                                       double radius)
+{
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<double> u(-radius, radius);
+    std::vector<UnitVector3d> points;
+    for (size_t i = 0; i < n; ++i) {
+        points.push_back(UnitVector3d(LonLat::fromDegrees(lon + u(rng),
+                                                          lat + u(rng))));
+    }
+    return points;
+}
+
+} // unnamed namespace
+
+TEST_CASE(InvalidArguments) {
+    CHECK_THROW(HtmCursor(-1), std::invalid_argument);
+    CHECK_THROW(HtmCursor(HtmPixelization::MAX_LEVEL + 1),
+                std::invalid_argument);
+    HtmCursor c(5);
+    CHECK(c.getLevel() == 5);
+    CHECK_THROW(c.triangle(0), std::invalid_argument);
+    CHECK_THROW(c.triangle(7), std::invalid_argument);
+    CHECK_THROW(c.triangle(16), std::invalid_argument);
+}
+
+TEST_CASE(Index) {
+    for (int level: {0, 1, 7, 20, HtmPixelization::MAX_LEVEL}) {
+        HtmPixelization p(level);
+        HtmCursor c(level);
+        // Coherent points, widely scattered points, and points on
+        // root triangle boundaries.
+        std::vector<UnitVector3d> points = randomPoints(500, 10.0, 20.0, 0.1);
+        std::vector<UnitVector3d> scattered =
+            randomPoints(500, 180.0, 0.0, 90.0);
+        points.insert(points.end(), scattered.begin(), scattered.end());
+        for (UnitVector3d const & v: {UnitVector3d::X(), UnitVector3d::Y(),
+                                      -UnitVector3d::Z(),
+                                      UnitVector3d(1.0, 1.0, 0.0)}) {
+            points.push_back(v);
+        }
+        for (UnitVector3d const & v: points) {
+            CHECK(c.index(v) == p.index(v));
+        }
+    }
+}
+
+TEST_CASE(Triangle) {
+    std::vector<uint64_t> indexes;
+    HtmPixelization p(12);
+    for (UnitVector3d const & v: randomPoints(200, -40.0, -60.0, 1.0)) {
+        indexes.push_back(p.index(v));
+    }
+    std::sort(indexes.begin(), indexes.end());
+    // Mix in ancestors and indexes at other levels.
+    indexes.push_back(8);
+    indexes.push_back(indexes[17] >> 6);
+    indexes.push_back(indexes[17] << 8);
+    indexes.push_back(15);
+    HtmCursor c(0);
+    for (uint64_t i: indexes) {
+        CHECK(c.triangle(i) == HtmPixelization::triangle(i));
+    }
+}
+
+TEST_CASE(IncrementalCost) {
+    HtmCursor c(0);
+    uint64_t const first = static_cast<uint64_t>(8) << 40;
+    c.triangle(first);
+    CHECK(c.getNumExpansions() == 20);
+    // Siblings share a parent, whose midpoints are already known.
+    c.triangle(first + 1);
+    c.triangle(first + 3);
+    CHECK(c.getNumExpansions() == 20);
+    // Moving to a cousin expands one new triangle.
+    c.triangle(first + 4);
+    CHECK(c.getNumExpansions() == 21);
+    // Ancestors are free.
+    c.triangle(first >> 10);
+    CHECK(c.getNumExpansions() == 21);
+    // Indexing a point inside the last triangle expands only the
+    // triangles below it.
+    HtmCursor d(20);
+    UnitVector3d v = UnitVector3d(LonLat::fromDegrees(1.0, 2.0));
+    d.index(v);
+    CHECK(d.getNumExpansions() == 20);
+    d.index(v);
+    CHECK(d.getNumExpansions() == 20);
+}
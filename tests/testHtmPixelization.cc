@@ -23,11 +23,18 @@
 /// \file
 /// \brief This file contains tests for HTM indexing.
 
+#include "lsst/sphgeom/Box.h"
 #include "lsst/sphgeom/Circle.h"
+#include "lsst/sphgeom/ConvexPolygon.h"
+#include "lsst/sphgeom/Ellipse.h"
 #include "lsst/sphgeom/LonLat.h"
 #include "lsst/sphgeom/HtmPixelization.h"
 #include "lsst/sphgeom/UnitVector3d.h"
 
+#include <atomic>
+#include <chrono>
+#include <vector>
+
 #include "test.h"
 
 using namespace lsst::sphgeom;
@@ -164,6 +171,50 @@ TEST_CASE(Index) {
     CHECK(s == RangeSet({704643072, 738197504, 838860800, 872415232}));
 }
 
+TEST_CASE(BatchIndex) {
+    // Points on a longitude/latitude grid, along with the vertices and edge
+    // midpoints of level 3 trixels. The latter lie on trixel boundaries at
+    // every subsequent subdivision level, and so exercise the exact
+    // orientation fallback.
+    std::vector<UnitVector3d> points;
+    for (double lat = -90.0; lat <= 90.0; lat += 5.1) {
+        for (double lon = 0.0; lon < 360.0; lon += 7.3) {
+            points.push_back(UnitVector3d(LonLat::fromDegrees(lon, lat)));
+        }
+    }
+    for (uint64_t i = 8 * 64; i < 16 * 64; ++i) {
+        ConvexPolygon t = HtmPixelization::triangle(i);
+        for (int j = 0; j < 3; ++j) {
+            UnitVector3d const & v0 = t.getVertices()[j];
+            UnitVector3d const & v1 = t.getVertices()[(j + 1) % 3];
+            points.push_back(v0);
+            points.push_back(UnitVector3d(v0 + v1));
+        }
+    }
+    std::vector<double> x, y, z;
+    for (UnitVector3d const & v: points) {
+        x.push_back(v.x());
+        y.push_back(v.y());
+        z.push_back(v.z());
+    }
+    std::vector<uint64_t> indexes(points.size() + 1, 0);
+    std::vector<uint64_t> soaIndexes(points.size() + 1, 0);
+    for (int level = 0; level <= HtmPixelization::MAX_LEVEL; ++level) {
+        HtmPixelization p(level);
+        // Use an odd number of points, so that the non-SIMD tail is tested.
+        size_t n = points.size() - (points.size() % 2 == 0 ? 1 : 0);
+        p.index(points.data(), indexes.data(), n);
+        p.index(x.data(), y.data(), z.data(), soaIndexes.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t index = p.index(points[i]);
+            CHECK(indexes[i] == index);
+            CHECK(soaIndexes[i] == index);
+        }
+        CHECK(indexes[n] == 0);
+        CHECK(soaIndexes[n] == 0);
+    }
+}
+
 TEST_CASE(Adaptivity) {
     UnitVector3d center(1.0, 1.0, 1.0);
     for (int level = 0; level <= 13; ++level) {
@@ -191,3 +242,148 @@ TEST_CASE(Adaptivity) {
         }
     }
 }
+
+TEST_CASE(EllipseTraversal) {
+    UnitVector3d center(LonLat::fromDegrees(120.0, -35.0));
+    Ellipse e(center, Angle::fromDegrees(2.0), Angle::fromDegrees(0.2),
+              Angle::fromDegrees(40.0));
+    HtmPixelization p(10);
+    RangeSet envelope = p.envelope(e, 0);
+    RangeSet interior = p.interior(e, 0);
+    RangeSet circleEnvelope = p.envelope(e.getBoundingCircle(), 0);
+    CHECK(envelope.contains(interior));
+    CHECK(circleEnvelope.contains(envelope));
+    // The envelope of a thin ellipse should be much smaller than the
+    // envelope of its bounding circle.
+    CHECK(4 * envelope.cardinality() < circleEnvelope.cardinality());
+    CHECK(!interior.empty());
+    for (auto const & r: interior) {
+        for (uint64_t i = std::get<0>(r); i != std::get<1>(r); ++i) {
+            CHECK(e.relate(p.triangle(i)) == CONTAINS);
+        }
+    }
+    // Pixels containing points on the ellipse boundary must be in the
+    // envelope but not in the interior.
+    Matrix3d m = e.getTransformMatrix().transpose();
+    double tana = tan(e.getAlpha() - Angle(0.5 * PI));
+    double tanb = tan(e.getBeta() - Angle(0.5 * PI));
+    for (int i = 0; i < 360; ++i) {
+        double c = std::cos(i * PI / 180.0);
+        double s = std::sin(i * PI / 180.0);
+        double t = 1.0 / std::sqrt(c * c * tana * tana + s * s * tanb * tanb);
+        uint64_t index = p.index(UnitVector3d(m * Vector3d(t * c, t * s, 1.0)));
+        CHECK(envelope.contains(index));
+        CHECK(!interior.contains(index));
+    }
+}
+
+TEST_CASE(ParallelTraversal) {
+    Circle c(UnitVector3d(1.0, 1.0, 1.0), Angle::fromDegrees(10.0));
+    Box b(NormalizedAngleInterval::fromDegrees(350.0, 20.0),
+          AngleInterval::fromDegrees(-30.0, 5.0));
+    ConvexPolygon cp(UnitVector3d(1.0, 0.1, 0.2),
+                     UnitVector3d(0.1, 1.0, -0.3),
+                     UnitVector3d(-0.2, 0.2, 1.0));
+    Region const * regions[3] = {&c, &b, &cp};
+    for (int level = 0; level <= 10; level += 2) {
+        HtmPixelization p(level);
+        for (Region const * r: regions) {
+            RangeSet envelope = p.envelope(*r);
+            RangeSet interior = p.interior(*r);
+            for (unsigned int numThreads: {0u, 2u, 3u, 8u}) {
+                TraversalOptions options;
+                options.numThreads = numThreads;
+                // Without a range count limit, results must be identical
+                // to those of a single-threaded traversal.
+                CHECK(p.envelope(*r, 0, options) == envelope);
+                CHECK(p.interior(*r, 0, options) == interior);
+                for (size_t maxRanges = 64; maxRanges != 0; maxRanges /= 4) {
+                    RangeSet s = p.envelope(*r, maxRanges, options);
+                    CHECK(s.size() <= maxRanges);
+                    CHECK(s.contains(envelope));
+                    s = p.interior(*r, maxRanges, options);
+                    CHECK(s.size() <= maxRanges);
+                    CHECK(interior.contains(s));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(TraversalLimits) {
+    Circle c(UnitVector3d(1.0, -1.0, 0.5), Angle::fromDegrees(15.0));
+    HtmPixelization p(10);
+    TraversalStats stats;
+    TraversalOptions options;
+    options.stats = &stats;
+    RangeSet envelope = p.envelope(c, 0, options);
+    CHECK(!stats.truncated);
+    uint64_t nodesVisited = stats.nodesVisited;
+    CHECK(nodesVisited > 1000);
+    RangeSet interior = p.interior(c, 0, options);
+    CHECK(!stats.truncated);
+    CHECK(stats.nodesVisited == nodesVisited);
+    // Results obtained with a node budget must be coarser, but still
+    // correct, approximations of the exact results.
+    for (unsigned int numThreads: {1u, 3u}) {
+        options.numThreads = numThreads;
+        for (uint64_t maxNodes: {1, 10, 100, 1000, 10000}) {
+            options.maxNodes = maxNodes;
+            RangeSet s = p.envelope(c, 0, options);
+            CHECK(stats.nodesVisited <= maxNodes);
+            CHECK(stats.truncated == (maxNodes < nodesVisited));
+            CHECK(s.contains(envelope));
+            s = p.interior(c, 0, options);
+            CHECK(stats.nodesVisited <= maxNodes);
+            CHECK(stats.truncated == (maxNodes < nodesVisited));
+            CHECK(interior.contains(s));
+            if (!stats.truncated) {
+                CHECK(s == interior);
+            }
+        }
+    }
+    // A cancelled traversal or one with an expired deadline must not
+    // examine any pixels.
+    std::atomic<bool> cancelled(true);
+    options = TraversalOptions();
+    options.stats = &stats;
+    options.cancelled = &cancelled;
+    CHECK(p.envelope(c, 0, options) == p.universe());
+    CHECK(stats.truncated);
+    CHECK(stats.nodesVisited == 0);
+    CHECK(p.interior(c, 0, options).empty());
+    options.cancelled = nullptr;
+    options.deadline = std::chrono::steady_clock::now();
+    CHECK(p.envelope(c, 0, options) == p.universe());
+    CHECK(stats.truncated);
+    CHECK(stats.nodesVisited == 0);
+}
+
+TEST_CASE(StreamEnvelope) {
+    Circle circles[3] = {
+        Circle(UnitVector3d(1.0, 2.0, -0.5), Angle::fromDegrees(0.01)),
+        Circle(UnitVector3d(-1.0, 0.5, 0.25), Angle::fromDegrees(20.0)),
+        Circle::full()
+    };
+    for (int level: {0, 3, 8, 13}) {
+        HtmPixelization p(level);
+        for (Circle const & c: circles) {
+            RangeSet s;
+            bool first = true;
+            bool ordered = true;
+            uint64_t end = 0;
+            p.streamEnvelope(c, [&](uint64_t a, uint64_t b) {
+                // Ranges must be emitted in ascending order, and must
+                // not be adjacent.
+                if (!first && (end == 0 || a <= end)) {
+                    ordered = false;
+                }
+                first = false;
+                end = b;
+                s.insert(a, b);
+            });
+            CHECK(ordered);
+            CHECK(s == p.envelope(c));
+        }
+    }
+}
@@ -0,0 +1,141 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains tests for the HtmVertexTable class.
+
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "lsst/sphgeom/HtmPixelization.h"
+#include "lsst/sphgeom/HtmVertexTable.h"
+#include "lsst/sphgeom/UnitVector3d.h"
+
+#include "test.h"
+
+using namespace lsst::sphgeom;
+
+namespace {
+
+std::vector<UnitVector3d> randomPoints(size_t n) {
+    std::mt19937_64 rng(54321);
+    std::normal_distribution<double> normal;
+    std::vector<UnitVector3d> points;
+    for (size_t i = 0; i < n; ++i) {
+        points.push_back(UnitVector3d(normal(rng), normal(rng), normal(rng)));
+    }
+    // Add points on root triangle vertices and edges.
+    points.push_back(UnitVector3d::X());
+    points.push_back(-UnitVector3d::Y());
+    points.push_back(UnitVector3d::Z());
+    points.push_back(UnitVector3d(1.0, -1.0, 0.0));
+    points.push_back(UnitVector3d(0.0, 1.0, 1.0));
+    return points;
+}
+
+} // unnamed namespace
+
+TEST_CASE(InvalidArguments) {
+    CHECK_THROW(HtmVertexTable(-1), std::invalid_argument);
+    CHECK_THROW(HtmVertexTable(HtmVertexTable::MAX_DEPTH + 1),
+                std::invalid_argument);
+    HtmVertexTable t(2);
+    CHECK(t.getDepth() == 2);
+    CHECK_THROW(t.index(UnitVector3d::X(), -1), std::invalid_argument);
+    CHECK_THROW(t.index(UnitVector3d::X(), HtmPixelization::MAX_LEVEL + 1),
+                std::invalid_argument);
+    CHECK_THROW(t.triangle(0), std::invalid_argument);
+    CHECK_THROW(t.triangle(16), std::invalid_argument);
+}
+
+TEST_CASE(Index) {
+    std::vector<UnitVector3d> points = randomPoints(1000);
+    for (int depth: {0, 1, 5}) {
+        HtmVertexTable t(depth);
+        for (int level: {0, 1, 4, 5, 6, 13, HtmPixelization::MAX_LEVEL}) {
+            HtmPixelization p(level);
+            for (UnitVector3d const & v: points) {
+                CHECK(t.index(v, level) == p.index(v));
+            }
+        }
+    }
+}
+
+TEST_CASE(IndexBelowDepth) {
+    // Levels deeper than the table depth compute midpoints on the fly.
+    // The returned triangles must contain the points they index.
+    std::vector<UnitVector3d> points = randomPoints(200);
+    HtmVertexTable t(2);
+    for (int level: {3, 8, HtmPixelization::MAX_LEVEL}) {
+        for (UnitVector3d const & v: points) {
+            uint64_t i = t.index(v, level);
+            CHECK(HtmPixelization::level(i) == level);
+            CHECK(t.triangle(i).contains(v));
+        }
+    }
+}
+
+TEST_CASE(Triangle) {
+    std::vector<UnitVector3d> points = randomPoints(200);
+    HtmVertexTable t(5);
+    for (int level: {0, 3, 4, 5, 6, 17}) {
+        HtmPixelization p(level);
+        for (UnitVector3d const & v: points) {
+            uint64_t i = p.index(v);
+            UnitVector3d verts[3];
+            t.vertices(i, verts);
+            ConvexPolygon triangle = HtmPixelization::triangle(i);
+            std::vector<UnitVector3d> const & expected =
+                triangle.getVertices();
+            CHECK(verts[0] == expected[0]);
+            CHECK(verts[1] == expected[1]);
+            CHECK(verts[2] == expected[2]);
+            CHECK(t.triangle(i) == triangle);
+        }
+    }
+}
+
+TEST_CASE(Threads) {
+    // Concurrent first use builds the table exactly once.
+    HtmVertexTable t(6);
+    HtmPixelization p(12);
+    std::vector<UnitVector3d> points = randomPoints(500);
+    std::vector<int> failures(4, 0);
+    std::vector<std::thread> threads;
+    for (int j = 0; j < 4; ++j) {
+        threads.emplace_back([&, j]() {
+            for (UnitVector3d const & v: points) {
+                if (t.index(v, 12) != p.index(v)) {
+                    ++failures[j];
+                }
+            }
+        });
+    }
+    for (auto & thread: threads) {
+        thread.join();
+    }
+    for (int f: failures) {
+        CHECK(f == 0);
+    }
+}
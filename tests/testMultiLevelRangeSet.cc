@@ -0,0 +1,212 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains tests for the MultiLevelRangeSet class.
+
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "lsst/sphgeom/Circle.h"
+#include "lsst/sphgeom/HtmPixelization.h"
+#include "lsst/sphgeom/LonLat.h"
+#include "lsst/sphgeom/MultiLevelRangeSet.h"
+#include "lsst/sphgeom/Mq3cPixelization.h"
+#include "lsst/sphgeom/Q3cPixelization.h"
+#include "lsst/sphgeom/UnitVector3d.h"
+
+#include "test.h"
+
+
+using namespace lsst::sphgeom;
+
+namespace {
+
+// `randomSet` returns a set of about n ranges of level 10 HTM indexes.
+RangeSet randomSet(std::mt19937_64 & rng, size_t n) {
+    RangeSet universe = HtmPixelization(10).universe();
+    uint64_t const begin = std::get<0>(*universe.begin());
+    uint64_t const end = std::get<1>(*universe.begin());
+    std::uniform_int_distribution<uint64_t> dist(begin, end - 1);
+    std::geometric_distribution<uint64_t> length(1.0 / 300.0);
+    RangeSet s;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t first = dist(rng);
+        s.insert(first, std::min(end, first + length(rng) + 1));
+    }
+    return s;
+}
+
+} // unnamed namespace
+
+
+TEST_CASE(Empty) {
+    MultiLevelRangeSet s;
+    CHECK(s.isValid());
+    CHECK(s.empty());
+    CHECK(s.getMaxLevel() == -1);
+    CHECK(s.size() == 0);
+    CHECK(s.toRangeSet(5).empty());
+    CHECK(s.getCells(0).empty());
+    CHECK(!s.contains(8, 0) && !s.intersects(8, 0));
+    CHECK(MultiLevelRangeSet(RangeSet(), 10) == s);
+}
+
+TEST_CASE(Normalization) {
+    // HTM pixels 32-35 are the children of pixel 8.
+    MultiLevelRangeSet s(RangeSet(32, 36), 1);
+    CHECK(s.isValid());
+    CHECK(s.getMaxLevel() == 0);
+    CHECK(s.getCells(0) == RangeSet(8));
+    CHECK(s.getCells(1).empty());
+    CHECK(s.toRangeSet(1) == RangeSet(32, 36));
+    CHECK(s.toRangeSet(2) == RangeSet(128, 144));
+    // Pixels 33-40 at level 1 consist of 3 children of pixel 8, all the
+    // children of pixel 9, and the first child of pixel 10.
+    s = MultiLevelRangeSet(RangeSet(33, 41), 1);
+    CHECK(s.isValid());
+    CHECK(s.getMaxLevel() == 1);
+    CHECK(s.getCells(0) == RangeSet(9));
+    CHECK(s.getCells(1) == RangeSet({{33, 36}, {40, 41}}));
+    CHECK(s.size() == 3);
+    CHECK(s.toRangeSet(1) == RangeSet(33, 41));
+    CHECK(s.toRangeSet(0) == RangeSet(8, 11));
+    CHECK(s.contains(9, 0) && !s.contains(8, 0) && !s.contains(10, 0));
+    CHECK(s.intersects(8, 0) && s.intersects(10, 0) && !s.intersects(11, 0));
+    CHECK(s.contains(37, 1) && s.contains(150, 2) && !s.contains(32, 1));
+    CHECK(s.intersects(33, 1) && !s.intersects(32, 1));
+    CHECK(s.intersects(160, 2) && !s.intersects(164, 2));
+}
+
+TEST_CASE(Universes) {
+    // Check that the largest pixel indexes, where range end points wrap
+    // around to 0, are handled.
+    for (int level: {0, 1, 7, 24}) {
+        RangeSet u = HtmPixelization(level).universe();
+        MultiLevelRangeSet s(u, level);
+        CHECK(s.isValid());
+        CHECK(s.getMaxLevel() == 0);
+        CHECK(s.getCells(0) == RangeSet(8, 16));
+        CHECK(s.toRangeSet(level) == u);
+    }
+    for (int level: {0, 1, 29, 30}) {
+        RangeSet u = Q3cPixelization(level).universe();
+        MultiLevelRangeSet s(u, level);
+        CHECK(s.isValid() && s.getCells(0) == RangeSet(0, 6));
+        CHECK(s.toRangeSet(level) == u);
+        u = Mq3cPixelization(level).universe();
+        s = MultiLevelRangeSet(u, level);
+        CHECK(s.isValid() && s.getCells(0) == RangeSet(10, 16));
+        CHECK(s.toRangeSet(level) == u);
+    }
+    MultiLevelRangeSet full(RangeSet(0, 0), 30);
+    CHECK(full.isValid());
+    CHECK(full.getCells(0) == RangeSet(0, 16));
+    CHECK(full.toRangeSet(30).full());
+    CHECK(full.contains(~uint64_t(0), 30));
+    MultiLevelRangeSet last(RangeSet(~uint64_t(0)), 30);
+    CHECK(last.isValid());
+    CHECK(last.getMaxLevel() == 30);
+    CHECK(last.toRangeSet(30) == RangeSet(~uint64_t(0)));
+    CHECK(last.toRangeSet(0) == RangeSet(15));
+    CHECK(last.intersects(15, 0) && !last.contains(15, 0));
+}
+
+TEST_CASE(RoundTrip) {
+    std::mt19937_64 rng(1);
+    for (size_t n: {1, 2, 10, 100, 1000}) {
+        RangeSet s = randomSet(rng, n);
+        MultiLevelRangeSet m(s, 10);
+        CHECK(m.isValid());
+        CHECK(m.toRangeSet(10) == s);
+        CHECK(m.toRangeSet(12) == s.scaled(16));
+        CHECK(MultiLevelRangeSet(s.scaled(16), 12) == m);
+        // Converting to a coarser level yields the pixels intersecting
+        // the set.
+        RangeSet coarse = m.toRangeSet(7);
+        CHECK(coarse.scaled(64).contains(s));
+        for (auto const & r: coarse) {
+            for (uint64_t i = std::get<0>(r); i != std::get<1>(r); ++i) {
+                CHECK(m.intersects(i, 7));
+                CHECK(s.intersects(i * 64, (i + 1) * 64));
+                CHECK(m.contains(i, 7) == s.contains(i * 64, (i + 1) * 64));
+            }
+        }
+    }
+    // Pixelized circles have large interiors and finely subdivided edges.
+    UnitVector3d center(LonLat::fromDegrees(12.0, 34.0));
+    for (int level: {8, 12, 16}) {
+        HtmPixelization pixelization(level);
+        RangeSet s = pixelization.envelope(Circle(center, Angle(0.1)));
+        MultiLevelRangeSet m(s, level);
+        CHECK(m.isValid());
+        CHECK(m.toRangeSet(level) == s);
+        CHECK(m.getMaxLevel() == level);
+    }
+}
+
+TEST_CASE(SetOperations) {
+    std::mt19937_64 rng(2);
+    for (int i = 0; i < 20; ++i) {
+        RangeSet a = randomSet(rng, 50);
+        RangeSet b = randomSet(rng, 50);
+        // Build the second set at a finer level, so that operands have
+        // different maximum levels.
+        MultiLevelRangeSet ma(a, 10);
+        MultiLevelRangeSet mb(b.scaled(4), 11);
+        CHECK((ma & mb).isValid() && (ma & mb).toRangeSet(10) == (a & b));
+        CHECK((ma | mb).isValid() && (ma | mb).toRangeSet(10) == (a | b));
+        CHECK((ma - mb).isValid() && (ma - mb).toRangeSet(10) == (a - b));
+        CHECK((ma ^ mb).isValid() && (ma ^ mb).toRangeSet(10) == (a ^ b));
+        CHECK(ma.intersects(mb) == a.intersects(b));
+        CHECK(ma.contains(mb) == a.contains(b));
+        CHECK((ma | mb).contains(ma) && (ma | mb).contains(mb));
+        MultiLevelRangeSet c(ma);
+        c -= mb;
+        c |= mb;
+        CHECK(c == (ma | mb));
+        c &= ma;
+        CHECK(c == ma);
+        c ^= ma;
+        CHECK(c.empty());
+    }
+}
+
+TEST_CASE(InvalidLevels) {
+    MultiLevelRangeSet s(RangeSet(8), 0);
+    CHECK_THROW(MultiLevelRangeSet(RangeSet(8), -1), std::invalid_argument);
+    CHECK_THROW(MultiLevelRangeSet(RangeSet(8), 31), std::invalid_argument);
+    CHECK_THROW(s.getCells(31), std::invalid_argument);
+    CHECK_THROW(s.toRangeSet(-1), std::invalid_argument);
+    CHECK_THROW(s.contains(8, 31), std::invalid_argument);
+    CHECK_THROW(s.intersects(8, -1), std::invalid_argument);
+}
+
+TEST_CASE(Stream) {
+    std::ostringstream os;
+    os << MultiLevelRangeSet(RangeSet(33, 41), 1);
+    CHECK(os.str() == "{\"MultiLevelRangeSet\": {"
+                      "\"0\": {\"RangeSet\": [[9, 10]]}, "
+                      "\"1\": {\"RangeSet\": [[33, 36], [40, 41]]}}}");
+}
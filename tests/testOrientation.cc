@@ -23,6 +23,9 @@
 /// \file
 /// \brief This file contains tests for the orientation function.
 
+#include <cmath>
+#include <random>
+
 #include "lsst/sphgeom/orientation.h"
 
 #include "test.h"
@@ -99,3 +102,49 @@ TEST_CASE(OrientationOverflow) {
     Vector3d v2(1.0e300, 0.0, 1.0e300);
     CHECK(orientationExact(v0, v1, v2) == 1);
 }
+
+TEST_CASE(NearlyCoplanar) {
+    // Generate points on or very near the great circles through pairs of
+    // nearby random points, and check that the staged computation agrees
+    // with arbitrary precision arithmetic.
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    resetOrientationCounts();
+    setOrientationCounting(true);
+    for (int i = 0; i < 20000; ++i) {
+        UnitVector3d b(uniform(rng), uniform(rng), uniform(rng));
+        double scale = std::ldexp(1.0, -(i % 40));
+        UnitVector3d c(b + scale * Vector3d(uniform(rng), uniform(rng),
+                                            uniform(rng)));
+        double t = 2.0 * uniform(rng);
+        Vector3d v = b + t * (c - b);
+        v.normalize();
+        // Perturb one component of v by a few ulps.
+        double x = v.x();
+        for (int j = i % 4; j > 0; --j) {
+            x = std::nextafter(x, 2.0);
+        }
+        UnitVector3d a = UnitVector3d::fromNormalized(x, v.y(), v.z());
+        CHECK(orientation(a, b, c) == orientationExact(a, b, c));
+        CHECK(orientation(b, c, a) == orientationExact(b, c, a));
+        CHECK(orientation(c, a, b) == orientationExact(c, a, b));
+        UnitVector3d z = UnitVector3d::fromNormalized(b.x(), b.y(), 0.0);
+        CHECK(orientationZ(a, b) == orientationExact(UnitVector3d::Z(), a, b));
+        CHECK(orientationZ(b, z) == orientationExact(UnitVector3d::Z(), b, z));
+    }
+    CHECK(orientation(UnitVector3d::X(), UnitVector3d::Y(),
+                      UnitVector3d::Z()) == 1);
+    setOrientationCounting(false);
+    OrientationCounts counts = getOrientationCounts();
+    CHECK(counts.fixedBound > 0);
+    CHECK(counts.exactMinors > 0);
+    CHECK(counts.expansion > 0);
+    CHECK(counts.fixedBound + counts.permanentBound + counts.degenerate +
+          counts.exactMinors + counts.expansion +
+          counts.arbitraryPrecision == 60001);
+    // Counting is off, so the counts must not change.
+    orientation(UnitVector3d::X(), UnitVector3d::Y(), UnitVector3d::Z());
+    CHECK(getOrientationCounts().fixedBound == counts.fixedBound);
+    resetOrientationCounts();
+    CHECK(getOrientationCounts().expansion == 0);
+}
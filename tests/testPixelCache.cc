@@ -0,0 +1,179 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains tests for the PixelCache class.
+
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "lsst/sphgeom/ConvexPolygon.h"
+#include "lsst/sphgeom/HtmPixelization.h"
+#include "lsst/sphgeom/Mq3cPixelization.h"
+#include "lsst/sphgeom/PixelCache.h"
+#include "lsst/sphgeom/Q3cPixelization.h"
+
+#include "test.h"
+
+using namespace lsst::sphgeom;
+
+namespace {
+
+void insertPixel(PixelCache & cache, uint64_t i) {
+    UnitVector3d v[3] = {UnitVector3d::X(), UnitVector3d::Y(),
+                         UnitVector3d::Z()};
+    cache.insert(PixelCache::Scheme::HTM, 0, i, v, 3);
+}
+
+bool findPixel(PixelCache & cache, uint64_t i) {
+    UnitVector3d v[PixelCache::MAX_VERTICES];
+    return cache.find(PixelCache::Scheme::HTM, 0, i, v) != 0;
+}
+
+void checkPixels(Pixelization const & cached, Pixelization const & plain) {
+    RangeSet u = plain.universe();
+    uint64_t first = std::get<0>(*u.begin());
+    for (int pass = 0; pass < 2; ++pass) {
+        for (uint64_t i = first; i < first + 64; ++i) {
+            auto a = cached.pixel(i);
+            auto b = plain.pixel(i);
+            CHECK(static_cast<ConvexPolygon &>(*a) ==
+                  static_cast<ConvexPolygon &>(*b));
+        }
+    }
+}
+
+} // unnamed namespace
+
+TEST_CASE(InvalidArguments) {
+    CHECK_THROW(PixelCache(0), std::invalid_argument);
+    PixelCache cache(1);
+    UnitVector3d v[5];
+    CHECK_THROW(cache.insert(PixelCache::Scheme::HTM, 0, 8, v, 0),
+                std::invalid_argument);
+    CHECK_THROW(cache.insert(PixelCache::Scheme::HTM, 0, 8, v, 5),
+                std::invalid_argument);
+}
+
+TEST_CASE(FindAndInsert) {
+    PixelCache cache(4);
+    CHECK(cache.getCapacity() == 4);
+    CHECK(!findPixel(cache, 8));
+    insertPixel(cache, 8);
+    UnitVector3d v[PixelCache::MAX_VERTICES];
+    CHECK(cache.find(PixelCache::Scheme::HTM, 0, 8, v) == 3);
+    CHECK(v[0] == UnitVector3d::X());
+    CHECK(v[1] == UnitVector3d::Y());
+    CHECK(v[2] == UnitVector3d::Z());
+    // Pixels from different schemes or levels are distinct.
+    CHECK(cache.find(PixelCache::Scheme::Q3C, 0, 8, v) == 0);
+    CHECK(cache.find(PixelCache::Scheme::HTM, 1, 8, v) == 0);
+    PixelCache::Statistics s = cache.getStatistics();
+    CHECK(s.hits == 1);
+    CHECK(s.misses == 3);
+    CHECK(s.evictions == 0);
+    CHECK(s.size == 1);
+    CHECK(s.capacity == 4);
+    cache.clear();
+    CHECK(!findPixel(cache, 8));
+    s = cache.getStatistics();
+    CHECK(s.hits == 0 && s.misses == 1 && s.size == 0 && s.capacity == 4);
+}
+
+TEST_CASE(ClockEviction) {
+    PixelCache cache(4);
+    for (uint64_t i = 8; i < 12; ++i) {
+        insertPixel(cache, i);
+    }
+    // Reference every pixel but 9, which must then be evicted first.
+    CHECK(findPixel(cache, 8));
+    CHECK(findPixel(cache, 10));
+    CHECK(findPixel(cache, 11));
+    insertPixel(cache, 12);
+    CHECK(!findPixel(cache, 9));
+    CHECK(findPixel(cache, 8));
+    CHECK(findPixel(cache, 10));
+    CHECK(findPixel(cache, 11));
+    CHECK(findPixel(cache, 12));
+    PixelCache::Statistics s = cache.getStatistics();
+    CHECK(s.evictions == 1);
+    CHECK(s.size == 4);
+    // The cache never grows beyond its capacity.
+    for (uint64_t i = 100; i < 200; ++i) {
+        insertPixel(cache, i);
+    }
+    s = cache.getStatistics();
+    CHECK(s.size == 4);
+    CHECK(s.evictions == 101);
+    CHECK(findPixel(cache, 199));
+}
+
+TEST_CASE(Pixelizations) {
+    auto cache = std::make_shared<PixelCache>(1024);
+    checkPixels(HtmPixelization(7, cache), HtmPixelization(7));
+    checkPixels(Q3cPixelization(7, cache), Q3cPixelization(7));
+    checkPixels(Mq3cPixelization(7, cache), Mq3cPixelization(7));
+    PixelCache::Statistics s = cache->getStatistics();
+    CHECK(s.size == 3 * 64);
+    CHECK(s.misses == 3 * 64);
+    CHECK(s.hits == 3 * 64);
+    Q3cPixelization q(3, cache);
+    CHECK(q.getCache() == cache);
+    CHECK(q.quad(17) == Q3cPixelization(3).quad(17));
+    CHECK_THROW(HtmPixelization(7, cache).pixel(7), std::invalid_argument);
+    CHECK_THROW(Q3cPixelization(7, cache).pixel(6 << 14),
+                std::invalid_argument);
+    CHECK_THROW(Mq3cPixelization(7, cache).pixel(7), std::invalid_argument);
+}
+
+TEST_CASE(Threads) {
+    auto cache = std::make_shared<PixelCache>(64);
+    HtmPixelization cached(10, cache);
+    HtmPixelization plain(10);
+    uint64_t const first = static_cast<uint64_t>(8) << 20;
+    std::vector<std::thread> threads;
+    std::vector<int> failures(4, 0);
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            for (uint64_t j = 0; j < 2000; ++j) {
+                uint64_t i = first + (j * 7 + t) % 100;
+                auto a = cached.pixel(i);
+                auto b = plain.pixel(i);
+                if (!(static_cast<ConvexPolygon &>(*a) ==
+                      static_cast<ConvexPolygon &>(*b))) {
+                    ++failures[t];
+                }
+            }
+        });
+    }
+    for (auto & thread: threads) {
+        thread.join();
+    }
+    for (int f: failures) {
+        CHECK(f == 0);
+    }
+    PixelCache::Statistics s = cache->getStatistics();
+    CHECK(s.hits + s.misses == 8000);
+    CHECK(s.size == 64);
+}
@@ -24,8 +24,13 @@
 /// \brief This file contains tests for Q3C indexing.
 
 #include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
 
 #include "lsst/sphgeom/Circle.h"
+#include "lsst/sphgeom/ConvexPolygon.h"
 #include "lsst/sphgeom/LonLat.h"
 #include "lsst/sphgeom/Q3cPixelization.h"
 #include "lsst/sphgeom/UnitVector3d.h"
@@ -135,6 +140,45 @@ TEST_CASE(IndexPoint) {
 }
 
 
+TEST_CASE(BatchIndex) {
+    // Points on a longitude/latitude grid, along with points on or near
+    // cube face boundaries.
+    std::vector<UnitVector3d> points;
+    for (double lat = -90.0; lat <= 90.0; lat += 3.7) {
+        for (double lon = 0.0; lon < 360.0; lon += 4.9) {
+            points.push_back(UnitVector3d(LonLat::fromDegrees(lon, lat)));
+        }
+    }
+    for (double x = -1.0; x <= 1.0; x += 0.5) {
+        for (double y = -1.0; y <= 1.0; y += 0.5) {
+            for (double z = -1.0; z <= 1.0; z += 0.5) {
+                if (x != 0.0 || y != 0.0 || z != 0.0) {
+                    points.push_back(UnitVector3d(x, y, z));
+                }
+            }
+        }
+    }
+    std::vector<double> x, y, z;
+    for (UnitVector3d const & v: points) {
+        x.push_back(v.x());
+        y.push_back(v.y());
+        z.push_back(v.z());
+    }
+    // Use an odd number of points, so that the non-SIMD tail is tested.
+    size_t n = points.size() - (points.size() % 2 == 0 ? 1 : 0);
+    std::vector<uint64_t> i0(n), i1(n);
+    for (int level = 0; level <= Q3cPixelization::MAX_LEVEL; ++level) {
+        Q3cPixelization p(level);
+        p.index(points.data(), i0.data(), n);
+        p.index(x.data(), y.data(), z.data(), i1.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t index = p.index(points[i]);
+            CHECK(i0[i] == index);
+            CHECK(i1[i] == index);
+        }
+    }
+}
+
 TEST_CASE(Envelope) {
     auto pixelization = Q3cPixelization(1);
     auto universe = pixelization.universe();
@@ -179,3 +223,76 @@ TEST_CASE(Neighborhood) {
         }
     }
 }
+
+TEST_CASE(ParallelTraversal) {
+    // Generate random circles and polygons with sizes ranging from
+    // sub-pixel to a sizeable fraction of the sky.
+    std::mt19937_64 rng(5);
+    std::normal_distribution<double> normal;
+    std::uniform_real_distribution<double> uniform;
+    std::vector<std::unique_ptr<Region>> regions;
+    for (int i = 0; i < 10; ++i) {
+        UnitVector3d v(normal(rng), normal(rng), normal(rng));
+        double radius = std::pow(10.0, -2.0 + 2.0 * uniform(rng));
+        regions.emplace_back(new Circle(v, Angle(radius)));
+        std::vector<UnitVector3d> points;
+        for (int j = 0; j < 6; ++j) {
+            points.push_back(UnitVector3d(
+                v + radius * Vector3d(normal(rng), normal(rng), normal(rng))));
+        }
+        regions.emplace_back(
+            new ConvexPolygon(ConvexPolygon::convexHull(points)));
+    }
+    for (int level: {0, 4, 8, 10}) {
+        Q3cPixelization p(level);
+        for (auto const & r: regions) {
+            RangeSet envelope = p.envelope(*r);
+            RangeSet interior = p.interior(*r);
+            for (unsigned int numThreads: {2u, 3u, 8u}) {
+                TraversalOptions options;
+                options.numThreads = numThreads;
+                // Without a range count limit, results must be identical
+                // to those of a single-threaded traversal.
+                CHECK(p.envelope(*r, 0, options) == envelope);
+                CHECK(p.interior(*r, 0, options) == interior);
+                for (size_t maxRanges = 64; maxRanges != 0; maxRanges /= 4) {
+                    RangeSet s = p.envelope(*r, maxRanges, options);
+                    CHECK(s.size() <= maxRanges);
+                    CHECK(s.contains(envelope));
+                    s = p.interior(*r, maxRanges, options);
+                    CHECK(s.size() <= maxRanges);
+                    CHECK(interior.contains(s));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(StreamEnvelope) {
+    Circle circles[3] = {
+        Circle(UnitVector3d(1.0, 2.0, -0.5), Angle::fromDegrees(0.01)),
+        Circle(UnitVector3d(-1.0, 0.5, 0.25), Angle::fromDegrees(20.0)),
+        Circle::full()
+    };
+    for (int level: {0, 3, 8, 13}) {
+        Q3cPixelization p(level);
+        for (Circle const & c: circles) {
+            RangeSet s;
+            bool first = true;
+            bool ordered = true;
+            uint64_t end = 0;
+            p.streamEnvelope(c, [&](uint64_t a, uint64_t b) {
+                // Ranges must be emitted in ascending order, and must
+                // not be adjacent.
+                if (!first && (end == 0 || a <= end)) {
+                    ordered = false;
+                }
+                first = false;
+                end = b;
+                s.insert(a, b);
+            });
+            CHECK(ordered);
+            CHECK(s == p.envelope(c));
+        }
+    }
+}
@@ -23,6 +23,14 @@
 /// \file
 /// \brief This file contains tests for the RangeSet class.
 
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
 #include "lsst/sphgeom/RangeSet.h"
 
 #include "test.h"
@@ -314,3 +322,353 @@ TEST_CASE(Scale) {
     s.scale(10);
     CHECK(s.isValid() && s == RangeSet({{0, 10}, {50, 80}, {90, 0}}));
 }
+
+namespace {
+
+// Count heap allocations, so that tests can check that small sets
+// never touch the allocator.
+size_t allocations = 0;
+
+// Make array allocations, which are used for the storage of large sets,
+// fail while set, so that tests can check exception safety.
+bool failAllocations = false;
+
+} // unnamed namespace
+
+// The replaceable global allocation functions are all replaced, so that
+// every form of new and delete uses the same allocator.
+void * operator new(size_t n) {
+    ++allocations;
+    void * p = std::malloc(n == 0 ? 1 : n);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void * operator new[](size_t n) {
+    if (failAllocations) {
+        throw std::bad_alloc();
+    }
+    return operator new(n);
+}
+
+void operator delete(void * p) noexcept { std::free(p); }
+
+void operator delete[](void * p) noexcept { std::free(p); }
+
+void operator delete(void * p, size_t) noexcept { std::free(p); }
+
+void operator delete[](void * p, size_t) noexcept { std::free(p); }
+
+TEST_CASE(SmallSetsDoNotAllocate) {
+    size_t before = allocations;
+    bool ok = false;
+    {
+        RangeSet s;
+        RangeSet t(7);
+        RangeSet u = {{1, 3}, {5, 8}, {10, 12}};
+        s.insert(2, 9);
+        RangeSet v = (s & u) | t;
+        RangeSet w = s - t;
+        RangeSet x(v);
+        x = std::move(w);
+        swap(x, v);
+        x.simplify(1);
+        x.scale(4);
+        x.erase(4);
+        ok = v.isValid() && x.isValid() &&
+             v == RangeSet({{2, 7}, {8, 9}}) &&
+             x == RangeSet(8, 32);
+    }
+    CHECK(ok);
+    CHECK(allocations == before);
+}
+
+TEST_CASE(LargeSets) {
+    // Grow a set past its inline capacity, and check that copies, moves
+    // and swaps between inline and heap allocated sets are correct.
+    RangeSet small = {{1, 2}, {3, 4}};
+    RangeSet large;
+    for (uint64_t i = 0; i < 100; ++i) {
+        large.insert(2 * i + 1);
+        CHECK(large.isValid());
+        CHECK(large.size() == i + 1);
+    }
+    RangeSet copy(large);
+    CHECK(copy == large);
+    RangeSet moved(std::move(copy));
+    CHECK(moved == large);
+    swap(moved, small);
+    CHECK(small == large);
+    CHECK(moved == RangeSet({{1, 2}, {3, 4}}));
+    swap(moved, small);
+    CHECK(moved == large);
+    CHECK(small == RangeSet({{1, 2}, {3, 4}}));
+    small = moved;
+    CHECK(small == large);
+    small = RangeSet(5);
+    CHECK(small == RangeSet(5));
+    // Shrink back down.
+    large -= RangeSet(10, 0);
+    CHECK(large.isValid());
+    CHECK(large == RangeSet({{1, 2}, {3, 4}, {5, 6}, {7, 8}, {9, 10}}));
+    large.erase(0, 8);
+    CHECK(large.isValid() && large == RangeSet(9));
+    // Insert ranges before and between existing ones.
+    for (uint64_t i = 100; i > 0; --i) {
+        large.insert(4 * i, 4 * i + 2);
+    }
+    CHECK(large.isValid() && large.size() == 100);
+    CHECK(large.contains(8) && large.contains(9) && !large.contains(10));
+}
+
+TEST_CASE(MultiwayOperations) {
+    std::vector<RangeSet> none;
+    CHECK(RangeSet::joinAll(none).empty());
+    CHECK(RangeSet::intersectAll(none).full());
+    std::vector<RangeSet> sets = {
+        RangeSet(), RangeSet(0, 0), RangeSet(5, 1), RangeSet({{2, 4}, {6, 0}})
+    };
+    CHECK(RangeSet::joinAll(sets).full());
+    CHECK(RangeSet::intersectAll(sets) == RangeSet());
+    CHECK(RangeSet::coveredByAtLeast(sets, 2) ==
+          RangeSet({{0, 1}, {2, 4}, {5, 0}}));
+    CHECK(RangeSet::coveredByAtLeast(sets, 3) == RangeSet(6, 0));
+    CHECK(RangeSet::coveredByAtLeast(sets, 5).empty());
+    CHECK(RangeSet::coveredByAtLeast(sets, 0).full());
+    // Compare against pairwise folding and brute force counting on random
+    // sets with end points in [0, 64) or equal to 2^64. Such sets are
+    // constant on [64, 2^64), so checking the values 0 through 64 suffices.
+    std::mt19937_64 rng(1);
+    std::uniform_int_distribution<uint64_t> dist(0, 64);
+    for (size_t n = 1; n <= 40; ++n) {
+        sets.clear();
+        for (size_t i = 0; i < n; ++i) {
+            RangeSet s;
+            for (int j = 0; j < 4; ++j) {
+                uint64_t first = dist(rng);
+                uint64_t last = dist(rng);
+                s.insert(first, last == 64 ? 0 : last);
+            }
+            sets.push_back(s);
+        }
+        RangeSet u = sets[0];
+        RangeSet x = sets[0];
+        for (size_t i = 1; i < n; ++i) {
+            u |= sets[i];
+            x &= sets[i];
+        }
+        RangeSet joined = RangeSet::joinAll(sets);
+        RangeSet intersected = RangeSet::intersectAll(sets);
+        CHECK(joined.isValid() && joined == u);
+        CHECK(intersected.isValid() && intersected == x);
+        for (size_t m = 1; m <= n; ++m) {
+            RangeSet covered = RangeSet::coveredByAtLeast(sets, m);
+            CHECK(covered.isValid());
+            for (uint64_t v = 0; v <= 64; ++v) {
+                size_t count = 0;
+                for (RangeSet const & s: sets) {
+                    count += s.contains(v);
+                }
+                CHECK(covered.contains(v) == (count >= m));
+            }
+        }
+    }
+}
+
+TEST_CASE(BatchContains) {
+    std::mt19937_64 rng(2);
+    std::vector<RangeSet> sets = {
+        RangeSet(), RangeSet(0, 0), RangeSet(0), RangeSet(~uint64_t(0)),
+        RangeSet(5, 1), RangeSet({{2, 4}, {6, 0}})
+    };
+    for (size_t n: {1, 2, 3, 10, 100, 1000}) {
+        std::uniform_int_distribution<uint64_t> dist(0, 100 * n);
+        RangeSet s;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t first = dist(rng);
+            s.insert(first, first + dist(rng) % 50 + 1);
+        }
+        sets.push_back(s);
+        sets.push_back(~s);
+    }
+    std::uniform_int_distribution<uint64_t> dist(0, 200000);
+    for (size_t n: {0, 1, 7, 63, 64, 65, 200, 1000}) {
+        std::vector<uint64_t> values(n);
+        for (uint64_t & v: values) {
+            v = dist(rng);
+        }
+        if (n > 2) {
+            values[0] = 0;
+            values[1] = ~uint64_t(0);
+        }
+        std::vector<uint64_t> sorted(values);
+        std::sort(sorted.begin(), sorted.end());
+        size_t const words = (n + 63) / 64;
+        for (RangeSet const & s: sets) {
+            std::vector<uint64_t> r1(words + 1, 0xdeadbeef);
+            std::vector<uint64_t> r2(words + 1, 0xdeadbeef);
+            s.contains(values.data(), n, r1.data());
+            s.containsSorted(sorted.data(), n, r2.data());
+            CHECK(r1[words] == 0xdeadbeef && r2[words] == 0xdeadbeef);
+            for (size_t i = 0; i < n; ++i) {
+                bool b1 = ((r1[i / 64] >> (i % 64)) & 1) != 0;
+                bool b2 = ((r2[i / 64] >> (i % 64)) & 1) != 0;
+                CHECK(b1 == s.contains(values[i]));
+                CHECK(b2 == s.contains(sorted[i]));
+            }
+            if (n % 64 != 0) {
+                CHECK((r1[words - 1] >> (n % 64)) == 0);
+                CHECK((r2[words - 1] >> (n % 64)) == 0);
+            }
+        }
+    }
+    uint64_t unsorted[2] = {2, 1};
+    uint64_t result;
+    CHECK_THROW(sets.back().containsSorted(unsorted, 2, &result),
+                std::invalid_argument);
+}
+
+TEST_CASE(InPlaceOperations) {
+    std::mt19937_64 rng(3);
+    std::vector<RangeSet> sets = {
+        RangeSet(), RangeSet(0, 0), RangeSet(0), RangeSet(~uint64_t(0)),
+        RangeSet(5, 1), RangeSet({{2, 4}, {6, 0}})
+    };
+    for (size_t n: {1, 2, 3, 5, 10, 100, 1000}) {
+        std::uniform_int_distribution<uint64_t> dist(0, 100 * n);
+        RangeSet s;
+        for (size_t i = 0; i < n; ++i) {
+            uint64_t first = dist(rng);
+            s.insert(first, first + dist(rng) % 50 + 1);
+        }
+        sets.push_back(s);
+        sets.push_back(~s);
+    }
+    RangeSet out;
+    for (RangeSet const & a: sets) {
+        for (RangeSet const & b: sets) {
+            RangeSet expected[4] = {
+                a.intersection(b), a.join(b),
+                a.difference(b), a.symmetricDifference(b)
+            };
+            RangeSet r[4] = {a, a, a, a};
+            r[0] &= b;
+            r[1] |= b;
+            r[2] -= b;
+            r[3] ^= b;
+            for (int i = 0; i < 4; ++i) {
+                CHECK(r[i].isValid() && r[i] == expected[i]);
+            }
+            a.intersection(b, out);
+            CHECK(out.isValid() && out == expected[0]);
+            a.join(b, out);
+            CHECK(out.isValid() && out == expected[1]);
+            a.difference(b, out);
+            CHECK(out.isValid() && out == expected[2]);
+            a.symmetricDifference(b, out);
+            CHECK(out.isValid() && out == expected[3]);
+            // The output may alias either input.
+            RangeSet x(a);
+            RangeSet y(b);
+            x.difference(y, y);
+            CHECK(y.isValid() && y == expected[2]);
+            y = b;
+            x.difference(y, x);
+            CHECK(x == expected[2]);
+            x = a;
+            x.symmetricDifference(y, y);
+            CHECK(y == expected[3]);
+        }
+    }
+    // Once the output has grown to hold the points of both inputs, set
+    // operations that write into it do not allocate.
+    RangeSet const & a = sets[sets.size() - 2];
+    RangeSet const & b = sets[sets.size() - 4];
+    RangeSet c;
+    size_t before = 0;
+    for (int i = 0; i < 10; ++i) {
+        if (i == 1) {
+            before = allocations;
+        }
+        a.join(b, out);
+        a.intersection(b, out);
+        a.symmetricDifference(b, out);
+        c = a;
+        c |= b;
+        c &= b;
+    }
+    CHECK(allocations == before);
+}
+
+TEST_CASE(FailedSetOperations) {
+    // If the output of a set operation cannot grow to hold the result, it
+    // is left unchanged, even if it is also an input.
+    RangeSet a;
+    for (uint64_t i = 0; i < 100; ++i) {
+        a.insert(4 * i, 4 * i + 2);
+    }
+    RangeSet const b = {{1, 3}, {5, 8}};
+    void (RangeSet::*ops[])(RangeSet const &, RangeSet &) const = {
+        &RangeSet::intersection, &RangeSet::join,
+        &RangeSet::difference, &RangeSet::symmetricDifference
+    };
+    for (auto op: ops) {
+        RangeSet c(b);
+        bool threw = false;
+        failAllocations = true;
+        try {
+            (a.*op)(c, c);
+        } catch (std::bad_alloc const &) {
+            threw = true;
+        }
+        failAllocations = false;
+        CHECK(threw);
+        CHECK(c.isValid() && c == b);
+    }
+}
+
+TEST_CASE(FromValues) {
+    uint64_t const max = ~uint64_t(0);
+    CHECK(RangeSet::fromValues(nullptr, 0).empty());
+    std::vector<uint64_t> values = {5, 3, 4, 4, 9, 0, max, 1};
+    RangeSet s = RangeSet::fromValues(values);
+    CHECK(s.isValid());
+    CHECK(s == RangeSet({{0, 2}, {3, 6}, {9, 10}, {max, 0}}));
+    values = {max, 7, max - 1};
+    s = RangeSet::fromValues(values);
+    CHECK(s.isValid() && s == RangeSet({{7, 8}, {max - 1, 0}}));
+    values = {2, 0, 1};
+    s = RangeSet::fromValues(values);
+    CHECK(s.isValid() && s == RangeSet(0, 3));
+    values = {max, 0, 1, max - 1};
+    s = RangeSet::fromValues(values);
+    CHECK(s.isValid() && s == RangeSet(max - 1, 2));
+    // Compare against one-at-a-time insertion for inputs large enough to
+    // be radix sorted, with values spanning various numbers of bytes.
+    std::mt19937_64 rng(4);
+    for (int bits: {8, 20, 45, 64}) {
+        for (size_t n: {10, 1000, 100000, 300000}) {
+            std::uniform_int_distribution<uint64_t> dist(
+                0, bits == 64 ? max : (uint64_t(1) << bits) - 1);
+            values.resize(n);
+            for (uint64_t & v: values) {
+                v = dist(rng);
+            }
+            // Inserting values in ascending order is fast.
+            std::vector<uint64_t> sorted(values);
+            std::sort(sorted.begin(), sorted.end());
+            RangeSet expected;
+            for (uint64_t v: sorted) {
+                expected.insert(v);
+            }
+            for (unsigned int t: {1u, 3u, 0u}) {
+                s = RangeSet::fromValues(values, t);
+                CHECK(s.isValid() && s == expected);
+            }
+            s = RangeSet::fromValues(sorted);
+            CHECK(s.isValid() && s == expected);
+        }
+    }
+}
@@ -0,0 +1,177 @@
+/*
+ * LSST Data Management System
+ * Copyright 2016 AURA/LSST.
+ *
+ * This product includes software developed by the
+ * LSST Project (http://www.lsst.org/).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the LSST License Statement and
+ * the GNU General Public License along with this program.  If not,
+ * see <https://www.lsstcorp.org/LegalNotices/>.
+ */
+
+/// \file
+/// \brief This file contains tests for RangeSet encoding and the
+///        RangeSetView class.
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "lsst/sphgeom/RangeSet.h"
+#include "lsst/sphgeom/RangeSetView.h"
+
+#include "test.h"
+
+
+using namespace lsst::sphgeom;
+
+namespace {
+
+// `randomSet` returns a set of about n ranges with random end points
+// in [0, 2^b).
+RangeSet randomSet(std::mt19937_64 & rng, size_t n, int b) {
+    std::uniform_int_distribution<uint64_t> dist(
+        0, b == 64 ? ~static_cast<uint64_t>(0) : (uint64_t(1) << b) - 1);
+    RangeSet s;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t first = dist(rng);
+        uint64_t last = dist(rng);
+        if (first != last) {
+            s.insert(std::min(first, last), std::max(first, last));
+        }
+    }
+    return s;
+}
+
+std::vector<RangeSet> testSets() {
+    std::mt19937_64 rng(1);
+    std::vector<RangeSet> sets = {
+        RangeSet(),
+        RangeSet(0, 0),
+        RangeSet(0),
+        RangeSet(~static_cast<uint64_t>(0)),
+        RangeSet(5, 1),
+        RangeSet({{0, 1}, {5, 8}, {9, 0}}),
+        RangeSet({{1, 3}, {8, 10}, {11, 12}, {16, 0}})
+    };
+    for (size_t n: {10, 64, 65, 100, 1000, 5000}) {
+        sets.push_back(randomSet(rng, n, 20));
+        sets.push_back(randomSet(rng, n, 64));
+        sets.push_back(randomSet(rng, n, 20).complement());
+    }
+    return sets;
+}
+
+} // unnamed namespace
+
+
+TEST_CASE(EncodeDecode) {
+    for (RangeSet const & s: testSets()) {
+        std::vector<uint8_t> buffer = s.encode();
+        CHECK(buffer[0] == RangeSet::TYPE_CODE);
+        RangeSet d = RangeSet::decode(buffer);
+        CHECK(d.isValid());
+        CHECK(d == s);
+        RangeSetView v(buffer);
+        CHECK(v.size() == s.size());
+        CHECK(v.empty() == s.empty());
+        CHECK(v.full() == s.full());
+        CHECK(v.decode() == s);
+    }
+}
+
+TEST_CASE(Compactness) {
+    // The pixels intersecting a small region are nearby, so each end point
+    // should take little more than a byte to encode.
+    RangeSet s;
+    for (uint64_t i = 0; i < 1000; ++i) {
+        s.insert(1000000 + 5 * i, 1000000 + 5 * i + 2);
+    }
+    std::vector<uint8_t> buffer = s.encode();
+    CHECK(buffer.size() < 2 * 1000 * 2);
+    CHECK(RangeSet::decode(buffer) == s);
+}
+
+TEST_CASE(PointAndRangeQueries) {
+    std::mt19937_64 rng(2);
+    std::uniform_int_distribution<uint64_t> dist(0, 1 << 20);
+    for (RangeSet const & s: testSets()) {
+        std::vector<uint8_t> buffer = s.encode();
+        RangeSetView v(buffer);
+        for (uint64_t u: {uint64_t(0), uint64_t(1), ~uint64_t(0)}) {
+            CHECK(v.contains(u) == s.contains(u));
+        }
+        for (int i = 0; i < 200; ++i) {
+            uint64_t first = dist(rng);
+            uint64_t last = dist(rng);
+            CHECK(v.contains(first) == s.contains(first));
+            CHECK(v.intersects(first) == s.intersects(first));
+            CHECK(v.contains(first, last) == s.contains(first, last));
+            CHECK(v.intersects(first, last) == s.intersects(first, last));
+        }
+    }
+}
+
+TEST_CASE(SetQueries) {
+    std::vector<RangeSet> sets = testSets();
+    std::vector<std::vector<uint8_t>> buffers;
+    for (RangeSet const & s: sets) {
+        buffers.push_back(s.encode());
+    }
+    for (size_t i = 0; i < sets.size(); ++i) {
+        RangeSetView a(buffers[i]);
+        for (size_t j = 0; j < sets.size(); ++j) {
+            RangeSetView b(buffers[j]);
+            RangeSet expected = sets[i] & sets[j];
+            RangeSet r = a.intersection(sets[j]);
+            CHECK(r.isValid() && r == expected);
+            r = a.intersection(b);
+            CHECK(r.isValid() && r == expected);
+            CHECK(a.intersects(sets[j]) == sets[i].intersects(sets[j]));
+            CHECK(a.intersects(b) == sets[i].intersects(sets[j]));
+            CHECK(a.contains(sets[j]) == sets[i].contains(sets[j]));
+            CHECK(a.contains(b) == sets[i].contains(sets[j]));
+        }
+        CHECK(a.contains(sets[i]));
+        CHECK(a.intersection(a) == sets[i]);
+    }
+}
+
+TEST_CASE(InvalidEncodings) {
+    std::vector<uint8_t> empty;
+    CHECK_THROW(RangeSetView v(empty), std::runtime_error);
+    CHECK_THROW(RangeSet::decode(std::vector<uint8_t>{'r', 0}),
+                std::runtime_error);
+    CHECK_THROW(RangeSet::decode(std::vector<uint8_t>{'c', 0, 0}),
+                std::runtime_error);
+    CHECK_THROW(RangeSet::decode(std::vector<uint8_t>{'r', 2, 0}),
+                std::runtime_error);
+    // Too many end points for the buffer size.
+    CHECK_THROW(RangeSet::decode(std::vector<uint8_t>{'r', 0, 3, 1, 1}),
+                std::runtime_error);
+    // Truncated variable length integer.
+    CHECK_THROW(RangeSet::decode(std::vector<uint8_t>{'r', 0, 1, 0x80}),
+                std::runtime_error);
+    // End points that overflow.
+    std::vector<uint8_t> buffer = RangeSet(~uint64_t(0) - 1).encode();
+    buffer[2] = 3;
+    buffer.push_back(0);
+    CHECK_THROW(RangeSet::decode(buffer), std::runtime_error);
+    // Truncated encodings of a large set.
+    std::mt19937_64 rng(3);
+    buffer = randomSet(rng, 1000, 30).encode();
+    for (size_t n = 0; n < buffer.size(); n += 7) {
+        CHECK_THROW(RangeSet::decode(buffer.data(), n), std::runtime_error);
+    }
+}
@@ -24,7 +24,7 @@ from __future__ import absolute_import, division, print_function
 import pickle
 import unittest
 
-from lsst.sphgeom import Box, Chunker
+from lsst.sphgeom import Angle, Box, Chunker, LonLat, RangeSet, UnitVector3d
 
 
 class ChunkerTestCase(unittest.TestCase):
@@ -33,12 +33,18 @@ class ChunkerTestCase(unittest.TestCase):
         chunker = Chunker(85, 12)
         self.assertEqual(chunker.numStripes, 85)
         self.assertEqual(chunker.numSubStripesPerStripe, 12)
+        self.assertEqual(chunker.overlap, Angle(0.0))
+        chunker = Chunker(85, 12, Angle.fromDegrees(0.01))
+        self.assertEqual(chunker.overlap, Angle.fromDegrees(0.01))
+        with self.assertRaises(RuntimeError):
+            Chunker(85, 12, Angle(-1.0))
 
     def testComparisonOperators(self):
         c = Chunker(85, 12)
         self.assertEqual(c, c)
         self.assertEqual(c, Chunker(85, 12))
         self.assertNotEqual(c, Chunker(85, 10))
+        self.assertNotEqual(c, Chunker(85, 12, Angle.fromDegrees(0.01)))
 
     def testIntersecting(self):
         b = Box.fromDegrees(273.6, 30.7, 273.7180105379097, 30.722546655347717)
@@ -46,17 +52,64 @@ class ChunkerTestCase(unittest.TestCase):
         self.assertEqual(c.getChunksIntersecting(b), [9630, 9631, 9797])
         self.assertEqual(c.getSubChunksIntersecting(b),
                          [(9630, [770]), (9631, [759]), (9797, [11])])
+        self.assertEqual(c.getSubChunkRangesIntersecting(b),
+                         [(9630, [(770, 771)]), (9631, [(759, 760)]),
+                          (9797, [(11, 12)])])
+        self.assertEqual(c.getChunkSetIntersecting(b),
+                         RangeSet([9630, 9631, 9797]))
+        s = c.getSubChunkSetIntersecting(b)
+        self.assertEqual(s.cardinality(), 3)
+        self.assertEqual(sorted(c.getChunkLocation(i)
+                                for r in s.ranges() for i in range(*r)),
+                         [(9630, 770), (9631, 759), (9797, 11)])
+        self.assertTrue(s.contains(c.getGlobalSubChunkId(9631, 759)))
+
+    def testLocate(self):
+        c = Chunker(85, 12)
+        p = LonLat.fromDegrees(273.65, 30.701)
+        self.assertEqual(c.locate(p), (9630, 770))
+        self.assertEqual(c.locate(UnitVector3d(p)), (9630, 770))
+        self.assertEqual(c.locate(LonLat.fromDegrees(273.71, 30.701)),
+                         (9631, 759))
+        self.assertEqual(c.locate(LonLat.fromDegrees(273.65, 30.72)),
+                         (9797, 11))
+
+    def testOverlap(self):
+        c = Chunker(85, 12)
+        p = LonLat.fromDegrees(273.65, 30.701)
+        self.assertEqual(c.getOverlapChunks(p), [9630])
+        self.assertEqual(c.getOverlapSubChunks(p), [(9630, 770)])
+        c = Chunker(85, 12, Angle.fromDegrees(0.01))
+        for q in (p, LonLat.fromDegrees(273.71, 30.701),
+                  LonLat.fromDegrees(273.65, 30.72)):
+            chunkId, subChunkId = c.locate(q)
+            self.assertIn(chunkId, c.getOverlapChunks(q))
+            self.assertIn(chunkId, c.getOverlapChunks(UnitVector3d(q)))
+            self.assertIn((chunkId, subChunkId), c.getOverlapSubChunks(q))
+            self.assertEqual(c.getOverlapSubChunks(q),
+                             c.getOverlapSubChunks(UnitVector3d(q)))
+        # A point near the corner shared by the chunks intersecting the box
+        # used by testIntersecting is in the overlap bounds of all of them.
+        q = LonLat.fromDegrees(273.705, 30.705)
+        self.assertEqual(c.getOverlapChunks(q), [9630, 9631, 9797])
 
     def testString(self):
         chunker = Chunker(85, 12)
         self.assertEqual(str(chunker), 'Chunker(85, 12)')
         self.assertEqual(repr(chunker), 'Chunker(85, 12)')
         self.assertEqual(chunker, eval(repr(chunker), dict(Chunker=Chunker)))
+        chunker = Chunker(85, 12, Angle(1.0e-4))
+        self.assertEqual(repr(chunker), 'Chunker(85, 12, Angle(0.0001))')
+        self.assertEqual(chunker, eval(repr(chunker),
+                                       dict(Angle=Angle, Chunker=Chunker)))
 
     def testPickle(self):
         a = Chunker(85, 12)
         b = pickle.loads(pickle.dumps(a))
         self.assertEqual(a, b)
+        a = Chunker(85, 12, Angle.fromDegrees(0.01))
+        b = pickle.loads(pickle.dumps(a))
+        self.assertEqual(a, b)
 
 
 if __name__ == '__main__':
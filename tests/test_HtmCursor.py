@@ -0,0 +1,52 @@
+#
+# LSST Data Management System
+# See COPYRIGHT file at the top of the source tree.
+#
+# This product includes software developed by the
+# LSST Project (http://www.lsst.org/).
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the LSST License Statement and
+# the GNU General Public License along with this program.  If not,
+# see <https://www.lsstcorp.org/LegalNotices/>.
+#
+from __future__ import absolute_import, division, print_function
+from __future__ import absolute_import, division, print_function
+
+import unittest
+
+from lsst.sphgeom import HtmCursor, HtmPixelization, UnitVector3d
+
+
+class HtmCursorTestCase(unittest.TestCase):
+
+    def testConstruction(self):
+        with self.assertRaises(ValueError):
+            HtmCursor(-1)
+        with self.assertRaises(ValueError):
+            HtmCursor(HtmPixelization.MAX_LEVEL + 1)
+        self.assertEqual(HtmCursor(3).getLevel(), 3)
+
+    def testIndexAndTriangle(self):
+        h = HtmPixelization(10)
+        c = HtmCursor(10)
+        for v in (UnitVector3d(1, 1, 1), UnitVector3d(1, 1, 1.001),
+                  UnitVector3d(-1, 0, 0.2)):
+            i = c.index(v)
+            self.assertEqual(i, h.index(v))
+            self.assertEqual(c.triangle(i), HtmPixelization.triangle(i))
+        with self.assertRaises(ValueError):
+            c.triangle(0)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,84 @@
+#
+# LSST Data Management System
+# See COPYRIGHT file at the top of the source tree.
+#
+# This product includes software developed by the
+# LSST Project (http://www.lsst.org/).
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the LSST License Statement and
+# the GNU General Public License along with this program.  If not,
+# see <https://www.lsstcorp.org/LegalNotices/>.
+#
+from __future__ import absolute_import, division, print_function
+from __future__ import absolute_import, division, print_function
+
+import pickle
+import unittest
+
+from lsst.sphgeom import MultiLevelRangeSet, RangeSet
+
+
+class MultiLevelRangeSetTestCase(unittest.TestCase):
+
+    def testConstruction(self):
+        s = MultiLevelRangeSet()
+        self.assertTrue(s.empty())
+        self.assertEqual(s.getMaxLevel(), -1)
+        s = MultiLevelRangeSet(RangeSet(36, 41), 1)
+        self.assertFalse(s.empty())
+        self.assertEqual(s.getMaxLevel(), 1)
+        self.assertEqual(s.getCells(0), RangeSet(9))
+        self.assertEqual(s.getCells(1), RangeSet(40))
+        self.assertEqual(len(s), 2)
+        self.assertTrue(s.isValid())
+        with self.assertRaises(ValueError):
+            MultiLevelRangeSet(RangeSet(1), MultiLevelRangeSet.MAX_LEVEL + 1)
+
+    def testConversion(self):
+        s = MultiLevelRangeSet(RangeSet(36, 41), 1)
+        self.assertEqual(s.toRangeSet(1), RangeSet(36, 41))
+        self.assertEqual(s.toRangeSet(0), RangeSet(9, 11))
+        self.assertEqual(s.toRangeSet(2), RangeSet(144, 164))
+
+    def testMembership(self):
+        s = MultiLevelRangeSet(RangeSet(36, 41), 1)
+        self.assertTrue(s.contains(9, 0))
+        self.assertFalse(s.contains(10, 0))
+        self.assertTrue(s.intersects(10, 0))
+        self.assertTrue(s.contains(MultiLevelRangeSet(RangeSet(161), 2)))
+        self.assertFalse(s.intersects(MultiLevelRangeSet(RangeSet(164), 2)))
+
+    def testSetOperators(self):
+        a = MultiLevelRangeSet(RangeSet(36, 40), 1)
+        b = MultiLevelRangeSet(RangeSet(38, 42), 1)
+        self.assertEqual((a & b).toRangeSet(1), RangeSet(38, 40))
+        self.assertEqual((a | b).toRangeSet(1), RangeSet(36, 42))
+        self.assertEqual((a - b).toRangeSet(1), RangeSet(36, 38))
+        self.assertEqual((a ^ b).toRangeSet(1), RangeSet([(36, 38), (40, 42)]))
+        self.assertEqual(a.join(b), a | b)
+        c = MultiLevelRangeSet(a)
+        c |= b
+        self.assertEqual(c, a | b)
+
+    def testPickle(self):
+        a = MultiLevelRangeSet(RangeSet(36, 41), 1)
+        b = pickle.loads(pickle.dumps(a))
+        self.assertEqual(a, b)
+        env = dict(MultiLevelRangeSet=MultiLevelRangeSet, RangeSet=RangeSet)
+        self.assertEqual(a, eval(repr(a), env))
+        e = pickle.loads(pickle.dumps(MultiLevelRangeSet()))
+        self.assertTrue(e.empty())
+
+
+if __name__ == '__main__':
+    unittest.main()
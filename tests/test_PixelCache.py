@@ -0,0 +1,57 @@
+#
+# LSST Data Management System
+# See COPYRIGHT file at the top of the source tree.
+#
+# This product includes software developed by the
+# LSST Project (http://www.lsst.org/).
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the LSST License Statement and
+# the GNU General Public License along with this program.  If not,
+# see <https://www.lsstcorp.org/LegalNotices/>.
+#
+from __future__ import absolute_import, division, print_function
+from __future__ import absolute_import, division, print_function
+
+import unittest
+
+from lsst.sphgeom import (HtmPixelization, Mq3cPixelization, PixelCache,
+                          Q3cPixelization)
+
+
+class PixelCacheTestCase(unittest.TestCase):
+
+    def testConstruction(self):
+        with self.assertRaises(ValueError):
+            PixelCache(0)
+        cache = PixelCache(16)
+        self.assertEqual(cache.getCapacity(), 16)
+        self.assertEqual(repr(cache), 'PixelCache(16)')
+
+    def testPixelizations(self):
+        cache = PixelCache(16)
+        for p in (HtmPixelization(3, cache), Q3cPixelization(3, cache),
+                  Mq3cPixelization(3, cache)):
+            self.assertIs(p.getCache(), cache)
+            i = p.universe()[0][0]
+            self.assertEqual(p.pixel(i), p.pixel(i))
+        stats = cache.getStatistics()
+        self.assertEqual(stats['hits'], 3)
+        self.assertEqual(stats['misses'], 3)
+        self.assertEqual(stats['size'], 3)
+        cache.clear()
+        self.assertEqual(cache.getStatistics()['size'], 0)
+        self.assertIsNone(HtmPixelization(3).getCache())
+
+
+if __name__ == '__main__':
+    unittest.main()
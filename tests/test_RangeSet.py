@@ -75,6 +75,21 @@ class RangeSetTestCase(unittest.TestCase):
         c ^= c
         self.assertTrue(c.empty())
 
+    def testFromValues(self):
+        s = RangeSet.fromValues([5, 3, 4, 4, 9, 0, 1])
+        self.assertEqual(s, RangeSet([(0, 2), (3, 6), (9, 10)]))
+        self.assertTrue(RangeSet.fromValues([]).empty())
+        with self.assertRaises(ValueError):
+            RangeSet.fromValues([-1])
+
+    def testMultiwayOperations(self):
+        sets = [RangeSet(0, 10), RangeSet(5, 15), RangeSet(8, 20)]
+        self.assertEqual(RangeSet.joinAll(sets), RangeSet(0, 20))
+        self.assertEqual(RangeSet.intersectAll(sets), RangeSet(8, 10))
+        self.assertEqual(RangeSet.coveredByAtLeast(sets, 2), RangeSet(5, 15))
+        self.assertTrue(RangeSet.joinAll([]).empty())
+        self.assertTrue(RangeSet.intersectAll([]).full())
+
     def testRanges(self):
         s = RangeSet()
         s.insert(0, 1)
@@ -94,6 +109,14 @@ class RangeSetTestCase(unittest.TestCase):
             self.assertEqual(repr(s), 'RangeSet([(1L, 10L)])')
         self.assertEqual(s, eval(repr(s), dict(RangeSet=RangeSet)))
 
+    def testCodec(self):
+        for r in (RangeSet(), RangeSet(0, 0), RangeSet([(2, 4), (8, 0)]),
+                  RangeSet([(i * 7, i * 7 + 3) for i in range(100)])):
+            s = RangeSet.decode(r.encode())
+            self.assertEqual(r, s)
+        with self.assertRaises(RuntimeError):
+            RangeSet.decode(b'r')
+
     def testPickle(self):
         r = RangeSet([2, 3, 5, 7, 11, 13, 17, 19])
         s = pickle.loads(pickle.dumps(r))